@@ -0,0 +1,220 @@
+/***************************************************************************
+ *  foxxll/common/object_pool.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef STXXL_COMMON_OBJECT_POOL_HEADER
+#define STXXL_COMMON_OBJECT_POOL_HEADER
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace foxxll {
+
+//! \addtogroup support
+//! \{
+
+//! Free lists of memory slots of one size. Each thread keeps a small cache of
+//! free slots, which it exchanges in batches with a shared overflow list, such
+//! that objects allocated by one thread and freed by another (like requests
+//! submitted by the user and completed by an I/O thread) are recycled without
+//! contention. Once enough slots circulate, allocation does not call malloc.
+template <size_t Size>
+class fixed_size_pool
+{
+    //! slots cached per thread before half of them move to the shared list
+    static constexpr size_t local_capacity = 64;
+    //! slots moved between thread cache and shared list at once
+    static constexpr size_t batch_size = local_capacity / 2;
+    //! slots kept in the shared list, more are returned to the system
+    static constexpr size_t shared_capacity = 64 * local_capacity;
+
+    struct shared_list
+    {
+        std::mutex mutex_;
+        std::vector<void*> free_;
+    };
+
+    //! never destroyed, since slots may be freed by threads which outlive
+    //! static destruction
+    static shared_list& shared()
+    {
+        static shared_list* s_shared = new shared_list;
+        return *s_shared;
+    }
+
+    struct local_cache
+    {
+        std::vector<void*> free_;
+
+        local_cache()
+        {
+            free_.reserve(local_capacity);
+        }
+
+        //! hand the slots of an exiting thread to the others
+        ~local_cache()
+        {
+            while (!free_.empty())
+                flush(free_.size());
+        }
+
+        //! move up to num slots to the shared list
+        void flush(size_t num)
+        {
+            shared_list& s = shared();
+            std::unique_lock<std::mutex> lock(s.mutex_);
+            for ( ; num > 0 && !free_.empty(); --num)
+            {
+                if (s.free_.size() < shared_capacity)
+                    s.free_.push_back(free_.back());
+                else
+                    ::operator delete (free_.back());
+                free_.pop_back();
+            }
+        }
+
+        //! fetch up to one batch of slots from the shared list
+        void refill()
+        {
+            shared_list& s = shared();
+            std::unique_lock<std::mutex> lock(s.mutex_);
+            for (size_t i = 0; i < batch_size && !s.free_.empty(); ++i)
+            {
+                free_.push_back(s.free_.back());
+                s.free_.pop_back();
+            }
+        }
+    };
+
+    static local_cache& local()
+    {
+        static thread_local local_cache s_local;
+        return s_local;
+    }
+
+public:
+    //! Return a slot of Size bytes.
+    static void * allocate()
+    {
+        local_cache& c = local();
+        if (c.free_.empty())
+            c.refill();
+        if (c.free_.empty())
+            return ::operator new (Size);
+
+        void* p = c.free_.back();
+        c.free_.pop_back();
+        return p;
+    }
+
+    //! Return a slot obtained from allocate() to the pool.
+    static void deallocate(void* p)
+    {
+        local_cache& c = local();
+        if (c.free_.size() >= local_capacity)
+            c.flush(batch_size);
+        c.free_.push_back(p);
+    }
+};
+
+//! slot size used for objects of a given size, such that types of similar
+//! size share their free lists
+constexpr size_t object_pool_slot_size(size_t bytes)
+{
+    return (bytes + 15) / 16 * 16;
+}
+
+//! Backend for class-specific operator new/delete of frequently allocated
+//! objects. Allocations of other sizes, such as those of derived classes
+//! without their own operators, are forwarded to the global operators.
+template <typename Type>
+class object_pool
+{
+    using pool_type = fixed_size_pool<object_pool_slot_size(sizeof(Type))>;
+
+public:
+    static void * allocate(size_t bytes)
+    {
+        if (bytes != sizeof(Type))
+            return ::operator new (bytes);
+        return pool_type::allocate();
+    }
+
+    static void deallocate(void* p, size_t bytes)
+    {
+        if (!p)
+            return;
+        if (bytes != sizeof(Type))
+            return ::operator delete (p);
+        pool_type::deallocate(p);
+    }
+};
+
+//! STL allocator drawing single objects, e.g. std::list nodes, from
+//! fixed_size_pool. Arrays are forwarded to the global operator new.
+template <typename Type>
+class pool_alloc
+{
+public:
+    using value_type = Type;
+
+    template <class Rebind>
+    struct rebind {
+        using other = pool_alloc<Rebind>;
+    };
+
+    pool_alloc() noexcept { }
+    template <class Rebind>
+    pool_alloc(const pool_alloc<Rebind>&) noexcept { }
+
+    Type * allocate(size_t num)
+    {
+        if (num == 1)
+            return static_cast<Type*>(object_pool<Type>::allocate(sizeof(Type)));
+        if (num > std::numeric_limits<size_t>::max() / sizeof(Type))
+            throw std::bad_alloc();
+        return static_cast<Type*>(::operator new (num * sizeof(Type)));
+    }
+
+    void deallocate(Type* p, size_t num)
+    {
+        if (num == 1)
+            object_pool<Type>::deallocate(p, sizeof(Type));
+        else
+            ::operator delete (p);
+    }
+};
+
+// return that all specializations of this allocator are interchangeable
+template <class Type1, class Type2>
+inline bool operator == (
+    const pool_alloc<Type1>&, const pool_alloc<Type2>&) noexcept
+{
+    return true;
+}
+
+template <class Type1, class Type2>
+inline bool operator != (
+    const pool_alloc<Type1>&, const pool_alloc<Type2>&) noexcept
+{
+    return false;
+}
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !STXXL_COMMON_OBJECT_POOL_HEADER
+// vim: et:ts=4:sw=4
@@ -17,6 +17,7 @@
 #ifndef STXXL_COMMON_ONOFF_SWITCH_HEADER
 #define STXXL_COMMON_ONOFF_SWITCH_HEADER
 
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 
@@ -68,6 +69,15 @@ public:
             cond_.wait(lock);
     }
 
+    //! wait for switch to turn ON at most the given seconds
+    //! \return whether the switch is ON
+    bool wait_for_on(double seconds)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cond_.wait_for(lock, std::chrono::duration<double>(seconds),
+                              [this]() { return on_; });
+    }
+
     //! wait for switch to turn OFF
     void wait_for_off()
     {
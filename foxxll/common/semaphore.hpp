@@ -64,6 +64,17 @@ public:
         return --value_;
     }
 
+    //! function decrements the semaphore if it is > 0, but never blocks.
+    //! \returns true if the semaphore was decremented
+    bool try_wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (value_ <= 0)
+            return false;
+        --value_;
+        return true;
+    }
+
     //! return the current value -- should only be used for debugging.
     size_t value() const { return value_; }
 
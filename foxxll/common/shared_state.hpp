@@ -15,6 +15,7 @@
 #ifndef STXXL_COMMON_SHARED_STATE_HEADER
 #define STXXL_COMMON_SHARED_STATE_HEADER
 
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 
@@ -58,6 +59,15 @@ public:
             cv_.wait(lock);
     }
 
+    //! wait for the state at most the given seconds
+    //! \return whether the state was reached
+    bool wait_for(const value_type& needed_state, double seconds)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, std::chrono::duration<double>(seconds),
+                            [&]() { return needed_state == state_; });
+    }
+
     value_type operator () ()
     {
         std::unique_lock<std::mutex> lock(mutex_);
@@ -18,6 +18,7 @@
 //#define STXXL_HAVE_MMAP_FILE 0/1
 //#define STXXL_HAVE_WINCALL_FILE 0/1
 //#define STXXL_HAVE_LINUXAIO_FILE 0/1
+//#define STXXL_HAVE_IO_URING_FILE 0/1
 // default: 0/1 (platform and type dependent)
 // used in: io/*_file.h, io/*_file.cpp, mng/mng.cpp
 // affects: library
@@ -15,16 +15,20 @@
 #define STXXL_IO_IO_HEADER
 
 #include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/io/completion_queue.hpp>
 #include <foxxll/io/create_file.hpp>
 #include <foxxll/io/disk_queues.hpp>
 #include <foxxll/io/file.hpp>
 #include <foxxll/io/fileperblock_file.hpp>
+#include <foxxll/io/io_uring_file.hpp>
 #include <foxxll/io/iostats.hpp>
 #include <foxxll/io/linuxaio_file.hpp>
 #include <foxxll/io/memory_file.hpp>
 #include <foxxll/io/mmap_file.hpp>
 #include <foxxll/io/request.hpp>
 #include <foxxll/io/request_operations.hpp>
+#include <foxxll/io/request_trace.hpp>
+#include <foxxll/io/stats_sampler.hpp>
 #include <foxxll/io/syscall_file.hpp>
 #include <foxxll/io/wincall_file.hpp>
 
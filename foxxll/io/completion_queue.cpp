@@ -0,0 +1,128 @@
+/***************************************************************************
+ *  foxxll/io/completion_queue.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/common/error_handling.hpp>
+#include <foxxll/common/timer.hpp>
+#include <foxxll/io/completion_queue.hpp>
+#include <foxxll/io/iostats.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+namespace foxxll {
+
+void completion_queue::add(const request_ptr& req, void* tag)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        pending_.insert(req.get());
+    }
+
+    // the request's lock is taken before ours when it completes
+    if (req->set_completion_queue(this, tag))
+        push(req.get(), tag);
+}
+
+bool completion_queue::remove(const request_ptr& req)
+{
+    if (req->reset_completion_queue(this))
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        pending_.erase(req.get());
+        return true;
+    }
+
+    // completed already, or not tracked by this queue
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::deque<entry>::iterator it = std::find_if(
+        completed_.begin(), completed_.end(),
+        [&req](const entry& e) { return e.req == req; });
+    if (it == completed_.end())
+        return false;
+
+    completed_.erase(it);
+    return true;
+}
+
+size_t completion_queue::size() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return pending_.size() + completed_.size();
+}
+
+size_t completion_queue::ready() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return completed_.size();
+}
+
+bool completion_queue::try_pop(entry& out)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (completed_.empty())
+        return false;
+
+    out = std::move(completed_.front());
+    completed_.pop_front();
+    return true;
+}
+
+completion_queue::entry completion_queue::pop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (completed_.empty())
+    {
+        if (pending_.empty())
+            STXXL_THROW(std::logic_error,
+                        "completion_queue::pop() without tracked requests");
+
+        stats::scoped_wait_timer wait_timer(stats::WAIT_OP_ANY);
+        auto ready = [this]() { return !completed_.empty(); };
+
+        // serve the tracked requests first if the wait takes a while
+        if (!cv_.wait_for(lock, std::chrono::duration<double>(request::boost_delay()),
+                          ready))
+        {
+            size_t boosted = 0;
+            {
+                std::vector<request_ptr> waiting(pending_.begin(), pending_.end());
+                lock.unlock();
+                for (const request_ptr& req : waiting)
+                    boosted += req->boost();
+            }
+            lock.lock();
+
+            const double start = timestamp();
+            cv_.wait(lock, ready);
+            if (boosted)
+                stats::get_instance()->boosted_wait_finished(timestamp() - start);
+        }
+    }
+
+    entry out = std::move(completed_.front());
+    completed_.pop_front();
+    return out;
+}
+
+void completion_queue::push(request* req, void* tag)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    pending_.erase(req);
+    completed_.push_back(entry { request_ptr(req), tag });
+    cv_.notify_one();
+}
+
+} // namespace foxxll
+// vim: et:ts=4:sw=4
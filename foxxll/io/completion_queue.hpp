@@ -0,0 +1,99 @@
+/***************************************************************************
+ *  foxxll/io/completion_queue.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef STXXL_IO_COMPLETION_QUEUE_HEADER
+#define STXXL_IO_COMPLETION_QUEUE_HEADER
+
+#include <foxxll/io/request.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+
+namespace foxxll {
+
+//! \addtogroup reqlayer
+//! \{
+
+//! Queue of completed requests. Requests added to the queue push themselves
+//! onto it when they complete, in completion order, together with a tag chosen
+//! by the caller. Waiting for any of N requests hence costs O(1) per
+//! completion instead of registering with and unregistering from all N
+//! requests like wait_any().
+//!
+//! All requests added must have been popped or removed before the queue is
+//! destroyed.
+class completion_queue
+{
+    friend class request_with_waiters;
+
+public:
+    //! a completed request and the tag it was added with
+    struct entry
+    {
+        request_ptr req;
+        void* tag;
+    };
+
+    completion_queue() = default;
+
+    //! non-copyable: delete copy-constructor
+    completion_queue(const completion_queue&) = delete;
+    //! non-copyable: delete assignment operator
+    completion_queue& operator = (const completion_queue&) = delete;
+
+    //! Track a request, which is pushed immediately if already completed.
+    void add(const request_ptr& req, void* tag = nullptr);
+
+    //! Stop tracking a request, whether completed yet or not.
+    //! \return \c true if the request was tracked
+    bool remove(const request_ptr& req);
+
+    //! Number of tracked requests, which have not been popped yet.
+    size_t size() const;
+
+    //! Whether no requests are tracked.
+    bool empty() const { return size() == 0; }
+
+    //! Number of completed requests ready to be popped.
+    size_t ready() const;
+
+    //! Pop a completed request, if any.
+    //! \return \c false if none has completed yet
+    bool try_pop(entry& out);
+
+    //! Wait until a tracked request completes and pop it. At least one
+    //! request must be tracked. Boosts the tracked requests if the wait
+    //! lasts request::boost_delay().
+    entry pop();
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+
+    //! requests completed, but not yet popped
+    std::deque<entry> completed_;
+
+    //! requests added, but not yet completed or removed
+    std::unordered_set<request*> pending_;
+
+    //! called by a completing request
+    void push(request* req, void* tag);
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !STXXL_IO_COMPLETION_QUEUE_HEADER
+// vim: et:ts=4:sw=4
@@ -96,6 +96,9 @@ file_ptr create_file(disk_config& cfg, int mode, int disk_allocator_id)
         if (cfg.unlink_on_open)
             result->unlink();
 
+        if (cfg.discard)
+            result->enable_discard(cfg.discard_rate);
+
         return result;
     }
     else if (cfg.io_impl == "fileperblock_syscall")
@@ -146,6 +149,44 @@ file_ptr create_file(disk_config& cfg, int mode, int disk_allocator_id)
         if (cfg.unlink_on_open)
             result->unlink();
 
+        if (cfg.discard)
+            result->enable_discard(cfg.discard_rate);
+
+        return result;
+    }
+#endif
+#if STXXL_HAVE_IO_URING_FILE
+    // io_uring can have the desired ring size, specified as queue_length=?
+    else if (cfg.io_impl == "io_uring")
+    {
+        tlx::counting_ptr<ufs_file_base> result =
+            tlx::make_counting<io_uring_file>(
+                cfg.path, mode, cfg.queue, disk_allocator_id,
+                cfg.device_id, cfg.queue_length);
+
+        result->lock();
+
+        // if marked as device but file is not -> throw!
+        if (cfg.raw_device && !result->is_device())
+        {
+            STXXL_THROW(io_error, "Disk " << cfg.path << " was expected to be "
+                        "a raw block device, but it is a normal file!");
+        }
+
+        // if is raw_device -> get size and remove some flags.
+        if (result->is_device())
+        {
+            cfg.raw_device = true;
+            cfg.size = result->size();
+            cfg.autogrow = cfg.delete_on_exit = cfg.unlink_on_open = false;
+        }
+
+        if (cfg.unlink_on_open)
+            result->unlink();
+
+        if (cfg.discard)
+            result->enable_discard(cfg.discard_rate);
+
         return result;
     }
 #endif
@@ -160,6 +201,9 @@ file_ptr create_file(disk_config& cfg, int mode, int disk_allocator_id)
         if (cfg.unlink_on_open)
             result->unlink();
 
+        if (cfg.discard)
+            result->enable_discard(cfg.discard_rate);
+
         return result;
     }
     else if (cfg.io_impl == "fileperblock_mmap")
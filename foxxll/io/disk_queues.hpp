@@ -16,21 +16,31 @@
 #ifndef STXXL_IO_DISK_QUEUES_HEADER
 #define STXXL_IO_DISK_QUEUES_HEADER
 
+#include <foxxll/io/io_uring_queue.hpp>
+#include <foxxll/io/io_uring_request.hpp>
 #include <foxxll/io/iostats.hpp>
 #include <foxxll/io/linuxaio_queue.hpp>
 #include <foxxll/io/linuxaio_request.hpp>
 #include <foxxll/io/request.hpp>
+#include <foxxll/io/request_queue_impl_elevator.hpp>
+#include <foxxll/io/request_queue_impl_parallel.hpp>
 #include <foxxll/io/request_queue_impl_qwqr.hpp>
+#include <foxxll/io/request_trace.hpp>
 #include <foxxll/io/serving_request.hpp>
 #include <foxxll/singleton.hpp>
 
 #include <map>
+#include <mutex>
+#include <vector>
 
 namespace foxxll {
 
 //! \addtogroup reqlayer
 //! \{
 
+template <typename BlockType>
+class registered_blocks;
+
 //! Encapsulates disk queues.
 //! \remark is a singleton
 class disk_queues : public singleton<disk_queues>
@@ -43,13 +53,40 @@ class disk_queues : public singleton<disk_queues>
 protected:
     request_queue_map queues_;
 
+    //! buffers registered via register_buffer(), also registered with queues
+    //! created later
+    std::mutex buffers_mutex_;
+    std::map<const void*, size_t> buffers_;
+
     disk_queues()
     {
         stats::get_instance(); // initialize stats before ourselves
     }
 
+    //! store a newly created queue and attach its gauges
+    request_queue * add_queue(disk_id_type disk, request_queue* q)
+    {
+        q->set_queue_stats(stats::get_instance()->create_queue_stats(disk));
+#if STXXL_HAVE_IO_URING_FILE
+        if (io_uring_queue* uq = dynamic_cast<io_uring_queue*>(q))
+        {
+            std::unique_lock<std::mutex> lock(buffers_mutex_);
+            for (const auto& b : buffers_)
+                uq->register_buffer(b.first, b.second);
+        }
+#endif
+        return queues_[disk] = q;
+    }
+
 public:
-    void make_queue(file* file)
+    //! Creates the request queue for a file's queue id unless it already
+    //! exists. For files without their own asynchronous queue type,
+    //! elevator selects a request_queue_impl_elevator, which passes over
+    //! requests for at most elevator_max_wait milliseconds (0 is the default
+    //! bound), and otherwise queue_length > 1 selects a
+    //! request_queue_impl_parallel with that many worker threads.
+    void make_queue(file* file, int queue_length = 0,
+                    bool elevator = false, unsigned elevator_max_wait = 0)
     {
         int queue_id = file->get_queue_id();
 
@@ -61,11 +98,24 @@ public:
 #if STXXL_HAVE_LINUXAIO_FILE
         if (const linuxaio_file* af =
                 dynamic_cast<const linuxaio_file*>(file)) {
-            queues_[queue_id] = new linuxaio_queue(af->get_desired_queue_length());
+            add_queue(queue_id, new linuxaio_queue(af->get_desired_queue_length()));
             return;
         }
 #endif
-        queues_[queue_id] = new request_queue_impl_qwqr();
+#if STXXL_HAVE_IO_URING_FILE
+        if (const io_uring_file* uf =
+                dynamic_cast<const io_uring_file*>(file)) {
+            add_queue(queue_id, new io_uring_queue(uf->get_desired_queue_length()));
+            return;
+        }
+#endif
+        if (elevator)
+            add_queue(queue_id, new request_queue_impl_elevator(
+                          static_cast<double>(elevator_max_wait) / 1000.0));
+        else if (queue_length > 1)
+            add_queue(queue_id, new request_queue_impl_parallel(queue_length));
+        else
+            add_queue(queue_id, new request_queue_impl_qwqr());
     }
 
     void add_request(request_ptr& req, disk_id_type disk)
@@ -80,15 +130,23 @@ public:
             // create new request queue
 #if STXXL_HAVE_LINUXAIO_FILE
             if (dynamic_cast<linuxaio_request*>(req.get()))
-                q = queues_[disk] = new linuxaio_queue(
-                        dynamic_cast<linuxaio_file*>(req->get_file())->get_desired_queue_length());
+                q = add_queue(disk, new linuxaio_queue(
+                                  dynamic_cast<linuxaio_file*>(req->get_file())->get_desired_queue_length()));
             else
 #endif
-            q = queues_[disk] = new request_queue_impl_qwqr();
+#if STXXL_HAVE_IO_URING_FILE
+            if (dynamic_cast<io_uring_request*>(req.get()))
+                q = add_queue(disk, new io_uring_queue(
+                                  dynamic_cast<io_uring_file*>(req->get_file())->get_desired_queue_length()));
+            else
+#endif
+            q = add_queue(disk, new request_queue_impl_qwqr());
         }
         else
             q = qi->second;
 
+        req->mark_submitted(timestamp());
+        request_trace::event(req.get(), request_trace::SUBMIT);
         q->add_request(req);
     }
 
@@ -111,6 +169,43 @@ public:
             return false;
     }
 
+    //! Serves a waiting request before all others of its queue.
+    //! \param req request to boost
+    //! \param disk disk number for disk that \c req was scheduled on
+    //! \return \c true iff the request was still waiting in the queue
+    bool boost_request(request_ptr& req, disk_id_type disk)
+    {
+#ifdef STXXL_HACK_SINGLE_IO_THREAD
+        disk = 42;
+#endif
+        request_queue_map::iterator qi = queues_.find(disk);
+        if (qi != queues_.end())
+            return qi->second->boost_request(req);
+        else
+            return false;
+    }
+
+    //! Limits the bandwidth and I/O operations per second of a disk's queue,
+    //! zero limits are unlimited. May be called at any time.
+    //! \return \c false if the disk has no queue
+    bool set_throttle_limits(disk_id_type disk, const throttle_limits& limits)
+    {
+        request_queue_map::iterator qi = queues_.find(disk);
+        if (qi == queues_.end())
+            return false;
+        qi->second->set_throttle_limits(limits);
+        return true;
+    }
+
+    //! The limits of a disk's queue, unlimited if it has no queue.
+    throttle_limits get_throttle_limits(disk_id_type disk)
+    {
+        request_queue_map::iterator qi = queues_.find(disk);
+        if (qi == queues_.end())
+            return throttle_limits();
+        return qi->second->get_throttle_limits();
+    }
+
     request_queue * get_queue(disk_id_type disk)
     {
         if (queues_.find(disk) != queues_.end())
@@ -119,6 +214,24 @@ public:
             return nullptr;
     }
 
+    //! Returns the depth gauges of a queue, empty if it does not exist.
+    queue_stats_data get_queue_stats(disk_id_type disk) const
+    {
+        request_queue_map::const_iterator qi = queues_.find(disk);
+        if (qi == queues_.end())
+            return queue_stats_data();
+        return qi->second->get_queue_stats();
+    }
+
+    //! Returns the depth gauges of all queues, ordered by queue id.
+    std::vector<queue_stats_data> get_queue_stats() const
+    {
+        std::vector<queue_stats_data> result;
+        for (request_queue_map::const_iterator i = queues_.begin(); i != queues_.end(); i++)
+            result.push_back(i->second->get_queue_stats());
+        return result;
+    }
+
     ~disk_queues()
     {
         // deallocate all queues_
@@ -128,14 +241,100 @@ public:
 
     //! Changes requests priorities.
     //! \param op one of:
-    //! - READ, read requests are served before write requests within a disk queue
-    //! - WRITE, write requests are served before read requests within a disk queue
-    //! - NONE, read and write requests are served by turns, alternately
+    //! - READ, reads are weighted eight times higher than write-back
+    //! - WRITE, write-back is weighted eight times higher than reads
+    //! - NONE, all priority classes are weighted equally
     void set_priority_op(const request_queue::priority_op& op)
+    {
+        set_priority_weights(request_queue::priority_op_weights(op));
+    }
+
+    //! Sets the weights by which the priority classes of requests share each
+    //! disk queue, see request::priority_class.
+    void set_priority_weights(const priority_weights& weights)
     {
         for (request_queue_map::iterator i = queues_.begin(); i != queues_.end(); i++)
-            i->second->set_priority_op(op);
+            i->second->set_priority_weights(weights);
     }
+
+private:
+    //! only the owner of the memory registers it, which unregisters it
+    //! before freeing it
+    template <typename BlockType>
+    friend class registered_blocks;
+
+    //! Registers a buffer with all queues that support it (currently
+    //! io_uring_queue), such that I/O to and from it avoids pinning the pages
+    //! on every request. The buffer must be unregistered before it is freed.
+    void register_buffer(const void* buffer, size_t bytes)
+    {
+#if STXXL_HAVE_IO_URING_FILE
+        std::unique_lock<std::mutex> lock(buffers_mutex_);
+        buffers_[buffer] = bytes;
+        for (request_queue_map::iterator i = queues_.begin(); i != queues_.end(); i++)
+        {
+            if (io_uring_queue* q = dynamic_cast<io_uring_queue*>(i->second))
+                q->register_buffer(buffer, bytes);
+        }
+#else
+        STXXL_UNUSED(buffer);
+        STXXL_UNUSED(bytes);
+#endif
+    }
+
+    //! Removes a buffer registered with register_buffer().
+    void unregister_buffer(const void* buffer)
+    {
+#if STXXL_HAVE_IO_URING_FILE
+        std::unique_lock<std::mutex> lock(buffers_mutex_);
+        if (buffers_.erase(buffer) == 0)
+            return;
+        for (request_queue_map::iterator i = queues_.begin(); i != queues_.end(); i++)
+        {
+            if (io_uring_queue* q = dynamic_cast<io_uring_queue*>(i->second))
+                q->unregister_buffer(buffer);
+        }
+#else
+        STXXL_UNUSED(buffer);
+#endif
+    }
+};
+
+//! An array of blocks registered with the disk queues that support it
+//! (currently io_uring_queue) for its lifetime, such that I/O to and from the
+//! blocks avoids pinning their pages on every request. The registration
+//! never outlives the memory, blocks freed elsewhere are never registered.
+//! No I/O to the blocks may be pending when the array is destroyed.
+template <typename BlockType>
+class registered_blocks
+{
+public:
+    explicit registered_blocks(size_t size)
+        : size_(size), blocks_(new BlockType[size])
+    {
+        disk_queues::get_instance()->register_buffer(
+            blocks_, size_ * sizeof(BlockType));
+    }
+
+    //! non-copyable: delete copy-constructor
+    registered_blocks(const registered_blocks&) = delete;
+    //! non-copyable: delete assignment operator
+    registered_blocks& operator = (const registered_blocks&) = delete;
+
+    ~registered_blocks()
+    {
+        disk_queues::get_instance()->unregister_buffer(blocks_);
+        delete[] blocks_;
+    }
+
+    size_t size() const { return size_; }
+
+    BlockType& operator [] (size_t i) { return blocks_[i]; }
+    const BlockType& operator [] (size_t i) const { return blocks_[i]; }
+
+private:
+    size_t size_;
+    BlockType* blocks_;
 };
 
 //! \}
@@ -0,0 +1,287 @@
+/***************************************************************************
+ *  foxxll/io/fair_request_queue.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef STXXL_IO_FAIR_REQUEST_QUEUE_HEADER
+#define STXXL_IO_FAIR_REQUEST_QUEUE_HEADER
+
+#include <foxxll/common/object_pool.hpp>
+#include <foxxll/io/request.hpp>
+
+#include <algorithm>
+#include <array>
+#include <list>
+#include <utility>
+#include <vector>
+
+namespace foxxll {
+
+//! \addtogroup reqlayer
+//! \{
+
+//! Weights of the priority classes, indexed by request::priority_class.
+using priority_weights = std::array<unsigned, request::num_priority_classes>;
+
+//! Default weights: demand reads get eight times and prefetching reads four
+//! times the share of write-back.
+static inline priority_weights default_priority_weights()
+{
+    return priority_weights { { 8, 4, 1 } };
+}
+
+//! Weighted fair sharing of a queue among the priority classes by stride
+//! scheduling: serving a request advances the virtual time of its class by
+//! its bytes divided by the class weight, and the class with the least
+//! virtual time is served next. Backlogged classes hence transfer bytes in
+//! proportion to their weights. A class becoming backlogged again starts at
+//! the current virtual time and does not catch up on its idle time.
+class fair_share
+{
+public:
+    explicit fair_share(const priority_weights& weights = default_priority_weights())
+    {
+        set_weights(weights);
+    }
+
+    //! Set the weights, zero weights count as one.
+    void set_weights(const priority_weights& weights)
+    {
+        for (size_t c = 0; c < weights.size(); ++c)
+            weights_[c] = std::max(weights[c], 1u);
+    }
+
+    const priority_weights & get_weights() const { return weights_; }
+
+    //! Choose the class to serve next among those with eligible(c), ties go
+    //! to the lower class.
+    //! \return the class, or request::num_priority_classes if none is eligible
+    template <typename Eligible>
+    size_t pick(Eligible eligible) const
+    {
+        size_t best = request::num_priority_classes;
+        double best_time = 0;
+        for (size_t c = 0; c < request::num_priority_classes; ++c)
+        {
+            if (!eligible(c))
+                continue;
+            const double t = std::max(pass_[c], vtime_);
+            if (best == request::num_priority_classes || t < best_time) {
+                best = c;
+                best_time = t;
+            }
+        }
+        return best;
+    }
+
+    //! Account bytes served for class c.
+    void charge(size_t c, size_t bytes)
+    {
+        vtime_ = std::max(pass_[c], vtime_);
+        pass_[c] = vtime_ + static_cast<double>(bytes) / weights_[c];
+    }
+
+private:
+    priority_weights weights_;
+
+    //! virtual time of each class
+    double pass_[request::num_priority_classes] = { };
+
+    //! virtual time of the class served last
+    double vtime_ = 0;
+};
+
+//! Queue of waiting requests with one FIFO per priority class, from which
+//! requests are taken by weighted fair sharing among the classes. Boosted
+//! requests, which a thread is blocked on, are taken before all others.
+//! Boosting a request boosts the requests for the same file and offset
+//! submitted before it, too, such that these stay in submission order. Not
+//! thread safe, the request queue protects it.
+class fair_request_queue
+{
+public:
+    //! a waiting request and its submission number
+    struct entry
+    {
+        request_ptr req;
+        uint64_t seq;
+    };
+
+    using queue_type = std::list<entry, pool_alloc<entry> >;
+
+    void set_weights(const priority_weights& weights)
+    {
+        share_.set_weights(weights);
+    }
+
+    const priority_weights & get_weights() const
+    {
+        return share_.get_weights();
+    }
+
+    //! Add a request behind the others of its class.
+    void push_back(const request_ptr& req)
+    {
+        queues_[req->get_priority_class()].push_back(entry { req, next_seq_++ });
+        ++size_;
+    }
+
+    //! Add a request before the others of its class, e.g. the remainder of a
+    //! partial transfer, which counts as submitted before all others.
+    void push_front(const request_ptr& req)
+    {
+        queues_[req->get_priority_class()].push_front(entry { req, 0 });
+        ++size_;
+    }
+
+    bool empty() const { return size_ == 0; }
+
+    size_t size() const { return size_; }
+
+    //! Remove a waiting request.
+    //! \return \c true if it was waiting
+    bool erase(const request_ptr& req)
+    {
+        queue_type& q = queues_[req->get_priority_class()];
+        queue_type::iterator pos = find(q, req);
+        if (pos != q.end())
+        {
+            q.erase(pos);
+        }
+        else
+        {
+            pos = find(boosted_, req);
+            if (pos == boosted_.end())
+                return false;
+            boosted_.erase(pos);
+        }
+        --size_;
+        return true;
+    }
+
+    //! Move a waiting request behind the other boosted ones, ahead of all
+    //! classes, preceded by the waiting requests for the same file and offset
+    //! submitted before it.
+    //! \return \c true if it was waiting and not boosted before
+    bool boost(const request_ptr& req)
+    {
+        queue_type& q = queues_[req->get_priority_class()];
+        queue_type::iterator pos = find(q, req);
+        if (pos == q.end())
+            return false;
+
+        // earlier requests for the same position of all classes
+        using located = std::pair<queue_type*, queue_type::iterator>;
+        std::vector<located> earlier;
+        for (queue_type& cq : queues_)
+        {
+            for (queue_type::iterator i = cq.begin(); i != cq.end(); ++i)
+            {
+                if (i->seq < pos->seq && same_file_offset(i->req, req))
+                    earlier.emplace_back(&cq, i);
+            }
+        }
+        std::sort(earlier.begin(), earlier.end(),
+                  [](const located& a, const located& b) {
+                      return a.second->seq < b.second->seq;
+                  });
+        for (const located& e : earlier)
+            boosted_.splice(boosted_.end(), *e.first, e.second);
+
+        boosted_.splice(boosted_.end(), q, pos);
+        return true;
+    }
+
+    //! Take the next request, the queue must not be empty.
+    request_ptr pop()
+    {
+        if (!boosted_.empty())
+            return take(boosted_, boosted_.begin());
+
+        size_t c = share_.pick(
+            [this](size_t c) { return !queues_[c].empty(); });
+        return take(queues_[c], queues_[c].begin());
+    }
+
+    //! Take the first request of the class served next among those with a
+    //! request for which servable(req) holds.
+    //! \return the request, or an empty request_ptr if none is servable
+    template <typename Servable>
+    request_ptr pop_if(Servable servable)
+    {
+        auto servable_entry = [&servable](const entry& e) { return servable(e.req); };
+
+        queue_type::iterator pos =
+            std::find_if(boosted_.begin(), boosted_.end(), servable_entry);
+        if (pos != boosted_.end())
+            return take(boosted_, pos);
+
+        queue_type::iterator first[request::num_priority_classes];
+        for (size_t c = 0; c < request::num_priority_classes; ++c)
+            first[c] = std::find_if(queues_[c].begin(), queues_[c].end(), servable_entry);
+
+        size_t c = share_.pick(
+            [this, &first](size_t c) { return first[c] != queues_[c].end(); });
+        if (c == request::num_priority_classes)
+            return request_ptr();
+        return take(queues_[c], first[c]);
+    }
+
+    //! Whether pred(req) holds for any waiting request.
+    template <typename Predicate>
+    bool any_of(Predicate pred) const
+    {
+        auto pred_entry = [&pred](const entry& e) { return pred(e.req); };
+
+        for (const queue_type& q : queues_)
+        {
+            if (std::any_of(q.begin(), q.end(), pred_entry))
+                return true;
+        }
+        return std::any_of(boosted_.begin(), boosted_.end(), pred_entry);
+    }
+
+private:
+    queue_type queues_[request::num_priority_classes];
+    //! boosted requests of all classes, in the order of boosting
+    queue_type boosted_;
+    size_t size_ = 0;
+    //! submission number of the next request, 0 is left for push_front()
+    uint64_t next_seq_ = 1;
+    fair_share share_;
+
+    static queue_type::iterator find(queue_type& q, const request_ptr& req)
+    {
+        return std::find_if(q.begin(), q.end(),
+                            [&req](const entry& e) { return e.req == req; });
+    }
+
+    static bool same_file_offset(const request_ptr& a, const request_ptr& b)
+    {
+        return a->get_file() == b->get_file() && a->get_offset() == b->get_offset();
+    }
+
+    //! take the request at pos of q, charging its class
+    request_ptr take(queue_type& q, queue_type::iterator pos)
+    {
+        request_ptr req = std::move(pos->req);
+        q.erase(pos);
+        --size_;
+        share_.charge(req->get_priority_class(), req->get_size());
+        return req;
+    }
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !STXXL_IO_FAIR_REQUEST_QUEUE_HEADER
+// vim: et:ts=4:sw=4
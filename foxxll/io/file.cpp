@@ -20,6 +20,16 @@ int file::unlink(const char* path)
     return ::unlink(path);
 }
 
+void file::serve_vectored(const io_vector* vec, size_t count,
+                          offset_type offset, request::read_or_write op)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        serve(vec[i].buffer, offset, vec[i].bytes, op);
+        offset += vec[i].bytes;
+    }
+}
+
 } // namespace foxxll
 
 /******************************************************************************/
@@ -20,6 +20,7 @@
 #include <foxxll/common/types.hpp>
 #include <foxxll/config.hpp>
 #include <foxxll/io/iostats.hpp>
+#include <foxxll/io/mapped_block.hpp>
 #include <foxxll/io/request.hpp>
 #include <foxxll/io/request_interface.hpp>
 #include <foxxll/libstxxl.hpp>
@@ -134,6 +135,19 @@ public:
     virtual void serve(void* buffer, offset_type offset, size_type bytes,
                        request::read_or_write op) = 0;
 
+    //! One buffer of a vectored I/O, see serve_vectored().
+    struct io_vector
+    {
+        void* buffer;
+        size_type bytes;
+    };
+
+    //! Transfers count buffers from or to the contiguous region starting at
+    //! offset, the first buffer to or from offset. The default implementation
+    //! calls serve() for each buffer.
+    virtual void serve_vectored(const io_vector* vec, size_t count,
+                                offset_type offset, request::read_or_write op);
+
     //! Changes the size of the file.
     //! \param newsize new file size
     virtual void set_size(offset_type newsize) = 0;
@@ -161,6 +175,18 @@ public:
         STXXL_UNUSED(size);
     }
 
+    //! Try to provide a region of the file without copying it, which is
+    //! possible for files residing in memory or mapped into it. This is
+    //! synchronous and counted as a read.
+    //! \return view of [offset, offset + bytes), or an empty view if the
+    //! region must be read via aread()
+    virtual mapped_block try_map_block(offset_type offset, size_type bytes)
+    {
+        STXXL_UNUSED(offset);
+        STXXL_UNUSED(bytes);
+        return mapped_block();
+    }
+
     virtual void export_files(offset_type offset, offset_type length,
                               std::string prefix)
     {
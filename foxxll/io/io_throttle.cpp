@@ -0,0 +1,128 @@
+/***************************************************************************
+ *  foxxll/io/io_throttle.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/common/timer.hpp>
+#include <foxxll/io/io_throttle.hpp>
+
+#include <algorithm>
+#include <chrono>
+
+namespace foxxll {
+
+constexpr double io_throttle::burst;
+
+double io_throttle::bucket::capacity() const
+{
+    return std::max(rate * burst, 1.0);
+}
+
+void io_throttle::bucket::refill(double elapsed)
+{
+    if (rate != 0)
+        tokens = std::min(tokens + elapsed * rate, capacity());
+}
+
+double io_throttle::bucket::delay(double need) const
+{
+    if (rate == 0)
+        return 0.0;
+
+    // an I/O larger than the capacity waits for a full bucket
+    need = std::min(need, capacity());
+    return (tokens >= need) ? 0.0 : (need - tokens) / rate;
+}
+
+void io_throttle::set_limits(const throttle_limits& limits)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        limits_ = limits;
+
+        read_.rate = static_cast<double>(limits.max_read_bw);
+        write_.rate = static_cast<double>(limits.max_write_bw);
+        iops_.rate = static_cast<double>(limits.max_iops);
+        for (bucket* b : { &read_, &write_, &iops_ })
+            b->tokens = b->capacity();
+        last_ = timestamp();
+
+        unlimited_ = limits.unlimited();
+    }
+    cv_.notify_all();
+}
+
+throttle_limits io_throttle::get_limits() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return limits_;
+}
+
+void io_throttle::refill(double now)
+{
+    const double elapsed = std::max(now - last_, 0.0);
+    read_.refill(elapsed);
+    write_.refill(elapsed);
+    iops_.refill(elapsed);
+    last_ = std::max(now, last_);
+}
+
+double io_throttle::acquire(request_interface::read_or_write op, uint64_t bytes)
+{
+    if (unlimited_)
+        return 0.0;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    const double start = timestamp();
+    double now = start;
+    for ( ; ; )
+    {
+        const double delay = take(op, bytes, now);
+        if (delay == 0.0)
+            break;
+
+        // woken early by new limits, or by spurious wakeups
+        cv_.wait_for(lock, std::chrono::duration<double>(delay));
+        now = timestamp();
+    }
+
+    return now - start;
+}
+
+double io_throttle::try_acquire(request_interface::read_or_write op, uint64_t bytes)
+{
+    if (unlimited_)
+        return 0.0;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    return take(op, bytes, timestamp());
+}
+
+double io_throttle::take(request_interface::read_or_write op, uint64_t bytes,
+                         double now)
+{
+    refill(now);
+
+    bucket& data = (op == request_interface::READ) ? read_ : write_;
+    const double need = static_cast<double>(bytes);
+    const double delay = std::max(data.delay(need), iops_.delay(1.0));
+    if (delay == 0.0)
+    {
+        if (data.rate != 0)
+            data.tokens -= need;
+        if (iops_.rate != 0)
+            iops_.tokens -= 1.0;
+    }
+    return delay;
+}
+
+} // namespace foxxll
+// vim: et:ts=4:sw=4
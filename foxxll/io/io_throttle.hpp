@@ -0,0 +1,120 @@
+/***************************************************************************
+ *  foxxll/io/io_throttle.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef STXXL_IO_IO_THROTTLE_HEADER
+#define STXXL_IO_IO_THROTTLE_HEADER
+
+#include <foxxll/io/request_interface.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace foxxll {
+
+//! \addtogroup reqlayer
+//! \{
+
+//! Limits enforced by an io_throttle, zero means unlimited.
+struct throttle_limits
+{
+    //! bytes read per second
+    uint64_t max_read_bw = 0;
+    //! bytes written per second
+    uint64_t max_write_bw = 0;
+    //! I/O operations per second, reads and writes together
+    uint64_t max_iops = 0;
+
+    bool unlimited() const
+    {
+        return max_read_bw == 0 && max_write_bw == 0 && max_iops == 0;
+    }
+};
+
+//! Token buckets limiting the read and write bandwidth and the I/O operations
+//! per second of one request queue. Each bucket refills at its rate and holds
+//! at most burst seconds worth of tokens. An I/O larger than a full bucket
+//! is admitted once the bucket is full and leaves it in debt. Thread safe,
+//! several workers of a queue may acquire concurrently.
+class io_throttle
+{
+public:
+    //! seconds worth of tokens a bucket holds at most
+    static constexpr double burst = 0.05;
+
+    io_throttle() = default;
+
+    //! non-copyable: delete copy-constructor
+    io_throttle(const io_throttle&) = delete;
+    //! non-copyable: delete assignment operator
+    io_throttle& operator = (const io_throttle&) = delete;
+
+    //! Set new limits, which also apply to I/Os blocked in acquire(). The
+    //! buckets start full.
+    void set_limits(const throttle_limits& limits);
+
+    throttle_limits get_limits() const;
+
+    //! Block until the buckets admit an I/O of the given operation and bytes
+    //! and take their tokens.
+    //! \return seconds blocked
+    double acquire(request_interface::read_or_write op, uint64_t bytes);
+
+    //! Take the tokens for an I/O of the given operation and bytes if the
+    //! buckets admit it now, without blocking.
+    //! \return zero if admitted, otherwise seconds until it may be admitted
+    double try_acquire(request_interface::read_or_write op, uint64_t bytes);
+
+private:
+    struct bucket
+    {
+        //! tokens per second, zero if unlimited
+        double rate = 0;
+        //! may be negative after an I/O larger than the capacity
+        double tokens = 0;
+
+        //! at least one token, i.e. one I/O operation
+        double capacity() const;
+
+        //! add the tokens for elapsed seconds
+        void refill(double elapsed);
+
+        //! seconds until an I/O taking need tokens is admitted
+        double delay(double need) const;
+    };
+
+    mutable std::mutex mutex_;
+    //! signaled when the limits change
+    std::condition_variable cv_;
+
+    throttle_limits limits_;
+    bucket read_, write_, iops_;
+    //! time of the last refill
+    double last_ = 0;
+
+    //! no limits are set, checked without locking
+    std::atomic<bool> unlimited_ { true };
+
+    void refill(double now);
+
+    //! refill at now and take the tokens if admitted, mutex_ is held
+    //! \return zero if admitted, otherwise seconds until it may be admitted
+    double take(request_interface::read_or_write op, uint64_t bytes, double now);
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !STXXL_IO_IO_THROTTLE_HEADER
+// vim: et:ts=4:sw=4
@@ -0,0 +1,79 @@
+/***************************************************************************
+ *  foxxll/io/io_uring_file.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/io/io_uring_file.hpp>
+
+#if STXXL_HAVE_IO_URING_FILE
+
+#include <foxxll/io/disk_queues.hpp>
+#include <foxxll/io/io_uring_queue.hpp>
+#include <foxxll/io/io_uring_request.hpp>
+
+namespace foxxll {
+
+io_uring_file::~io_uring_file()
+{
+    // drop the registered descriptor before ufs_file_base closes it
+    if (fixed_file_index_ >= 0)
+    {
+        io_uring_queue* queue = dynamic_cast<io_uring_queue*>(
+            disk_queues::get_instance()->get_queue(get_queue_id()));
+        if (queue)
+            queue->unregister_file(this);
+    }
+}
+
+request_ptr io_uring_file::aread(
+    void* buffer, offset_type offset, size_type bytes,
+    const completion_handler& on_complete)
+{
+    request_ptr req = tlx::make_counting<io_uring_request>(
+        on_complete, this, buffer, offset, bytes, request::READ);
+
+    disk_queues::get_instance()->add_request(req, get_queue_id());
+
+    return req;
+}
+
+request_ptr io_uring_file::awrite(
+    void* buffer, offset_type offset, size_type bytes,
+    const completion_handler& on_complete)
+{
+    cancel_discard(offset, bytes);
+
+    request_ptr req = tlx::make_counting<io_uring_request>(
+        on_complete, this, buffer, offset, bytes, request::WRITE);
+
+    disk_queues::get_instance()->add_request(req, get_queue_id());
+
+    return req;
+}
+
+void io_uring_file::serve(void* buffer, offset_type offset, size_type bytes,
+                          request::read_or_write op)
+{
+    // req need not be an io_uring_request
+    if (op == request::READ)
+        aread(buffer, offset, bytes)->wait();
+    else
+        awrite(buffer, offset, bytes)->wait();
+}
+
+const char* io_uring_file::io_type() const
+{
+    return "io_uring";
+}
+
+} // namespace foxxll
+
+#endif // #if STXXL_HAVE_IO_URING_FILE
+// vim: et:ts=4:sw=4
@@ -0,0 +1,95 @@
+/***************************************************************************
+ *  foxxll/io/io_uring_file.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef STXXL_IO_IO_URING_FILE_HEADER
+#define STXXL_IO_IO_URING_FILE_HEADER
+
+#include <foxxll/config.hpp>
+
+#if STXXL_HAVE_IO_URING_FILE
+
+#include <foxxll/io/disk_queued_file.hpp>
+#include <foxxll/io/ufs_file_base.hpp>
+
+#include <string>
+
+namespace foxxll {
+
+class io_uring_queue;
+
+//! \addtogroup fileimpl
+//! \{
+
+//! Implementation of \c file based on the Linux io_uring interface for
+//! asynchronous I/O. Requests are placed into a submission ring shared with
+//! the kernel and reaped from the completion ring by a single thread per
+//! queue.
+class io_uring_file final : public ufs_file_base, public disk_queued_file
+{
+    friend class io_uring_queue;
+    friend class io_uring_request;
+
+private:
+    int desired_queue_length_;
+
+    //! slot of file_des_ in the queue's registered file table, -1 if the
+    //! descriptor is not registered (yet).
+    int fixed_file_index_;
+
+public:
+    //! Constructs file object
+    //! \param filename path of file
+    //! \param mode open mode, see \c foxxll::file::open_modes
+    //! \param queue_id disk queue identifier
+    //! \param allocator_id linked disk_allocator
+    //! \param device_id physical device identifier
+    //! \param desired_queue_length number of ring entries requested from kernel
+    io_uring_file(
+        const std::string& filename, int mode,
+        int queue_id = DEFAULT_QUEUE,
+        int allocator_id = NO_ALLOCATOR,
+        unsigned int device_id = DEFAULT_DEVICE_ID,
+        int desired_queue_length = 0)
+        : file(device_id),
+          ufs_file_base(filename, mode),
+          disk_queued_file(queue_id, allocator_id),
+          desired_queue_length_(desired_queue_length),
+          fixed_file_index_(-1)
+    { }
+
+    ~io_uring_file();
+
+    void serve(void* buffer, offset_type offset, size_type bytes,
+               request::read_or_write op) final;
+
+    request_ptr aread(
+        void* buffer, offset_type pos, size_type bytes,
+        const completion_handler& on_cmpl = completion_handler()) final;
+
+    request_ptr awrite(
+        void* buffer, offset_type pos, size_type bytes,
+        const completion_handler& on_cmpl = completion_handler()) final;
+
+    const char * io_type() const final;
+
+    int get_desired_queue_length() const
+    { return desired_queue_length_; }
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // #if STXXL_HAVE_IO_URING_FILE
+
+#endif // !STXXL_IO_IO_URING_FILE_HEADER
+// vim: et:ts=4:sw=4
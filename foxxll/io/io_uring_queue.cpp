@@ -0,0 +1,680 @@
+/***************************************************************************
+ *  foxxll/io/io_uring_queue.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/io/io_uring_queue.hpp>
+
+#if STXXL_HAVE_IO_URING_FILE
+
+#include <foxxll/common/error_handling.hpp>
+#include <foxxll/common/timer.hpp>
+#include <foxxll/io/io_uring_request.hpp>
+#include <foxxll/io/request_trace.hpp>
+#include <foxxll/verbose.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <sstream>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace foxxll {
+
+//! number of slots in the registered file table of each queue
+static const size_t io_uring_fixed_files = 64;
+
+//! number of slots in the registered buffer table of each queue
+static const size_t io_uring_fixed_buffers = 64;
+
+io_uring_queue::io_uring_queue(int desired_queue_length)
+    : ring_fd_(-1), event_fd_(-1),
+      num_posted_(0), num_unsubmitted_(0),
+      wakeup_armed_(false), timeout_at_(0), throttled_since_(0),
+      sleeping_(false), registered_bytes_(0),
+      thread_state_(NOT_RUNNING)
+{
+    // default value, 64 entries per queue (i.e. usually per disk) should be
+    // enough. Two entries are reserved for the wakeup poll and the throttle
+    // timeout.
+    unsigned entries = (desired_queue_length == 0) ? 64 : desired_queue_length;
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CLAMP;
+
+    ring_fd_ = static_cast<int>(
+        syscall(SYS_io_uring_setup, std::max(entries, 3u), &params));
+    if (ring_fd_ < 0) {
+        STXXL_THROW_ERRNO(io_error, "io_uring_queue::io_uring_queue"
+                          " io_uring_setup() entries=" << entries);
+    }
+    entries_ = params.sq_entries;
+
+    // map submission and completion rings, which share one mapping on newer
+    // kernels.
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+    sq_ring_ptr_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ptr_ == MAP_FAILED)
+        STXXL_THROW_ERRNO(io_error, "io_uring_queue::io_uring_queue"
+                          " mmap() of submission ring");
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        cq_ring_ptr_ = sq_ring_ptr_;
+    }
+    else {
+        cq_ring_ptr_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ptr_ == MAP_FAILED)
+            STXXL_THROW_ERRNO(io_error, "io_uring_queue::io_uring_queue"
+                              " mmap() of completion ring");
+    }
+
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(
+        mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED)
+        STXXL_THROW_ERRNO(io_error, "io_uring_queue::io_uring_queue"
+                          " mmap() of submission queue entries");
+
+    char* sq = static_cast<char*>(sq_ring_ptr_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+    char* cq = static_cast<char*>(cq_ring_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd_ < 0)
+        STXXL_THROW_ERRNO(io_error, "io_uring_queue::io_uring_queue"
+                          " eventfd()");
+
+    // register a sparse file table, files are added on first use. If the
+    // kernel does not support this, plain file descriptors are used.
+    fixed_files_.assign(io_uring_fixed_files, -1);
+    if (syscall(SYS_io_uring_register, ring_fd_, IORING_REGISTER_FILES,
+                fixed_files_.data(), fixed_files_.size()) != 0)
+    {
+        STXXL_VERBOSE1("io_uring_queue: registering file table failed: " << strerror(errno));
+        fixed_files_.clear();
+    }
+
+    // register a sparse buffer table, whose slots are updated one at a time.
+    // If the kernel does not support this, regular I/O is used.
+    std::vector<iovec> empty_slots(io_uring_fixed_buffers);
+    memset(empty_slots.data(), 0, empty_slots.size() * sizeof(iovec));
+    io_uring_rsrc_register table;
+    memset(&table, 0, sizeof(table));
+    table.nr = static_cast<__u32>(empty_slots.size());
+    table.data = reinterpret_cast<__u64>(empty_slots.data());
+    if (syscall(SYS_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS2,
+                &table, sizeof(table)) == 0)
+        buffer_slots_.assign(io_uring_fixed_buffers, nullptr);
+    else
+        STXXL_VERBOSE1("io_uring_queue: registering buffer table failed: " << strerror(errno));
+
+    STXXL_MSG("Set up an io_uring queue with " << entries_ << " entries.");
+
+    start_thread(worker, static_cast<void*>(this), thread_, thread_state_);
+}
+
+io_uring_queue::~io_uring_queue()
+{
+    assert(thread_state_() == RUNNING);
+    thread_state_.set_to(TERMINATING);
+    wake_up();
+    thread_.join();
+    assert(thread_state_() == TERMINATED);
+    thread_state_.set_to(NOT_RUNNING);
+
+    munmap(sqes_, sqes_size_);
+    if (cq_ring_ptr_ != sq_ring_ptr_)
+        munmap(cq_ring_ptr_, cq_ring_size_);
+    munmap(sq_ring_ptr_, sq_ring_size_);
+    ::close(event_fd_);
+    ::close(ring_fd_);
+}
+
+void io_uring_queue::add_request(request_ptr& req)
+{
+    if (req.empty())
+        STXXL_THROW_INVALID_ARGUMENT("Empty request submitted to disk_queue.");
+    if (thread_state_() != RUNNING)
+        STXXL_ERRMSG("Request submitted to stopped queue.");
+    if (!dynamic_cast<io_uring_request*>(req.get()))
+        STXXL_ERRMSG("Non-io_uring request submitted to io_uring queue.");
+
+    // before it can be dequeued
+    note_added();
+
+    {
+        std::unique_lock<std::mutex> lock(waiting_mtx_);
+        waiting_requests_.push_back(req);
+    }
+
+    // only pay for the wakeup syscall if the worker might be blocked
+    if (sleeping_.exchange(false))
+        wake_up();
+}
+
+void io_uring_queue::set_priority_weights(const priority_weights& weights)
+{
+    std::unique_lock<std::mutex> lock(waiting_mtx_);
+    waiting_requests_.set_weights(weights);
+}
+
+bool io_uring_queue::cancel_request(request_ptr& req)
+{
+    if (req.empty())
+        STXXL_THROW_INVALID_ARGUMENT("Empty request canceled disk_queue.");
+    if (thread_state_() != RUNNING)
+        STXXL_ERRMSG("Request canceled in stopped queue.");
+    if (!dynamic_cast<io_uring_request*>(req.get()))
+        STXXL_ERRMSG("Non-io_uring request submitted to io_uring queue.");
+
+    std::unique_lock<std::mutex> lock(waiting_mtx_);
+
+    if (!waiting_requests_.erase(req))
+        return false;
+
+    // the remainders of requests already handed to the kernel partially are
+    // not canceled. done_ is only written while a request is not waiting.
+    io_uring_request* ur = static_cast<io_uring_request*>(req.get());
+    if (ur->done_ != 0) {
+        waiting_requests_.push_front(req);
+        return false;
+    }
+
+    lock.unlock();
+    note_canceled();
+
+    // request is canceled, but was not yet posted.
+    ur->completed(false, true);
+    return true;
+}
+
+bool io_uring_queue::boost_request(request_ptr& req)
+{
+    if (req.empty())
+        STXXL_THROW_INVALID_ARGUMENT("Empty request boosted in disk_queue.");
+
+    std::unique_lock<std::mutex> lock(waiting_mtx_);
+    return waiting_requests_.boost(req);
+}
+
+void io_uring_queue::set_throttle_limits(const throttle_limits& limits)
+{
+    request_queue_impl_worker::set_throttle_limits(limits);
+
+    // the worker may wait for a timeout of the old limits
+    wake_up();
+}
+
+void io_uring_queue::register_buffer(const void* buffer, size_t bytes)
+{
+    const char* cbuffer = static_cast<const char*>(buffer);
+    std::unique_lock<std::mutex> lock(buffers_mtx_);
+
+    std::vector<const char*>::iterator it =
+        std::find(buffer_slots_.begin(), buffer_slots_.end(), nullptr);
+    if (it == buffer_slots_.end())
+        return;
+
+    // pinned pages count against the locked memory limit
+    rlimit memlock;
+    if (getrlimit(RLIMIT_MEMLOCK, &memlock) == 0 &&
+        memlock.rlim_cur != RLIM_INFINITY &&
+        registered_bytes_ + bytes > memlock.rlim_cur)
+    {
+        STXXL_VERBOSE1("io_uring_queue: not registering " << bytes <<
+                       " bytes beyond RLIMIT_MEMLOCK");
+        return;
+    }
+
+    int slot = static_cast<int>(it - buffer_slots_.begin());
+    if (!update_buffer_slot(slot, cbuffer, bytes))
+    {
+        STXXL_VERBOSE1("io_uring_queue: registering buffer failed: " <<
+                       strerror(errno) << ", falling back to regular I/O.");
+        buffer_slots_.clear();
+        return;
+    }
+
+    *it = cbuffer;
+    buffers_[cbuffer] = std::make_pair(bytes, slot);
+    registered_bytes_ += bytes;
+}
+
+void io_uring_queue::unregister_buffer(const void* buffer)
+{
+    std::unique_lock<std::mutex> lock(buffers_mtx_);
+
+    auto it = buffers_.find(static_cast<const char*>(buffer));
+    if (it == buffers_.end())
+        return;
+
+    // requests still posted keep the old registration alive in the kernel
+    const int slot = it->second.second;
+    if (!buffer_slots_.empty() && update_buffer_slot(slot, nullptr, 0))
+        buffer_slots_[slot] = nullptr;
+
+    registered_bytes_ -= it->second.first;
+    buffers_.erase(it);
+}
+
+bool io_uring_queue::update_buffer_slot(int slot, const char* buffer, size_t bytes)
+{
+    iovec v;
+    v.iov_base = const_cast<char*>(buffer);
+    v.iov_len = bytes;
+
+    io_uring_rsrc_update2 update;
+    memset(&update, 0, sizeof(update));
+    update.offset = static_cast<__u32>(slot);
+    update.data = reinterpret_cast<__u64>(&v);
+    update.nr = 1;
+
+    return syscall(SYS_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS_UPDATE,
+                   &update, sizeof(update)) == 1;
+}
+
+void io_uring_queue::unregister_file(io_uring_file* file)
+{
+    std::unique_lock<std::mutex> lock(files_mtx_);
+
+    int slot = file->fixed_file_index_;
+    if (slot < 0)
+        return;
+
+    int fd = -1;
+    io_uring_files_update update;
+    memset(&update, 0, sizeof(update));
+    update.offset = static_cast<__u32>(slot);
+    update.fds = reinterpret_cast<__u64>(&fd);
+
+    if (syscall(SYS_io_uring_register, ring_fd_,
+                IORING_REGISTER_FILES_UPDATE, &update, 1) != 1)
+    {
+        STXXL_ERRMSG("io_uring_queue: unregistering file slot " << slot <<
+                     " failed: " << strerror(errno));
+    }
+
+    fixed_files_[slot] = -1;
+    file->fixed_file_index_ = -1;
+}
+
+int io_uring_queue::get_fixed_file(io_uring_file* file)
+{
+    if (file->fixed_file_index_ >= 0)
+        return file->fixed_file_index_;
+
+    std::unique_lock<std::mutex> lock(files_mtx_);
+
+    std::vector<int>::iterator it =
+        std::find(fixed_files_.begin(), fixed_files_.end(), -1);
+    if (it == fixed_files_.end())
+        return -1;
+
+    int slot = static_cast<int>(it - fixed_files_.begin());
+    int fd = file->file_des_;
+
+    io_uring_files_update update;
+    memset(&update, 0, sizeof(update));
+    update.offset = static_cast<__u32>(slot);
+    update.fds = reinterpret_cast<__u64>(&fd);
+
+    if (syscall(SYS_io_uring_register, ring_fd_,
+                IORING_REGISTER_FILES_UPDATE, &update, 1) != 1)
+    {
+        STXXL_VERBOSE1("io_uring_queue: registering fd=" << fd <<
+                       " failed: " << strerror(errno));
+        return -1;
+    }
+
+    *it = fd;
+    file->fixed_file_index_ = slot;
+    return slot;
+}
+
+int io_uring_queue::get_buffer_index(const void* buffer, size_t bytes)
+{
+    std::unique_lock<std::mutex> lock(buffers_mtx_);
+
+    if (buffer_slots_.empty() || buffers_.empty())
+        return -1;
+
+    const char* cbuffer = static_cast<const char*>(buffer);
+    auto it = buffers_.upper_bound(cbuffer);
+    if (it == buffers_.begin())
+        return -1;
+    --it;
+
+    if (cbuffer + bytes > it->first + it->second.first)
+        return -1;
+
+    return it->second.second;
+}
+
+io_uring_sqe* io_uring_queue::get_sqe()
+{
+    unsigned tail = *sq_tail_;
+    assert(tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) < entries_);
+
+    unsigned index = tail & *sq_mask_;
+    sq_array_[index] = index;
+    return &sqes_[index];
+}
+
+void io_uring_queue::commit_sqe()
+{
+    // publish the entry to the kernel
+    __atomic_store_n(sq_tail_, *sq_tail_ + 1, __ATOMIC_RELEASE);
+    ++num_unsubmitted_;
+}
+
+void io_uring_queue::arm_wakeup()
+{
+    io_uring_sqe* sqe = get_sqe();
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = event_fd_;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = 0;
+    commit_sqe();
+
+    wakeup_armed_ = true;
+}
+
+void io_uring_queue::arm_timeout(double seconds)
+{
+    timeout_ts_.tv_sec = static_cast<long long>(seconds);
+    timeout_ts_.tv_nsec = static_cast<long long>(
+        (seconds - static_cast<double>(timeout_ts_.tv_sec)) * 1e9);
+
+    io_uring_sqe* sqe = get_sqe();
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->addr = reinterpret_cast<__u64>(&timeout_ts_);
+    // a single timespec and no completion count, a pure timer
+    sqe->len = 1;
+    sqe->user_data = 1;
+    commit_sqe();
+
+    timeout_at_ = timestamp() + seconds;
+}
+
+void io_uring_queue::wake_up()
+{
+    uint64_t one = 1;
+    ssize_t rc = ::write(event_fd_, &one, sizeof(one));
+    STXXL_UNUSED(rc);
+}
+
+// internal routines, run by the worker thread
+bool io_uring_queue::admit_request(io_uring_request* ur)
+{
+    // remainders of partial transfers were admitted before
+    if (ur->done_ != 0)
+        return true;
+
+    const double delay = try_throttle(ur->op_, ur->bytes_);
+    if (delay > 0.0)
+    {
+        const double now = timestamp();
+        if (throttled_since_ == 0)
+            throttled_since_ = now;
+        // unless an earlier timeout wakes the worker anyway
+        if (timeout_at_ == 0 || now + delay < timeout_at_)
+            arm_timeout(delay);
+        return false;
+    }
+
+    if (throttled_since_ != 0)
+    {
+        note_throttled(timestamp() - throttled_since_);
+        throttled_since_ = 0;
+    }
+    return true;
+}
+
+unsigned io_uring_queue::fill_submission_ring()
+{
+    if (!wakeup_armed_)
+        arm_wakeup();
+
+    // take as many waiting requests as there are free entries and the
+    // throttle admits, two entries are reserved for the wakeup poll and the
+    // throttle timeout. A request held back stays first in line.
+    queue_type batch;
+    {
+        std::unique_lock<std::mutex> lock(waiting_mtx_);
+
+        for (unsigned free = entries_ - 2 - num_posted_;
+             free > 0 && !waiting_requests_.empty(); --free)
+        {
+            request_ptr req = waiting_requests_.pop();
+            if (!admit_request(static_cast<io_uring_request*>(req.get()))) {
+                waiting_requests_.push_front(req);
+                break;
+            }
+            batch.push_back(req);
+        }
+    }
+
+    if (batch.empty())
+        return num_unsubmitted_;
+
+    // io_uring_enter() might take considerable time, so we have to remember
+    // the current time before the call.
+    double now = timestamp();
+
+    for (request_ptr& req : batch)
+    {
+        io_uring_request* ur = static_cast<io_uring_request*>(req.get());
+        io_uring_file* uf = dynamic_cast<io_uring_file*>(ur->file_);
+
+        if (ur->done_ == 0)
+        {
+            ur->mark_started(now);
+            request_trace::event(ur, request_trace::DEQUEUE);
+            request_trace::event(ur, request_trace::DISPATCH);
+            // remainders of partial transfers stay in service
+            note_dequeued();
+            if (ur->op_ == request::READ)
+                uf->get_file_stats()->read_started(ur->bytes_, now);
+            else
+                uf->get_file_stats()->write_started(ur->bytes_, now);
+        }
+
+        const int buf_index =
+            get_buffer_index(static_cast<char*>(ur->buffer_) + ur->done_,
+                             ur->bytes_ - ur->done_);
+        ur->fill_sqe(get_sqe(), get_fixed_file(uf), buf_index);
+        commit_sqe();
+
+        // the kernel holds a reference while the request is posted
+        ur->posted_ref_ = std::move(req);
+        ++num_posted_;
+    }
+
+    return num_unsubmitted_;
+}
+
+void io_uring_queue::handle_completion(io_uring_request* ur, int res)
+{
+    // take back reference held by the kernel
+    request_ptr req = std::move(ur->posted_ref_);
+    --num_posted_;
+
+    if (res < 0)
+    {
+        std::ostringstream msg;
+        msg << "Error in io_uring_queue::handle_completion :"
+            << " this=" << ur->file_
+            << " call=io_uring " << (ur->op_ == request::READ ? "READ" : "WRITE")
+            << " offset=" << ur->offset_ + ur->done_
+            << " buffer=" << ur->buffer_
+            << " bytes=" << ur->bytes_ - ur->done_
+            << " : " << strerror(-res);
+        ur->error_occured(msg.str());
+        note_completed();
+        ur->completed(false);
+        return;
+    }
+
+    if (res == 0)
+    {
+        if (ur->op_ == request::READ)
+        {
+            // read request extends past end-of-file
+            // fill reminder with zeroes
+            memset(static_cast<char*>(ur->buffer_) + ur->done_, 0,
+                   ur->bytes_ - ur->done_);
+            ur->done_ = ur->bytes_;
+        }
+        else
+        {
+            ur->error_occured("Error in io_uring_queue::handle_completion :"
+                              " io_uring WRITE made no progress");
+            note_completed();
+            ur->completed(false);
+            return;
+        }
+    }
+
+    ur->done_ += static_cast<size_t>(res);
+
+    if (ur->done_ < ur->bytes_)
+    {
+        // partial transfer, resubmit the remainder first
+        std::unique_lock<std::mutex> lock(waiting_mtx_);
+        waiting_requests_.push_front(req);
+        return;
+    }
+
+    note_completed();
+    ur->completed(false);
+}
+
+void io_uring_queue::reap_completions()
+{
+    unsigned head = *cq_head_;
+
+    for ( ; ; )
+    {
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        if (head == tail)
+            break;
+
+        for ( ; head != tail; ++head)
+        {
+            io_uring_cqe* cqe = &cqes_[head & *cq_mask_];
+            __u64 user_data = cqe->user_data;
+            int res = cqe->res;
+
+            if (user_data == 0)
+            {
+                // wakeup poll fired, reset the eventfd counter
+                uint64_t value;
+                ssize_t rc = ::read(event_fd_, &value, sizeof(value));
+                STXXL_UNUSED(rc);
+                wakeup_armed_ = false;
+                continue;
+            }
+            if (user_data == 1)
+            {
+                // throttle timeout fired, a request still held back arms
+                // the next one
+                timeout_at_ = 0;
+                continue;
+            }
+
+            handle_completion(reinterpret_cast<io_uring_request*>(user_data), res);
+        }
+
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+}
+
+void io_uring_queue::run()
+{
+    for ( ; ; ) // as long as thread is running
+    {
+        // announce that we might block, add_request() will wake us up
+        sleeping_.store(true);
+
+        unsigned to_submit = fill_submission_ring();
+
+        // terminate if termination has been requested
+        if (thread_state_() == TERMINATING && num_posted_ == 0)
+        {
+            std::unique_lock<std::mutex> lock(waiting_mtx_);
+            if (waiting_requests_.empty())
+                break;
+        }
+
+        // submit all new entries and wait for at least one completion, the
+        // wakeup poll is always armed, so this returns on new requests, and
+        // the throttle timeout once held back requests are admitted.
+        long result = syscall(SYS_io_uring_enter, ring_fd_, to_submit, 1,
+                              IORING_ENTER_GETEVENTS, nullptr, _NSIG / 8);
+
+        sleeping_.store(false);
+
+        if (result < 0)
+        {
+            // interrupted by a signal, or completion ring is full
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                STXXL_THROW_ERRNO(io_error, "io_uring_queue::run"
+                                  " io_uring_enter() to_submit=" << to_submit);
+            }
+        }
+        else
+        {
+            num_unsubmitted_ -= static_cast<unsigned>(result);
+        }
+
+        reap_completions();
+    }
+}
+
+void* io_uring_queue::worker(void* arg)
+{
+    self_type* pthis = static_cast<self_type*>(arg);
+    pthis->run();
+
+    pthis->thread_state_.set_to(TERMINATED);
+    return nullptr;
+}
+
+} // namespace foxxll
+
+#endif // #if STXXL_HAVE_IO_URING_FILE
+// vim: et:ts=4:sw=4
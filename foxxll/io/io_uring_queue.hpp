@@ -0,0 +1,174 @@
+/***************************************************************************
+ *  foxxll/io/io_uring_queue.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef STXXL_IO_IO_URING_QUEUE_HEADER
+#define STXXL_IO_IO_URING_QUEUE_HEADER
+
+#include <foxxll/io/io_uring_file.hpp>
+
+#if STXXL_HAVE_IO_URING_FILE
+
+#include <foxxll/common/object_pool.hpp>
+#include <foxxll/io/fair_request_queue.hpp>
+#include <foxxll/io/request_queue_impl_worker.hpp>
+
+#include <linux/io_uring.h>
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace foxxll {
+
+class io_uring_request;
+
+//! \addtogroup reqlayer
+//! \{
+
+//! Queue for io_uring_file(s)
+//!
+//! Requests are written into the submission ring shared with the kernel and
+//! handed over in batches, completions are reaped from the completion ring.
+//! Unlike linuxaio_queue, a single thread does both: it blocks in
+//! io_uring_enter() waiting for completions and is woken by a poll on an
+//! eventfd when new requests arrive while it is sleeping. Requests held back
+//! by the throttle stay waiting, and a timeout entry wakes the thread once the
+//! throttle admits them, such that completions are reaped meanwhile.
+class io_uring_queue : public request_queue_impl_worker
+{
+    friend class io_uring_request;
+
+    using self_type = io_uring_queue;
+
+private:
+    //! io_uring file descriptor
+    int ring_fd_;
+
+    //! eventfd used to wake the worker thread out of io_uring_enter()
+    int event_fd_;
+
+    //! number of submission ring entries
+    unsigned entries_;
+
+    //! mmap-ed ring memory
+    void* sq_ring_ptr_, * cq_ring_ptr_;
+    size_t sq_ring_size_, cq_ring_size_;
+    io_uring_sqe* sqes_;
+    size_t sqes_size_;
+
+    //! pointers into the submission ring
+    unsigned* sq_head_, * sq_tail_, * sq_mask_, * sq_array_;
+
+    //! pointers into the completion ring
+    unsigned* cq_head_, * cq_tail_, * cq_mask_;
+    io_uring_cqe* cqes_;
+
+    //! storing io_uring_request* would drop ownership
+    using queue_type = std::list<request_ptr, pool_alloc<request_ptr> >;
+
+    // "waiting" requests have been submitted to this queue, but not yet
+    // placed into the submission ring.
+    std::mutex waiting_mtx_;
+    fair_request_queue waiting_requests_;
+
+    //! number of requests owned by the kernel, only touched by the worker
+    unsigned num_posted_;
+    //! entries written to the submission ring but not yet consumed
+    unsigned num_unsubmitted_;
+    //! whether the eventfd poll is currently armed
+    bool wakeup_armed_;
+    //! expiry of the throttle timeout armed last, 0 if it fired
+    double timeout_at_;
+    //! duration of that timeout, read by the kernel on submission
+    __kernel_timespec timeout_ts_;
+    //! since when the throttle holds back the next request, 0 if it does not
+    double throttled_since_;
+    //! set while the worker may be blocked in io_uring_enter()
+    std::atomic<bool> sleeping_;
+
+    //! registered file table: file descriptor per slot, -1 if free
+    std::mutex files_mtx_;
+    std::vector<int> fixed_files_;
+
+    //! registered buffers: start address -> length and slot in the kernel's
+    //! sparse buffer table, which is updated one slot at a time. The slots
+    //! hold the start addresses, nullptr if free, and are empty if the kernel
+    //! lacks the table or refused a registration.
+    std::mutex buffers_mtx_;
+    std::map<const char*, std::pair<size_t, int> > buffers_;
+    std::vector<const char*> buffer_slots_;
+    //! bytes pinned by the registered buffers
+    size_t registered_bytes_;
+
+    std::thread thread_;
+    shared_state<thread_state> thread_state_;
+
+    static void * worker(void* arg);   // thread start callback
+    void run();
+
+    unsigned fill_submission_ring();
+    void reap_completions();
+    void handle_completion(io_uring_request* req, int res);
+    void wake_up();
+    void arm_wakeup();
+    void arm_timeout(double seconds);
+    bool admit_request(io_uring_request* req);
+    bool update_buffer_slot(int slot, const char* buffer, size_t bytes);
+
+    io_uring_sqe * get_sqe();
+    void commit_sqe();
+
+    //! look up fixed file slot for a file, registers it on first use
+    int get_fixed_file(io_uring_file* file);
+    //! look up registered buffer index covering [buffer, buffer + bytes)
+    int get_buffer_index(const void* buffer, size_t bytes);
+
+public:
+    //! Construct queue. Requests desired number of ring entries, 0 means a
+    //! default of 64.
+    explicit io_uring_queue(int desired_queue_length = 0);
+
+    void set_priority_weights(const priority_weights& weights) final;
+    void add_request(request_ptr& req) final;
+    bool cancel_request(request_ptr& req) final;
+    bool boost_request(request_ptr& req) final;
+    void set_throttle_limits(const throttle_limits& limits) final;
+    ~io_uring_queue();
+
+    //! Register a buffer with the kernel, such that requests reading into or
+    //! writing from it need not map the pages on every I/O. Takes one slot of
+    //! the buffer table; if none is free, the buffer would exceed
+    //! RLIMIT_MEMLOCK, or the kernel refuses, requests to it use regular reads
+    //! and writes, after a refusal those to all buffers. Called by
+    //! disk_queues::register_buffer().
+    void register_buffer(const void* buffer, size_t bytes);
+
+    //! Remove a buffer from the registered set. Must be called before the
+    //! memory is freed and once no I/O to it is pending.
+    void unregister_buffer(const void* buffer);
+
+    //! Remove a file from the registered file table.
+    void unregister_file(io_uring_file* file);
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // #if STXXL_HAVE_IO_URING_FILE
+
+#endif // !STXXL_IO_IO_URING_QUEUE_HEADER
+// vim: et:ts=4:sw=4
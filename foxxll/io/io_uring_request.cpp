@@ -0,0 +1,97 @@
+/***************************************************************************
+ *  foxxll/io/io_uring_request.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/io/io_uring_request.hpp>
+
+#if STXXL_HAVE_IO_URING_FILE
+
+#include <foxxll/io/disk_queues.hpp>
+#include <foxxll/io/io_uring_queue.hpp>
+#include <foxxll/verbose.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace foxxll {
+
+void io_uring_request::completed(bool posted, bool canceled)
+{
+    STXXL_VERBOSE_IO_URING("io_uring_request[" << this << "] completed(" <<
+                           posted << "," << canceled << ")");
+    if (!canceled)
+    {
+        if (op_ == READ)
+            file_->get_file_stats()->read_finished();
+        else
+            file_->get_file_stats()->write_finished();
+    }
+    else if (posted)
+    {
+        if (op_ == READ)
+            file_->get_file_stats()->read_canceled(bytes_);
+        else
+            file_->get_file_stats()->write_canceled(bytes_);
+    }
+    request_with_state::completed(canceled);
+}
+
+void io_uring_request::fill_sqe(
+    io_uring_sqe* sqe, int fixed_file_index, int buf_index)
+{
+    io_uring_file* uf = dynamic_cast<io_uring_file*>(file_);
+
+    memset(sqe, 0, sizeof(*sqe));
+    if (buf_index >= 0) {
+        sqe->opcode = (op_ == READ) ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+        sqe->buf_index = static_cast<__u16>(buf_index);
+    }
+    else {
+        sqe->opcode = (op_ == READ) ? IORING_OP_READ : IORING_OP_WRITE;
+    }
+
+    if (fixed_file_index >= 0) {
+        sqe->fd = fixed_file_index;
+        sqe->flags |= IOSQE_FIXED_FILE;
+    }
+    else {
+        sqe->fd = uf->file_des_;
+    }
+
+    // the kernel transfers at most 2 GiB per call anyway, larger requests
+    // complete partially and are resubmitted.
+    sqe->off = offset_ + done_;
+    sqe->addr = reinterpret_cast<__u64>(static_cast<char*>(buffer_) + done_);
+    sqe->len = static_cast<__u32>(
+        std::min<size_type>(bytes_ - done_, size_type(1) << 30));
+    sqe->user_data = reinterpret_cast<__u64>(this);
+}
+
+//! Cancel the request
+//!
+//! Routine is called by user, as part of the request interface. Only requests
+//! not yet handed to the kernel can be canceled.
+bool io_uring_request::cancel()
+{
+    STXXL_VERBOSE_IO_URING("io_uring_request[" << this << "] cancel()");
+
+    if (!file_) return false;
+
+    request_ptr req(this);
+    io_uring_queue* queue = dynamic_cast<io_uring_queue*>(
+        disk_queues::get_instance()->get_queue(file_->get_queue_id()));
+    return queue->cancel_request(req);
+}
+
+} // namespace foxxll
+
+#endif // #if STXXL_HAVE_IO_URING_FILE
+// vim: et:ts=4:sw=4
@@ -0,0 +1,86 @@
+/***************************************************************************
+ *  foxxll/io/io_uring_request.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef STXXL_IO_IO_URING_REQUEST_HEADER
+#define STXXL_IO_IO_URING_REQUEST_HEADER
+
+#include <foxxll/io/io_uring_file.hpp>
+
+#if STXXL_HAVE_IO_URING_FILE
+
+#include <foxxll/common/object_pool.hpp>
+#include <foxxll/io/request_with_state.hpp>
+
+#include <linux/io_uring.h>
+
+#define STXXL_VERBOSE_IO_URING(msg) STXXL_VERBOSE2(msg)
+
+namespace foxxll {
+
+//! \addtogroup reqlayer
+//! \{
+
+//! Request for an io_uring_file.
+class io_uring_request : public request_with_state
+{
+    friend class io_uring_queue;
+
+    //! number of bytes already transferred, the kernel may complete a request
+    //! partially and the remainder is resubmitted.
+    size_type done_ = 0;
+
+    //! reference held by the kernel while the request is posted, the
+    //! completion entry's user_data points to this object.
+    request_ptr posted_ref_;
+
+    //! fill submission queue entry for the untransferred remainder
+    void fill_sqe(io_uring_sqe* sqe, int fixed_file_index, int buf_index);
+
+public:
+    io_uring_request(
+        const completion_handler& on_complete,
+        file* file, void* buffer, offset_type offset, size_type bytes,
+        const read_or_write& op)
+        : request_with_state(on_complete, file, buffer, offset, bytes, op)
+    {
+        assert(dynamic_cast<io_uring_file*>(file));
+        STXXL_VERBOSE_IO_URING(
+            "io_uring_request[" << this << "]" <<
+                " io_uring_request" <<
+                "(file=" << file << " buffer=" << buffer <<
+                " offset=" << offset << " bytes=" << bytes <<
+                " op=" << op << ")");
+    }
+
+    bool cancel() final;
+    void completed(bool posted, bool canceled);
+    void completed(bool canceled) { completed(true, canceled); }
+
+    static void * operator new (size_t bytes)
+    {
+        return object_pool<io_uring_request>::allocate(bytes);
+    }
+
+    static void operator delete (void* p, size_t bytes)
+    {
+        object_pool<io_uring_request>::deallocate(p, bytes);
+    }
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // #if STXXL_HAVE_IO_URING_FILE
+
+#endif // !STXXL_IO_IO_URING_REQUEST_HEADER
+// vim: et:ts=4:sw=4
@@ -13,6 +13,9 @@
  *  http://www.boost.org/LICENSE_1_0.txt)
  **************************************************************************/
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <iomanip>
 #include <mutex>
 #include <numeric>
@@ -28,103 +31,191 @@
 namespace foxxll {
 
 /******************************************************************************/
-// file_stats
+// latency_histogram
 
-file_stats::file_stats(unsigned int device_id)
-    : device_id_(device_id),
-      read_count_(0), write_count_(0),
-      read_bytes_(0), write_bytes_(0),
-      read_time_(0.0), write_time_(0.0),
-      p_begin_read_(0.0), p_begin_write_(0.0),
-      acc_reads_(0), acc_writes_(0)
-{ }
+constexpr size_t latency_histogram::sub_buckets;
+constexpr size_t latency_histogram::num_buckets;
 
-void file_stats::write_started(const size_t size, double now)
+uint64_t latency_histogram::count() const
 {
-    if (now == 0.0)
-        now = timestamp();
-
-    {
-        std::unique_lock<std::mutex> write_lock(write_mutex_);
+    return std::accumulate(counts_.begin(), counts_.end(), uint64_t(0));
+}
 
-        ++write_count_;
-        write_bytes_ += size;
-        const double diff = now - p_begin_write_;
-        write_time_ += (acc_writes_++) * diff;
-        p_begin_write_ = now;
+double latency_histogram::percentile(double percent) const
+{
+    const uint64_t total = count();
+    if (total == 0)
+        return 0.0;
+
+    // rank of the requested request, counting from one
+    uint64_t rank = static_cast<uint64_t>(
+        std::ceil(static_cast<double>(total) * percent / 100.0));
+    rank = std::max<uint64_t>(1, std::min(rank, total));
+
+    uint64_t seen = 0;
+    size_t b = 0;
+    for ( ; b < num_buckets - 1; ++b) {
+        seen += counts_[b];
+        if (seen >= rank)
+            break;
     }
 
-    stats::get_instance()->p_write_started(now);
+    const double begin = static_cast<double>(bucket_begin(b));
+    const double end = (b + 1 < num_buckets)
+                       ? static_cast<double>(bucket_begin(b + 1)) : 2 * begin;
+    return (begin + end) / 2.0 / 1e6;
 }
 
-void file_stats::write_canceled(const size_t size)
+latency_histogram latency_histogram::operator + (const latency_histogram& a) const
 {
-    {
-        std::unique_lock<std::mutex> write_lock(write_mutex_);
+    latency_histogram h;
+    for (size_t b = 0; b < num_buckets; ++b)
+        h.counts_[b] = counts_[b] + a.counts_[b];
+    return h;
+}
 
-        --write_count_;
-        write_bytes_ -= size;
-    }
-    write_finished();
+latency_histogram latency_histogram::operator - (const latency_histogram& a) const
+{
+    latency_histogram h;
+    for (size_t b = 0; b < num_buckets; ++b)
+        h.counts_[b] = counts_[b] - a.counts_[b];
+    return h;
 }
 
-void file_stats::write_finished()
+/******************************************************************************/
+// file_stats
+
+file_stats::file_stats(unsigned int device_id)
+    : device_id_(device_id)
 {
-    double now = timestamp();
+    for (size_t t = 0; t < NUM_LATENCY_TYPES; ++t) {
+        for (size_t b = 0; b < latency_histogram::num_buckets; ++b)
+            latency_[t][b].store(0, std::memory_order_relaxed);
+    }
+}
 
-    {
-        std::unique_lock<std::mutex> write_lock(write_mutex_);
+latency_histogram file_stats::get_latency(latency_type type) const
+{
+    latency_histogram h;
+    for (size_t b = 0; b < latency_histogram::num_buckets; ++b)
+        h.set_bucket(b, latency_[type][b].load(std::memory_order_relaxed));
+    return h;
+}
 
-        const double diff = now - p_begin_write_;
-        write_time_ += (acc_writes_--) * diff;
-        p_begin_write_ = now;
+void file_stats::add_latency(bool is_write, double submitted, double started,
+                             double now)
+{
+    auto to_micros = [](double seconds) {
+                         return seconds > 0.0 ? static_cast<uint64_t>(seconds * 1e6) : 0;
+                     };
+
+    if (submitted != 0.0) {
+        const size_t b = latency_histogram::bucket(to_micros(started - submitted));
+        latency_[is_write ? WRITE_QUEUE_LATENCY : READ_QUEUE_LATENCY][b]
+        .fetch_add(1, std::memory_order_relaxed);
     }
 
-    stats::get_instance()->p_write_finished(now);
+    const size_t b = latency_histogram::bucket(to_micros(now - started));
+    latency_[is_write ? WRITE_SERVICE_LATENCY : READ_SERVICE_LATENCY][b]
+    .fetch_add(1, std::memory_order_relaxed);
 }
 
-void file_stats::read_started(const size_t size, double now)
+double file_stats::get_time(size_t time_field, size_t running_field) const
+{
+    return static_cast<double>(counters_.get_time(
+                                   time_field, running_field,
+                                   stats::get_instance()->micros(timestamp()))) / 1e6;
+}
+
+void file_stats::started(size_t count_field, size_t bytes_field,
+                         size_t time_field, size_t running_field,
+                         size_t size, double now)
 {
     if (now == 0.0)
         now = timestamp();
 
+    stats* s = stats::get_instance();
+    const uint64_t t = s->micros(now);
+
     {
-        std::unique_lock<std::mutex> read_lock(read_mutex_);
+        counters_type::update u(counters_);
+        u.add(count_field, 1);
+        u.add(bytes_field, size);
+        u.add(running_field, 1);
+        u.add(time_field, uint64_t(0) - t);
+    }
 
-        ++read_count_;
-        read_bytes_ += size;
-        const double diff = now - p_begin_read_;
-        read_time_ += (acc_reads_++) * diff;
-        p_begin_read_ = now;
+    if (count_field == READ_COUNT)
+        s->p_read_started(t);
+    else
+        s->p_write_started(t);
+}
+
+void file_stats::finished(size_t time_field, size_t running_field)
+{
+    stats* s = stats::get_instance();
+    const uint64_t t = s->micros(timestamp());
+
+    {
+        counters_type::update u(counters_);
+        u.add(time_field, t);
+        u.add(running_field, uint64_t(0) - 1);
     }
 
-    stats::get_instance()->p_read_started(now);
+    if (time_field == READ_TIME)
+        s->p_read_finished(t);
+    else
+        s->p_write_finished(t);
 }
 
-void file_stats::read_canceled(const size_t size)
+void file_stats::write_started(const size_t size, double now)
+{
+    started(WRITE_COUNT, WRITE_BYTES, WRITE_TIME, WRITES_RUNNING, size, now);
+}
+
+void file_stats::write_canceled(const size_t size)
 {
     {
-        std::unique_lock<std::mutex> read_lock(read_mutex_);
+        counters_type::update u(counters_);
+        u.add(WRITE_COUNT, uint64_t(0) - 1);
+        u.add(WRITE_BYTES, uint64_t(0) - size);
+    }
+    write_finished();
+}
+
+void file_stats::write_finished()
+{
+    finished(WRITE_TIME, WRITES_RUNNING);
+}
 
-        --read_count_;
-        read_bytes_ -= size;
+void file_stats::read_started(const size_t size, double now)
+{
+    started(READ_COUNT, READ_BYTES, READ_TIME, READS_RUNNING, size, now);
+}
+
+void file_stats::read_canceled(const size_t size)
+{
+    {
+        counters_type::update u(counters_);
+        u.add(READ_COUNT, uint64_t(0) - 1);
+        u.add(READ_BYTES, uint64_t(0) - size);
     }
     read_finished();
 }
 
 void file_stats::read_finished()
 {
-    double now = timestamp();
-
-    {
-        std::unique_lock<std::mutex> read_lock(read_mutex_);
+    finished(READ_TIME, READS_RUNNING);
+}
 
-        const double diff = now - p_begin_read_;
-        read_time_ += (acc_reads_--) * diff;
-        p_begin_read_ = now;
-    }
+void file_stats::merged(bool is_write, size_t requests)
+{
+    if (requests < 2)
+        return;
 
-    stats::get_instance()->p_read_finished(now);
+    counters_type::update u(counters_);
+    u.add(is_write ? WRITE_COUNT : READ_COUNT, requests - 1);
+    u.add(is_write ? WRITE_MERGES : READ_MERGES, requests - 1);
 }
 
 /******************************************************************************/
@@ -140,10 +231,14 @@ file_stats_data file_stats_data::operator + (const file_stats_data& a) const
 
     fsd.read_count_ = read_count_ + a.read_count_;
     fsd.write_count_ = write_count_ + a.write_count_;
+    fsd.read_merges_ = read_merges_ + a.read_merges_;
+    fsd.write_merges_ = write_merges_ + a.write_merges_;
     fsd.read_bytes_ = read_bytes_ + a.read_bytes_;
     fsd.write_bytes_ = write_bytes_ + a.write_bytes_;
     fsd.read_time_ = read_time_ + a.read_time_;
     fsd.write_time_ = write_time_ + a.write_time_;
+    for (size_t t = 0; t < file_stats::NUM_LATENCY_TYPES; ++t)
+        fsd.latency_[t] = latency_[t] + a.latency_[t];
 
     return fsd;
 }
@@ -158,181 +253,358 @@ file_stats_data file_stats_data::operator - (const file_stats_data& a) const
 
     fsd.read_count_ = read_count_ - a.read_count_;
     fsd.write_count_ = write_count_ - a.write_count_;
+    fsd.read_merges_ = read_merges_ - a.read_merges_;
+    fsd.write_merges_ = write_merges_ - a.write_merges_;
     fsd.read_bytes_ = read_bytes_ - a.read_bytes_;
     fsd.write_bytes_ = write_bytes_ - a.write_bytes_;
     fsd.read_time_ = read_time_ - a.read_time_;
     fsd.write_time_ = write_time_ - a.write_time_;
+    for (size_t t = 0; t < file_stats::NUM_LATENCY_TYPES; ++t)
+        fsd.latency_[t] = latency_[t] - a.latency_[t];
 
     return fsd;
 }
 
+//! names of file_stats::latency_type in machine-readable output
+static const char* const latency_names[file_stats::NUM_LATENCY_TYPES] = {
+    "read_queue", "write_queue", "read_service", "write_service"
+};
+
+//! percentiles of latencies in machine-readable output
+static const double latency_percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+static const char* const latency_percentile_names[] = {
+    "p50", "p90", "p99", "p999"
+};
+
+void file_stats_data::to_json(std::ostream& o) const
+{
+    o << "{\"device_id\":" << device_id_
+      << ",\"read_count\":" << read_count_
+      << ",\"write_count\":" << write_count_
+      << ",\"read_merges\":" << read_merges_
+      << ",\"write_merges\":" << write_merges_
+      << ",\"read_bytes\":" << read_bytes_
+      << ",\"write_bytes\":" << write_bytes_
+      << ",\"read_time\":" << read_time_
+      << ",\"write_time\":" << write_time_
+      << ",\"latency\":{";
+    for (size_t t = 0; t < file_stats::NUM_LATENCY_TYPES; ++t)
+    {
+        o << (t ? "," : "") << '"' << latency_names[t] << "\":{"
+          << "\"count\":" << latency_[t].count();
+        for (size_t p = 0; p < 4; ++p) {
+            o << ",\"" << latency_percentile_names[p] << "\":"
+              << latency_[t].percentile(latency_percentiles[p]);
+        }
+        o << '}';
+    }
+    o << "}}";
+}
+
+void file_stats_data::csv_header(std::ostream& o)
+{
+    o << "device_id,read_count,write_count,read_merges,write_merges,"
+      << "read_bytes,write_bytes,read_time,write_time";
+    for (size_t t = 0; t < file_stats::NUM_LATENCY_TYPES; ++t)
+    {
+        o << ',' << latency_names[t] << "_count";
+        for (size_t p = 0; p < 4; ++p)
+            o << ',' << latency_names[t] << '_' << latency_percentile_names[p];
+    }
+}
+
+void file_stats_data::to_csv(std::ostream& o) const
+{
+    o << device_id_ << ',' << read_count_ << ',' << write_count_ << ','
+      << read_merges_ << ',' << write_merges_ << ','
+      << read_bytes_ << ',' << write_bytes_ << ','
+      << read_time_ << ',' << write_time_;
+    for (size_t t = 0; t < file_stats::NUM_LATENCY_TYPES; ++t)
+    {
+        o << ',' << latency_[t].count();
+        for (size_t p = 0; p < 4; ++p)
+            o << ',' << latency_[t].percentile(latency_percentiles[p]);
+    }
+}
+
+/******************************************************************************/
+// queue_stats
+
+queue_stats::queue_stats(int64_t queue_id)
+    : queue_id_(queue_id),
+      creation_time_(timestamp())
+{ }
+
+//! raise an atomic high-water mark to value
+static void raise_max(std::atomic<uint64_t>& max, uint64_t value)
+{
+    uint64_t old = max.load(std::memory_order_relaxed);
+    while (old < value &&
+           !max.compare_exchange_weak(old, value, std::memory_order_relaxed)) { }
+}
+
+void queue_stats::change(int waiting, int in_service)
+{
+    const uint64_t t = stats::get_instance()->micros(timestamp());
+
+    const uint64_t delta = static_cast<uint64_t>(
+        static_cast<int64_t>(waiting) + (static_cast<int64_t>(in_service) << 32));
+    const uint64_t old_depth = depth_.fetch_add(delta);
+    const uint64_t depth = old_depth + delta;
+
+    {
+        counters_type::update u(counters_);
+        u.add(WAITING, static_cast<uint64_t>(waiting));
+        u.add(IN_SERVICE, static_cast<uint64_t>(in_service));
+        u.add(WAITING_TIME, uint64_t(0) - static_cast<uint64_t>(waiting) * t);
+        u.add(IN_SERVICE_TIME, uint64_t(0) - static_cast<uint64_t>(in_service) * t);
+    }
+
+    const uint64_t depth_waiting = depth & 0xFFFFFFFF, depth_in_service = depth >> 32;
+    const uint64_t old_total = (old_depth & 0xFFFFFFFF) + (old_depth >> 32);
+    const uint64_t total = depth_waiting + depth_in_service;
+
+    // the queue becomes busy or idle
+    if (old_total == 0 && total != 0)
+        busy_.change(t, +1);
+    else if (old_total != 0 && total == 0)
+        busy_.change(t, -1);
+
+    raise_max(max_waiting_, depth_waiting);
+    raise_max(max_in_service_, depth_in_service);
+    raise_max(max_depth_, total);
+}
+
+void queue_stats::throttled(double seconds)
+{
+    counters_type::update u(counters_);
+    u.add(THROTTLED, 1);
+    u.add(THROTTLE_TIME, static_cast<uint64_t>(seconds * 1e6 + 0.5));
+}
+
+/******************************************************************************/
+// queue_stats_data
+
+queue_stats_data::queue_stats_data(const queue_stats& qs)
+{
+    const double now = timestamp();
+    const uint64_t t = stats::get_instance()->micros(now);
+
+    const uint64_t depth = qs.depth_.load();
+
+    queue_id_ = qs.queue_id_;
+    waiting_ = depth & 0xFFFFFFFF;
+    in_service_ = depth >> 32;
+    max_waiting_ = qs.max_waiting_.load(std::memory_order_relaxed);
+    max_in_service_ = qs.max_in_service_.load(std::memory_order_relaxed);
+    max_depth_ = qs.max_depth_.load(std::memory_order_relaxed);
+    // integrate the times up to now from the running counts
+    waiting_time_ = static_cast<double>(qs.counters_.get_time(
+                                            queue_stats::WAITING_TIME, queue_stats::WAITING, t)) / 1e6;
+    in_service_time_ = static_cast<double>(qs.counters_.get_time(
+                                               queue_stats::IN_SERVICE_TIME, queue_stats::IN_SERVICE, t)) / 1e6;
+    busy_time_ = qs.busy_.seconds(t);
+    throttled_ = qs.counters_.get(queue_stats::THROTTLED);
+    throttle_time_ = static_cast<double>(qs.counters_.get(queue_stats::THROTTLE_TIME)) / 1e6;
+    elapsed_ = std::max(0.0, now - qs.creation_time_);
+}
+
+queue_stats_data queue_stats_data::operator + (const queue_stats_data& a) const
+{
+    STXXL_THROW_IF(queue_id_ != a.queue_id_, std::runtime_error,
+                   "foxxll::queue_stats_data objects do not belong to the same queue");
+
+    queue_stats_data q = *this;
+    q.max_waiting_ = std::max(max_waiting_, a.max_waiting_);
+    q.max_in_service_ = std::max(max_in_service_, a.max_in_service_);
+    q.max_depth_ = std::max(max_depth_, a.max_depth_);
+    q.waiting_time_ = waiting_time_ + a.waiting_time_;
+    q.in_service_time_ = in_service_time_ + a.in_service_time_;
+    q.busy_time_ = busy_time_ + a.busy_time_;
+    q.throttled_ = throttled_ + a.throttled_;
+    q.throttle_time_ = throttle_time_ + a.throttle_time_;
+    q.elapsed_ = elapsed_ + a.elapsed_;
+    return q;
+}
+
+queue_stats_data queue_stats_data::operator - (const queue_stats_data& a) const
+{
+    STXXL_THROW_IF(queue_id_ != a.queue_id_, std::runtime_error,
+                   "foxxll::queue_stats_data objects do not belong to the same queue");
+
+    queue_stats_data q = *this;
+    q.waiting_time_ = waiting_time_ - a.waiting_time_;
+    q.in_service_time_ = in_service_time_ - a.in_service_time_;
+    q.busy_time_ = busy_time_ - a.busy_time_;
+    q.throttled_ = throttled_ - a.throttled_;
+    q.throttle_time_ = throttle_time_ - a.throttle_time_;
+    q.elapsed_ = elapsed_ - a.elapsed_;
+    return q;
+}
+
+void queue_stats_data::to_json(std::ostream& o) const
+{
+    o << "{\"queue_id\":" << queue_id_
+      << ",\"waiting\":" << waiting_
+      << ",\"in_service\":" << in_service_
+      << ",\"max_waiting\":" << max_waiting_
+      << ",\"max_in_service\":" << max_in_service_
+      << ",\"max_depth\":" << max_depth_
+      << ",\"avg_waiting\":" << get_avg_waiting()
+      << ",\"avg_in_service\":" << get_avg_in_service()
+      << ",\"utilization\":" << get_utilization()
+      << ",\"throttled\":" << throttled_
+      << ",\"throttle_time\":" << throttle_time_
+      << '}';
+}
+
+void queue_stats_data::csv_header(std::ostream& o)
+{
+    o << "queue_id,waiting,in_service,max_waiting,max_in_service,max_depth,"
+      << "avg_waiting,avg_in_service,utilization,throttled,throttle_time";
+}
+
+void queue_stats_data::to_csv(std::ostream& o) const
+{
+    o << queue_id_ << ',' << waiting_ << ',' << in_service_ << ','
+      << max_waiting_ << ',' << max_in_service_ << ',' << max_depth_ << ','
+      << get_avg_waiting() << ',' << get_avg_in_service() << ','
+      << get_utilization() << ',' << throttled_ << ',' << throttle_time_;
+}
+
 /******************************************************************************/
 // stats
 
 stats::stats()
-    : creation_time_(timestamp()),
-      p_reads_(0.0), p_writes_(0.0),
-      p_begin_read_(0.0), p_begin_write_(0.0),
-      p_ios_(0.0),
-      p_begin_io_(0.0),
-
-      acc_reads_(0.0), acc_writes_(0.0),
-      acc_ios_(0.0),
-
-      t_waits_(0.0), p_waits_(0.0),
-      p_begin_wait_(0.0),
-      t_wait_read_(0.0), p_wait_read_(0.0),
-      p_begin_wait_read_(0.0),
-      t_wait_write_(0.0), p_wait_write_(0.0),
-      p_begin_wait_write_(0.0),
-      acc_waits_(0.0),
-      acc_wait_read_(0.0), acc_wait_write_(0.0)
+    : creation_time_(timestamp())
 { }
 
+double stats::get_wait_time(size_t time_field, size_t running_field) const
+{
+    return static_cast<double>(wait_counters_.get_time(
+                                   time_field, running_field, micros(timestamp()))) / 1e6;
+}
+
+void stats::boosted_wait_finished(double seconds)
+{
+    wait_counters_type::update u(wait_counters_);
+    u.add(BOOSTED_WAITS, 1);
+    u.add(BOOSTED_WAIT_TIME, static_cast<uint64_t>(seconds * 1e6 + 0.5));
+}
+
 #ifndef STXXL_DO_NOT_COUNT_WAIT_TIME
 void stats::wait_started(wait_op_type wait_op)
 {
-    const double now = timestamp();
-    {
-        std::unique_lock<std::mutex> wait_lock(wait_mutex_);
+    const uint64_t now = micros(timestamp());
 
-        double diff = now - p_begin_wait_;
-        t_waits_ += acc_waits_ * diff;
-        p_begin_wait_ = now;
-        p_waits_ += (acc_waits_++) ? diff : 0.0;
+    wait_counters_type::update u(wait_counters_);
 
-        if (wait_op == WAIT_OP_READ) {
-            diff = now - p_begin_wait_read_;
-            t_wait_read_ += acc_wait_read_ * diff;
-            p_begin_wait_read_ = now;
-            p_wait_read_ += (acc_wait_read_++) ? diff : 0.0;
-        }
-        else /* if (wait_op == WAIT_OP_WRITE) */ {
-            // wait_any() is only used from write_pool and buffered_writer, so account WAIT_OP_ANY for WAIT_OP_WRITE, too
-            diff = now - p_begin_wait_write_;
-            t_wait_write_ += acc_wait_write_ * diff;
-            p_begin_wait_write_ = now;
-            p_wait_write_ += (acc_wait_write_++) ? diff : 0.0;
-        }
+    u.add(WAITS_RUNNING, 1);
+    u.add(WAIT_TIME, uint64_t(0) - now);
+
+    if (wait_op == WAIT_OP_READ) {
+        u.add(WAITS_READ_RUNNING, 1);
+        u.add(WAIT_READ_TIME, uint64_t(0) - now);
+    }
+    else /* if (wait_op == WAIT_OP_WRITE) */ {
+        // wait_any() is only used from write_pool and buffered_writer, so account WAIT_OP_ANY for WAIT_OP_WRITE, too
+        u.add(WAITS_WRITE_RUNNING, 1);
+        u.add(WAIT_WRITE_TIME, uint64_t(0) - now);
     }
 }
 
 void stats::wait_finished(const wait_op_type wait_op)
 {
-    const double now = timestamp();
+    const uint64_t now = micros(timestamp());
+
     {
-        std::unique_lock<std::mutex> wait_lock(wait_mutex_);
+        wait_counters_type::update u(wait_counters_);
 
-        double diff = now - p_begin_wait_;
-        t_waits_ += acc_waits_ * diff;
-        p_begin_wait_ = now;
-        p_waits_ += (acc_waits_--) ? diff : 0.0;
+        u.add(WAIT_TIME, now);
+        u.add(WAITS_RUNNING, uint64_t(0) - 1);
 
         if (wait_op == WAIT_OP_READ) {
-            double diff2 = now - p_begin_wait_read_;
-            t_wait_read_ += acc_wait_read_ * diff2;
-            p_begin_wait_read_ = now;
-            p_wait_read_ += (acc_wait_read_--) ? diff2 : 0.0;
+            u.add(WAIT_READ_TIME, now);
+            u.add(WAITS_READ_RUNNING, uint64_t(0) - 1);
         }
         else /* if (wait_op == WAIT_OP_WRITE) */ {
-            double diff2 = now - p_begin_wait_write_;
-            t_wait_write_ += acc_wait_write_ * diff2;
-            p_begin_wait_write_ = now;
-            p_wait_write_ += (acc_wait_write_--) ? diff2 : 0.0;
+            u.add(WAIT_WRITE_TIME, now);
+            u.add(WAITS_WRITE_RUNNING, uint64_t(0) - 1);
         }
+    }
 #ifdef STXXL_WAIT_LOG_ENABLED
-        std::ofstream* waitlog = foxxll::logger::get_instance()->waitlog_stream();
-        if (waitlog)
-            *waitlog << (now - last_reset) << "\t"
-                     << ((wait_op == WAIT_OP_READ) ? diff : 0.0) << "\t"
-                     << ((wait_op != WAIT_OP_READ) ? diff : 0.0) << "\t"
-                     << t_wait_read_ << "\t" << t_wait_write_ << "\n" << line_prefix << std::flush;
-#endif
+    std::ofstream* waitlog = foxxll::logger::get_instance()->waitlog_stream();
+    if (waitlog) {
+        const double wait_read = get_wait_read_time();
+        const double wait_write = get_wait_write_time();
+
+        std::unique_lock<std::mutex> lock(waitlog_mutex_);
+        // time since the previous finished wait, in the column of the op
+        const double diff = (now - std::min(waitlog_last_, now)) / 1e6;
+        waitlog_last_ = std::max(waitlog_last_, now);
+        *waitlog << (now / 1e6) << "\t"
+                 << ((wait_op == WAIT_OP_READ) ? diff : 0.0) << "\t"
+                 << ((wait_op != WAIT_OP_READ) ? diff : 0.0) << "\t"
+                 << wait_read << "\t" << wait_write << std::endl;
     }
+#endif
 }
 #endif
 
-void stats::p_write_started(const double now)
+void stats::p_write_started(const uint64_t now)
 {
-    {
-        std::unique_lock<std::mutex> write_lock(write_mutex_);
-
-        const double diff = now - p_begin_write_;
-        p_begin_write_ = now;
-        p_writes_ += (acc_writes_++) ? diff : 0.0;
-    }
-    {
-        std::unique_lock<std::mutex> io_lock(io_mutex_);
-
-        const double diff = now - p_begin_io_;
-        p_ios_ += (acc_ios_++) ? diff : 0.0;
-        p_begin_io_ = now;
-    }
+    p_writes_.change(now, +1);
+    p_ios_.change(now, +1);
 }
 
-void stats::p_write_finished(const double now)
+void stats::p_write_finished(const uint64_t now)
 {
-    {
-        std::unique_lock<std::mutex> write_lock(write_mutex_);
-
-        const double diff = now - p_begin_write_;
-        p_begin_write_ = now;
-        p_writes_ += (acc_writes_--) ? diff : 0.0;
-    }
-    {
-        std::unique_lock<std::mutex> io_lock(io_mutex_);
-
-        const double diff = now - p_begin_io_;
-        p_ios_ += (acc_ios_--) ? diff : 0.0;
-        p_begin_io_ = now;
-    }
+    p_writes_.change(now, -1);
+    p_ios_.change(now, -1);
 }
 
-void stats::p_read_started(const double now)
+void stats::p_read_started(const uint64_t now)
 {
-    {
-        std::unique_lock<std::mutex> read_lock(read_mutex_);
-
-        const double diff = now - p_begin_read_;
-        p_begin_read_ = now;
-        p_reads_ += (acc_reads_++) ? diff : 0.0;
-    }
-    {
-        std::unique_lock<std::mutex> io_lock(io_mutex_);
-
-        const double diff = now - p_begin_io_;
-        p_ios_ += (acc_ios_++) ? diff : 0.0;
-        p_begin_io_ = now;
-    }
+    p_reads_.change(now, +1);
+    p_ios_.change(now, +1);
 }
 
-void stats::p_read_finished(const double now)
+void stats::p_read_finished(const uint64_t now)
 {
-    {
-        const double diff = now - p_begin_read_;
-        p_begin_read_ = now;
-        p_reads_ += (acc_reads_--) ? diff : 0.0;
-    }
-    {
-        const double diff = now - p_begin_io_;
-        p_ios_ += (acc_ios_--) ? diff : 0.0;
-        p_begin_io_ = now;
-    }
+    p_reads_.change(now, -1);
+    p_ios_.change(now, -1);
 }
 
 file_stats* stats::create_file_stats(unsigned int device_id)
 {
+    std::unique_lock<std::mutex> lock(file_stats_list_mutex_);
     file_stats_list_.emplace_back(device_id);
     return &file_stats_list_.back();
 }
 
 std::vector<file_stats_data> stats::deepcopy_file_stats_data_list() const
 {
+    std::unique_lock<std::mutex> lock(file_stats_list_mutex_);
     return {
                file_stats_list_.cbegin(), file_stats_list_.cend()
     };
 }
 
+queue_stats* stats::create_queue_stats(int64_t queue_id)
+{
+    std::unique_lock<std::mutex> lock(queue_stats_list_mutex_);
+    queue_stats_list_.emplace_back(queue_id);
+    return &queue_stats_list_.back();
+}
+
+std::vector<queue_stats_data> stats::deepcopy_queue_stats_data_list() const
+{
+    std::unique_lock<std::mutex> lock(queue_stats_list_mutex_);
+    return {
+               queue_stats_list_.cbegin(), queue_stats_list_.cend()
+    };
+}
+
 std::ostream& operator << (std::ostream& o, const stats& s)
 {
     o << stats_data(s);
@@ -343,6 +615,23 @@ std::ostream& operator << (std::ostream& o, const stats& s)
 /******************************************************************************/
 // stats_data
 
+//! Combine the queue gauges of two snapshots. Queues are only appended, hence
+//! those missing in b are taken from a as they are.
+template <typename Operation>
+static std::vector<queue_stats_data> combine_queue_stats(
+    const std::vector<queue_stats_data>& a, const std::vector<queue_stats_data>& b,
+    const Operation& op)
+{
+    STXXL_THROW_IF(b.size() > a.size(), std::runtime_error,
+                   "The number of queues has changed between the snapshots.");
+
+    std::vector<queue_stats_data> result;
+    result.reserve(a.size());
+    for (size_t i = 0; i < a.size(); ++i)
+        result.push_back(i < b.size() ? op(a[i], b[i]) : a[i]);
+    return result;
+}
+
 template <typename T, typename Functor>
 T stats_data::fetch_sum(const Functor& get_value) const
 {
@@ -424,7 +713,15 @@ stats_data stats_data::operator + (const stats_data& a) const
     s.t_wait = t_wait + a.t_wait;
     s.t_wait_read_ = t_wait_read_ + a.t_wait_read_;
     s.t_wait_write_ = t_wait_write_ + a.t_wait_write_;
+    s.n_boosted_waits_ = n_boosted_waits_ + a.n_boosted_waits_;
+    s.t_boosted_wait_ = t_boosted_wait_ + a.t_boosted_wait_;
     s.elapsed_ = elapsed_ + a.elapsed_;
+    s.queue_stats_data_list_ =
+        (queue_stats_data_list_.size() >= a.queue_stats_data_list_.size())
+        ? combine_queue_stats(queue_stats_data_list_, a.queue_stats_data_list_,
+                              std::plus<queue_stats_data>())
+        : combine_queue_stats(a.queue_stats_data_list_, queue_stats_data_list_,
+                              std::plus<queue_stats_data>());
     return s;
 }
 
@@ -445,6 +742,18 @@ stats_data stats_data::operator - (const stats_data& a) const
             s.file_stats_data_list_.push_back((*it1) - (*it2));
         }
     }
+    else if (file_stats_data_list_.size() > a.file_stats_data_list_.size())
+    {
+        // files are only appended, new ones are taken as they are
+        auto it1 = file_stats_data_list_.cbegin();
+        for (auto it2 = a.file_stats_data_list_.cbegin();
+             it2 != a.file_stats_data_list_.cend(); it1++, it2++)
+        {
+            s.file_stats_data_list_.push_back((*it1) - (*it2));
+        }
+        s.file_stats_data_list_.insert(
+            s.file_stats_data_list_.end(), it1, file_stats_data_list_.cend());
+    }
     else
     {
         STXXL_THROW(std::runtime_error,
@@ -457,7 +766,12 @@ stats_data stats_data::operator - (const stats_data& a) const
     s.t_wait = t_wait - a.t_wait;
     s.t_wait_read_ = t_wait_read_ - a.t_wait_read_;
     s.t_wait_write_ = t_wait_write_ - a.t_wait_write_;
+    s.n_boosted_waits_ = n_boosted_waits_ - a.n_boosted_waits_;
+    s.t_boosted_wait_ = t_boosted_wait_ - a.t_boosted_wait_;
     s.elapsed_ = elapsed_ - a.elapsed_;
+    s.queue_stats_data_list_ =
+        combine_queue_stats(queue_stats_data_list_, a.queue_stats_data_list_,
+                            std::minus<queue_stats_data>());
     return s;
 }
 
@@ -496,6 +810,18 @@ stats_data::summary<unsigned> stats_data::get_write_count_summary() const
     };
 }
 
+unsigned stats_data::get_read_merges() const
+{
+    return fetch_sum<unsigned>(
+        [](const file_stats_data& fsd) { return fsd.get_read_merges(); });
+}
+
+unsigned stats_data::get_write_merges() const
+{
+    return fetch_sum<unsigned>(
+        [](const file_stats_data& fsd) { return fsd.get_write_merges(); });
+}
+
 external_size_type stats_data::get_read_bytes() const
 {
     return fetch_sum<external_size_type>(
@@ -633,6 +959,100 @@ double stats_data::get_wait_write_time() const
     return t_wait_write_;
 }
 
+uint64_t stats_data::get_boosted_waits() const
+{
+    return n_boosted_waits_;
+}
+
+double stats_data::get_boosted_wait_time() const
+{
+    return t_boosted_wait_;
+}
+
+latency_histogram stats_data::get_latency(file_stats::latency_type type) const
+{
+    latency_histogram h;
+    for (const file_stats_data& fsd : file_stats_data_list_)
+        h = h + fsd.get_latency(type);
+    return h;
+}
+
+//! print percentiles of a pair of latency histograms in milliseconds
+static void print_latency(std::ostream& o, const latency_histogram& queue,
+                          const latency_histogram& service)
+{
+    for (const double p : { 50.0, 90.0, 99.0, 99.9 })
+    {
+        o << (p == 50.0 ? "" : ", ") << "p" << p << " "
+          << queue.percentile(p) * 1e3 << "/"
+          << service.percentile(p) * 1e3 << " ms";
+    }
+}
+
+void stats_data::to_json(std::ostream& o) const
+{
+    o << "{\"elapsed\":" << elapsed_
+      << ",\"pread_time\":" << p_reads_
+      << ",\"pwrite_time\":" << p_writes_
+      << ",\"pio_time\":" << p_ios_
+      << ",\"io_wait_time\":" << t_wait
+      << ",\"wait_read_time\":" << t_wait_read_
+      << ",\"wait_write_time\":" << t_wait_write_
+      << ",\"boosted_waits\":" << n_boosted_waits_
+      << ",\"boosted_wait_time\":" << t_boosted_wait_
+      << ",\"files\":[";
+    for (size_t i = 0; i < file_stats_data_list_.size(); ++i)
+    {
+        o << (i ? "," : "");
+        file_stats_data_list_[i].to_json(o);
+    }
+    o << "],\"queues\":[";
+    for (size_t i = 0; i < queue_stats_data_list_.size(); ++i)
+    {
+        o << (i ? "," : "");
+        queue_stats_data_list_[i].to_json(o);
+    }
+    o << "]}";
+}
+
+void stats_data::csv_header(std::ostream& o, const std::string& line_prefix)
+{
+    o << line_prefix << "elapsed,";
+    file_stats_data::csv_header(o);
+    o << ',';
+    queue_stats_data::csv_header(o);
+    o << '\n';
+}
+
+//! write as many empty columns as a header has
+static void csv_empty_columns(std::ostream& o, void (* header)(std::ostream&))
+{
+    std::ostringstream names;
+    header(names);
+    const std::string s = names.str();
+    o << std::string(std::count(s.begin(), s.end(), ','), ',');
+}
+
+void stats_data::to_csv(std::ostream& o, const std::string& line_prefix) const
+{
+    for (const file_stats_data& fsd : file_stats_data_list_)
+    {
+        o << line_prefix << elapsed_ << ',';
+        fsd.to_csv(o);
+        o << ',';
+        csv_empty_columns(o, &queue_stats_data::csv_header);
+        o << '\n';
+    }
+    for (const queue_stats_data& qsd : queue_stats_data_list_)
+    {
+        o << line_prefix << elapsed_ << ',';
+        csv_empty_columns(o, &file_stats_data::csv_header);
+        o << ',';
+        qsd.to_csv(o);
+        o << '\n';
+    }
+}
+
 std::string format_with_SI_IEC_unit_multiplier(
     const uint64_t number, const std::string& unit, int multiplier)
 {
@@ -691,6 +1111,10 @@ void stats_data::to_ostream(std::ostream& o, const std::string line_prefix) cons
 
     o << " total number of reads                      : "
       << add_IEC_binary_multiplier(get_read_count()) << "\n" << line_prefix;
+    if (get_read_merges()) {
+        o << "  merged into the I/O of an adjacent read   : "
+          << add_IEC_binary_multiplier(get_read_merges()) << "\n" << line_prefix;
+    }
     o << " average block size (read)                  : "
       << add_IEC_binary_multiplier(get_read_count() ? get_read_bytes() / get_read_count() : 0, "B")
       << "\n" << line_prefix;
@@ -717,8 +1141,12 @@ void stats_data::to_ostream(std::ostream& o, const std::string line_prefix) cons
     }
 
     o << " total number of writes                     : "
-      << add_IEC_binary_multiplier(get_write_count()) << "\n" << line_prefix
-      << " average block size (write)                 : "
+      << add_IEC_binary_multiplier(get_write_count()) << "\n" << line_prefix;
+    if (get_write_merges()) {
+        o << "  merged into the I/O of an adjacent write  : "
+          << add_IEC_binary_multiplier(get_write_merges()) << "\n" << line_prefix;
+    }
+    o << " average block size (write)                 : "
       << add_IEC_binary_multiplier(get_write_count() ? get_write_bytes() / get_write_count() : 0, "B") << "\n" << line_prefix
       << " number of bytes written to disks           : "
       << add_IEC_binary_multiplier(get_write_bytes(), "B") << "\n" << line_prefix
@@ -763,6 +1191,39 @@ void stats_data::to_ostream(std::ostream& o, const std::string line_prefix) cons
         o << " I/O wait4write time                        : "
           << get_wait_write_time() << " s\n" << line_prefix;
 #endif
+    if (get_boosted_waits() != 0)
+        o << " I/O waits boosting their request           : "
+          << get_boosted_waits() << " waits, "
+          << get_boosted_wait_time() << " s\n" << line_prefix;
+    const latency_histogram read_service = get_read_service_latency();
+    if (read_service.count() != 0) {
+        o << " read latency (queue/service)               : ";
+        print_latency(o, get_read_queue_latency(), read_service);
+        o << "\n" << line_prefix;
+    }
+    const latency_histogram write_service = get_write_service_latency();
+    if (write_service.count() != 0) {
+        o << " write latency (queue/service)              : ";
+        print_latency(o, get_write_queue_latency(), write_service);
+        o << "\n" << line_prefix;
+    }
+    for (const queue_stats_data& q : queue_stats_data_list_)
+    {
+        if (q.get_max_depth() == 0)
+            continue;
+        o << " queue " << std::setw(3) << std::left << q.get_queue_id() << std::right
+          << " depth (waiting/in service)       : "
+          << "avg " << q.get_avg_waiting() << "/" << q.get_avg_in_service()
+          << ", max " << q.get_max_waiting() << "/" << q.get_max_in_service()
+          << ", utilization " << q.get_utilization() * 100.0 << " %"
+          << "\n" << line_prefix;
+        if (q.get_throttled() != 0)
+            o << " queue " << std::setw(3) << std::left << q.get_queue_id() << std::right
+              << " throttled                        : "
+              << q.get_throttled() << " I/Os, delayed "
+              << q.get_throttle_time() << " s"
+              << "\n" << line_prefix;
+    }
     o << " Time since the last reset                  : "
       << get_elapsed_time() << " s";
 
@@ -18,11 +18,15 @@
 #define STXXL_IO_IOSTATS_HEADER
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
 #include <limits>
 #include <list>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -40,24 +44,276 @@ namespace foxxll {
 //!
 //! \{
 
+//! A fixed number of 64-bit counters updated concurrently by many threads
+//! without locking. Each thread adds to one of several shards, which are
+//! only summed up when the counters are read. Values wrap around, such that
+//! the sums of signed quantities are correct when interpreted as int64_t.
+template <size_t Fields>
+class sharded_counters
+{
+    struct shard
+    {
+        std::atomic<uint64_t> values[Fields];
+        //! number of updates in progress, and of finished updates
+        std::atomic<uint64_t> busy, generation;
+        //! readers that gave up retrying and hold back new updates
+        mutable std::atomic<uint64_t> readers;
+        //! keeps the values of different shards on different cache lines
+        char padding[64];
+    };
+
+    shard shards_[16];
+
+    //! threads are assigned to shards round-robin
+    shard& local_shard()
+    {
+        static std::atomic<size_t> next { 0 };
+        static thread_local size_t index = next++;
+        return shards_[index % (sizeof(shards_) / sizeof(shard))];
+    }
+
+public:
+    sharded_counters()
+    {
+        for (shard& s : shards_) {
+            for (std::atomic<uint64_t>& v : s.values)
+                v.store(0);
+            s.busy.store(0);
+            s.generation.store(0);
+            s.readers.store(0);
+        }
+    }
+
+    //! Changes several counters of the calling thread's shard, such that
+    //! get_time() sees either none or all of them.
+    class update
+    {
+        shard& shard_;
+
+    public:
+        explicit update(sharded_counters& c)
+            : shard_(c.local_shard())
+        {
+            // announce the update before checking for readers, which announce
+            // themselves before checking for updates, and back off while one
+            // holds back updates
+            shard_.busy.fetch_add(1);
+            while (shard_.readers.load() != 0)
+            {
+                shard_.busy.fetch_sub(1);
+                while (shard_.readers.load() != 0)
+                    std::this_thread::yield();
+                shard_.busy.fetch_add(1);
+            }
+        }
+
+        ~update()
+        {
+            shard_.generation.fetch_add(1);
+            shard_.busy.fetch_sub(1);
+        }
+
+        void add(size_t field, uint64_t value)
+        {
+            shard_.values[field].fetch_add(value);
+        }
+    };
+
+    //! sum of a counter over all shards
+    uint64_t get(size_t field) const
+    {
+        uint64_t sum = 0;
+        for (const shard& s : shards_)
+            sum += s.values[field].load();
+        return sum;
+    }
+
+    //! Returns time + running * now for a counter of end minus start times
+    //! and a counter of running operations. Starting operations have to
+    //! increment running and subtract their start time in one update.
+    int64_t get_time(size_t time_field, size_t running_field, uint64_t now) const
+    {
+        //! optimistic reads of a shard before holding back its updates
+        static constexpr size_t max_retries = 16;
+
+        uint64_t result = 0;
+        for (const shard& s : shards_)
+        {
+            uint64_t running, time;
+            size_t retries = 0;
+            for ( ; retries < max_retries; ++retries)
+            {
+                uint64_t generation = s.generation.load();
+                if (s.busy.load() != 0)
+                    continue;
+                running = s.values[running_field].load();
+                time = s.values[time_field].load();
+                if (s.busy.load() == 0 && s.generation.load() == generation)
+                    break;
+            }
+
+            if (retries == max_retries)
+            {
+                // updates keep overlapping the reads: stop new updates of
+                // the shard and wait for those in progress to finish
+                s.readers.fetch_add(1);
+                while (s.busy.load() != 0)
+                    std::this_thread::yield();
+                running = s.values[running_field].load();
+                time = s.values[time_field].load();
+                s.readers.fetch_sub(1);
+            }
+
+            result += time + running * now;
+        }
+        return std::max<int64_t>(static_cast<int64_t>(result), 0);
+    }
+};
+
+//! Measures the time during which at least one of several concurrent
+//! operations is running, without locking: begin and end events exchange the
+//! number of running operations together with the time of the last event in
+//! one atomic word, and add the time since that event if any was running.
+class parallel_time
+{
+    //! low 16 bits: running operations, high 48 bits: microseconds of the
+    //! last event since the stats were created.
+    std::atomic<uint64_t> state_ { 0 };
+    //! accumulated microseconds
+    std::atomic<uint64_t> total_ { 0 };
+
+    static constexpr uint64_t count_mask = 0xFFFF;
+
+public:
+    //! operation began (delta = 1) or ended (delta = -1) at time now
+    void change(uint64_t now, int delta)
+    {
+        uint64_t old = state_.load(std::memory_order_relaxed), last;
+        do {
+            // events of different threads may arrive slightly out of order
+            last = std::max(now, old >> 16);
+            uint64_t next = (last << 16) |
+                            ((old + static_cast<uint64_t>(delta)) & count_mask);
+            if (state_.compare_exchange_weak(old, next, std::memory_order_relaxed))
+                break;
+        } while (true);
+
+        if (old & count_mask)
+            total_.fetch_add(last - (old >> 16), std::memory_order_relaxed);
+    }
+
+    //! time in seconds, including the currently running period
+    double seconds(uint64_t now) const
+    {
+        uint64_t state = state_.load(std::memory_order_relaxed);
+        uint64_t total = total_.load(std::memory_order_relaxed);
+        if ((state & count_mask) && now > (state >> 16))
+            total += now - (state >> 16);
+        return static_cast<double>(total) / 1e6;
+    }
+};
+
+//! Log-bucketed histogram of request latencies. Bucket boundaries grow by a
+//! factor of 2^(1/4) starting at one microsecond, hence percentiles are
+//! accurate to about 10%.
+class latency_histogram
+{
+public:
+    //! buckets per power of two
+    static constexpr size_t sub_buckets = 4;
+    //! latencies up to 2^40 microseconds (12 days) are distinguished
+    static constexpr size_t num_buckets = 40 * sub_buckets;
+
+    //! bucket of a latency in microseconds
+    static size_t bucket(uint64_t micros)
+    {
+        if (micros < sub_buckets)
+            return static_cast<size_t>(micros);
+        size_t exp = 0;
+        while ((micros >> exp) >= 2 * sub_buckets)
+            ++exp;
+        return std::min(num_buckets - 1,
+                        (exp + 1) * sub_buckets
+                        + static_cast<size_t>(micros >> exp) - sub_buckets);
+    }
+
+    //! smallest latency in microseconds falling into a bucket
+    static uint64_t bucket_begin(size_t b)
+    {
+        if (b < sub_buckets)
+            return b;
+        return (sub_buckets + b % sub_buckets) << (b / sub_buckets - 1);
+    }
+
+    latency_histogram()
+    {
+        counts_.fill(0);
+    }
+
+    //! number of requests in a bucket
+    uint64_t get_bucket(size_t b) const
+    {
+        return counts_[b];
+    }
+
+    void set_bucket(size_t b, uint64_t count)
+    {
+        counts_[b] = count;
+    }
+
+    //! total number of requests
+    uint64_t count() const;
+
+    //! Latency in seconds which the given percentage of requests did not
+    //! exceed, e.g. percentile(99.9). Returns the middle of the bucket.
+    double percentile(double percent) const;
+
+    latency_histogram operator + (const latency_histogram& a) const;
+    latency_histogram operator - (const latency_histogram& a) const;
+
+private:
+    std::array<uint64_t, num_buckets> counts_;
+};
+
 class file_stats
 {
+public:
+    //! kinds of latencies collected per file
+    enum latency_type {
+        //! time from submission to disk_queues until served
+        READ_QUEUE_LATENCY, WRITE_QUEUE_LATENCY,
+        //! time from the start of serving until completion
+        READ_SERVICE_LATENCY, WRITE_SERVICE_LATENCY,
+        NUM_LATENCY_TYPES
+    };
+
+private:
     //! associated device id
     const unsigned device_id_;
 
-    //! number of operations: read/write
-    unsigned read_count_, write_count_;
-    //! number of bytes read/written
-    external_size_type read_bytes_, write_bytes_;
-    //! seconds spent in operations
-    double read_time_, write_time_;
-    //! start time of parallel operation
-    double p_begin_read_, p_begin_write_;
+    //! fields of counters_
+    enum {
+        //! number of operations: read/write
+        READ_COUNT, WRITE_COUNT,
+        //! number of bytes read/written
+        READ_BYTES, WRITE_BYTES,
+        //! sum of end minus sum of start times of operations, in microseconds
+        READ_TIME, WRITE_TIME,
+        //! number of running operations, added to the times when reading
+        READS_RUNNING, WRITES_RUNNING,
+        //! number of requests served by the I/O of an adjacent request
+        READ_MERGES, WRITE_MERGES,
+        NUM_FIELDS
+    };
 
-    //! number of requests, participating in parallel operation
-    int acc_reads_, acc_writes_;
+    using counters_type = sharded_counters<NUM_FIELDS>;
+    counters_type counters_;
 
-    std::mutex read_mutex_, write_mutex_;
+    //! seconds spent in operations, as if serialized
+    double get_time(size_t time_field, size_t running_field) const;
+
+    //! bucket counters of the latency histograms
+    std::atomic<uint64_t> latency_[NUM_LATENCY_TYPES][latency_histogram::num_buckets];
 
 public:
     //! construct zero initialized
@@ -191,28 +447,42 @@ public:
     //! \return total number of read_count_
     unsigned get_read_count() const
     {
-        return read_count_;
+        return static_cast<unsigned>(counters_.get(READ_COUNT));
     }
 
     //! Returns total number of write_count_.
     //! \return total number of write_count_
     unsigned get_write_count() const
     {
-        return write_count_;
+        return static_cast<unsigned>(counters_.get(WRITE_COUNT));
+    }
+
+    //! Returns the number of read requests which were merged into the I/O
+    //! of an adjacent request, and are included in get_read_count().
+    unsigned get_read_merges() const
+    {
+        return static_cast<unsigned>(counters_.get(READ_MERGES));
+    }
+
+    //! Returns the number of write requests which were merged into the I/O
+    //! of an adjacent request, and are included in get_write_count().
+    unsigned get_write_merges() const
+    {
+        return static_cast<unsigned>(counters_.get(WRITE_MERGES));
     }
 
     //! Returns number of bytes read from disks.
     //! \return number of bytes read
     external_size_type get_read_bytes() const
     {
-        return read_bytes_;
+        return counters_.get(READ_BYTES);
     }
 
     //! Returns number of bytes written to the disks.
     //! \return number of bytes written
     external_size_type get_write_bytes() const
     {
-        return write_bytes_;
+        return counters_.get(WRITE_BYTES);
     }
 
     //! Time that would be spent in read syscalls if all parallel read_count_
@@ -220,7 +490,7 @@ public:
     //! \return seconds spent in reading
     double get_read_time() const
     {
-        return read_time_;
+        return get_time(READ_TIME, READS_RUNNING);
     }
 
     //! Time that would be spent in write syscalls if all parallel write_count_
@@ -228,9 +498,16 @@ public:
     //! \return seconds spent in writing
     double get_write_time() const
     {
-        return write_time_;
+        return get_time(WRITE_TIME, WRITES_RUNNING);
     }
 
+    //! Returns a copy of the latency histogram of the given type.
+    latency_histogram get_latency(latency_type type) const;
+
+    //! Account latencies of a completed request, given the timestamps of its
+    //! submission (0 if unknown), of the start of serving, and of completion.
+    void add_latency(bool is_write, double submitted, double started, double now);
+
     // for library use
     void write_started(const size_t size_, double now = 0.0);
     void write_canceled(const size_t size_);
@@ -238,6 +515,14 @@ public:
     void read_started(const size_t size_, double now = 0.0);
     void read_canceled(const size_t size_);
     void read_finished();
+    //! One I/O started by read_started() or write_started() served the given
+    //! number of adjacent requests: counts the additional ones as merged.
+    void merged(bool is_write, size_t requests);
+
+private:
+    void started(size_t count_field, size_t bytes_field, size_t time_field,
+                 size_t running_field, size_t size, double now);
+    void finished(size_t time_field, size_t running_field);
 };
 
 class file_stats_data
@@ -246,15 +531,20 @@ class file_stats_data
     unsigned device_id_;
     //! number of operations
     unsigned read_count_, write_count_;
+    //! number of operations merged into the I/O of an adjacent one
+    unsigned read_merges_, write_merges_;
     //! number of bytes read/written
     external_size_type read_bytes_, write_bytes_;
     //! seconds spent in operations
     double read_time_, write_time_;
+    //! latency histograms, indexed by file_stats::latency_type
+    latency_histogram latency_[file_stats::NUM_LATENCY_TYPES];
 
 public:
     file_stats_data()
         : device_id_(std::numeric_limits<unsigned>::max()),
           read_count_(0), write_count_(0),
+          read_merges_(0), write_merges_(0),
           read_bytes_(0), write_bytes_(0),
           read_time_(0.0), write_time_(0.0)
     { }
@@ -264,11 +554,16 @@ public:
         : device_id_(fs.get_device_id()),
           read_count_(fs.get_read_count()),
           write_count_(fs.get_write_count()),
+          read_merges_(fs.get_read_merges()),
+          write_merges_(fs.get_write_merges()),
           read_bytes_(fs.get_read_bytes()),
           write_bytes_(fs.get_write_bytes()),
           read_time_(fs.get_read_time()),
           write_time_(fs.get_write_time())
-    { }
+    {
+        for (size_t t = 0; t < file_stats::NUM_LATENCY_TYPES; ++t)
+            latency_[t] = fs.get_latency(static_cast<file_stats::latency_type>(t));
+    }
 
     file_stats_data operator + (const file_stats_data& a) const;
     file_stats_data operator - (const file_stats_data& a) const;
@@ -288,6 +583,16 @@ public:
         return write_count_;
     }
 
+    unsigned get_read_merges() const
+    {
+        return read_merges_;
+    }
+
+    unsigned get_write_merges() const
+    {
+        return write_merges_;
+    }
+
     external_size_type get_read_bytes() const
     {
         return read_bytes_;
@@ -307,6 +612,209 @@ public:
     {
         return write_time_;
     }
+
+    const latency_histogram& get_latency(file_stats::latency_type type) const
+    {
+        return latency_[type];
+    }
+
+    //! Write the statistics as one JSON object.
+    void to_json(std::ostream& o) const;
+
+    //! Write the comma separated column names of to_csv().
+    static void csv_header(std::ostream& o);
+
+    //! Write the statistics as comma separated values, without newline.
+    void to_csv(std::ostream& o) const;
+};
+
+class queue_stats_data;
+
+//! Gauges of one request_queue: how many requests are waiting in the queue and
+//! how many are being served (posted to the operating system or executed by a
+//! worker thread), their high-water marks, and their integrals over time.
+//! Events are counted without locking; the integrals are only computed by
+//! queue_stats_data.
+class queue_stats
+{
+    friend class queue_stats_data;
+
+    //! queue id as used by disk_queues
+    const int64_t queue_id_;
+
+    //! low 32 bits: waiting requests, high 32 bits: requests in service
+    std::atomic<uint64_t> depth_ { 0 };
+    std::atomic<uint64_t> max_waiting_ { 0 }, max_in_service_ { 0 }, max_depth_ { 0 };
+
+    //! fields of counters_
+    enum {
+        //! number of waiting and in service requests, added to the times
+        //! when reading
+        WAITING, IN_SERVICE,
+        //! sum of end minus sum of start times of waiting and serving, in
+        //! microseconds
+        WAITING_TIME, IN_SERVICE_TIME,
+        //! I/Os delayed by the queue's throttle, and their delay in
+        //! microseconds
+        THROTTLED, THROTTLE_TIME,
+        NUM_FIELDS
+    };
+
+    using counters_type = sharded_counters<NUM_FIELDS>;
+    counters_type counters_;
+
+    //! seconds with at least one request in the queue or in service
+    parallel_time busy_;
+
+    const double creation_time_;
+
+    void change(int waiting, int in_service);
+
+public:
+    explicit queue_stats(int64_t queue_id);
+
+    int64_t get_queue_id() const
+    {
+        return queue_id_;
+    }
+
+    //! a request was added to the queue
+    void added()
+    {
+        change(+1, 0);
+    }
+
+    //! a request was taken from the queue to be served
+    void dequeued()
+    {
+        change(-1, +1);
+    }
+
+    //! a waiting request was canceled
+    void canceled()
+    {
+        change(-1, 0);
+    }
+
+    //! a request finished being served
+    void completed()
+    {
+        change(0, -1);
+    }
+
+    //! an I/O was delayed by the throttle
+    void throttled(double seconds);
+};
+
+//! Snapshot of queue_stats. Subtracting an earlier snapshot yields the
+//! averages over the interval; current values and high-water marks are those
+//! of the later snapshot.
+class queue_stats_data
+{
+    int64_t queue_id_;
+
+    uint64_t waiting_, in_service_;
+    uint64_t max_waiting_, max_in_service_, max_depth_;
+    double waiting_time_, in_service_time_, busy_time_;
+    uint64_t throttled_;
+    double throttle_time_;
+
+    //! seconds covered by the time integrals
+    double elapsed_;
+
+public:
+    queue_stats_data()
+        : queue_id_(0),
+          waiting_(0), in_service_(0),
+          max_waiting_(0), max_in_service_(0), max_depth_(0),
+          waiting_time_(0.0), in_service_time_(0.0), busy_time_(0.0),
+          throttled_(0), throttle_time_(0.0),
+          elapsed_(0.0)
+    { }
+
+    queue_stats_data(const queue_stats& qs); // implicit conversion -- NOLINT
+
+    queue_stats_data operator + (const queue_stats_data& a) const;
+    queue_stats_data operator - (const queue_stats_data& a) const;
+
+    int64_t get_queue_id() const
+    {
+        return queue_id_;
+    }
+
+    //! Requests currently waiting in the queue.
+    uint64_t get_waiting() const
+    {
+        return waiting_;
+    }
+
+    //! Requests currently being served.
+    uint64_t get_in_service() const
+    {
+        return in_service_;
+    }
+
+    //! High-water mark of waiting requests.
+    uint64_t get_max_waiting() const
+    {
+        return max_waiting_;
+    }
+
+    //! High-water mark of requests in service.
+    uint64_t get_max_in_service() const
+    {
+        return max_in_service_;
+    }
+
+    //! High-water mark of waiting plus in service requests.
+    uint64_t get_max_depth() const
+    {
+        return max_depth_;
+    }
+
+    //! Time-weighted average number of waiting requests.
+    double get_avg_waiting() const
+    {
+        return elapsed_ > 0.0 ? waiting_time_ / elapsed_ : 0.0;
+    }
+
+    //! Time-weighted average number of requests in service.
+    double get_avg_in_service() const
+    {
+        return elapsed_ > 0.0 ? in_service_time_ / elapsed_ : 0.0;
+    }
+
+    //! Fraction of time with at least one request waiting or in service.
+    double get_utilization() const
+    {
+        return elapsed_ > 0.0 ? busy_time_ / elapsed_ : 0.0;
+    }
+
+    //! Number of I/Os delayed by the queue's throttle.
+    uint64_t get_throttled() const
+    {
+        return throttled_;
+    }
+
+    //! Seconds the throttle delayed I/Os, as if serialized.
+    double get_throttle_time() const
+    {
+        return throttle_time_;
+    }
+
+    double get_elapsed_time() const
+    {
+        return elapsed_;
+    }
+
+    //! Write the gauges as one JSON object.
+    void to_json(std::ostream& o) const;
+
+    //! Write the comma separated column names of to_csv().
+    static void csv_header(std::ostream& o);
+
+    //! Write the gauges as comma separated values, without newline.
+    void to_csv(std::ostream& o) const;
 };
 
 //! Collects various I/O statistics.
@@ -322,37 +830,57 @@ class stats : public singleton<stats>
     //! enclosed file_stats objects and this list may grow.
     std::list<file_stats> file_stats_list_;
 
-    // *** parallel times have to be counted globally ***
+    //! protects file_stats_list_
+    mutable std::mutex file_stats_list_mutex_;
 
-    //! seconds spent in parallel operations
-    double p_reads_, p_writes_;
-    //! start time of parallel operation
-    double p_begin_read_, p_begin_write_;
-    // seconds spent in all parallel I/O operations (read and write)
-    double p_ios_;
-    double p_begin_io_;
+    //! gauges of all request queues, std::list for the same reason
+    std::list<queue_stats> queue_stats_list_;
 
-    // number of requests, participating in parallel operation
-    int acc_reads_, acc_writes_;
-    int acc_ios_;
+    //! protects queue_stats_list_
+    mutable std::mutex queue_stats_list_mutex_;
+
+    // *** parallel times have to be counted globally ***
+
+    //! periods in which reads, writes, or any I/O operations were running
+    parallel_time p_reads_, p_writes_, p_ios_;
 
     // *** waits are measured globally ***
 
-    // seconds spent waiting for completion of I/O operations
-    double t_waits_, p_waits_;
-    double p_begin_wait_;
-    double t_wait_read_, p_wait_read_;
-    double p_begin_wait_read_;
-    double t_wait_write_, p_wait_write_;
-    double p_begin_wait_write_;
-    int acc_waits_;
-    int acc_wait_read_, acc_wait_write_;
+    //! fields of wait_counters_
+    enum {
+        //! sum of end minus sum of start times of waits, in microseconds
+        WAIT_TIME, WAIT_READ_TIME, WAIT_WRITE_TIME,
+        //! number of running waits, added to the times when reading
+        WAITS_RUNNING, WAITS_READ_RUNNING, WAITS_WRITE_RUNNING,
+        //! number of waits which boosted their request, and their duration in
+        //! microseconds
+        BOOSTED_WAITS, BOOSTED_WAIT_TIME,
+        NUM_WAIT_FIELDS
+    };
+
+    using wait_counters_type = sharded_counters<NUM_WAIT_FIELDS>;
+    wait_counters_type wait_counters_;
 
-    std::mutex wait_mutex_, read_mutex_, write_mutex_, io_mutex_;
+#ifdef STXXL_WAIT_LOG_ENABLED
+    //! microseconds of the last finished wait, and serializes the waitlog
+    uint64_t waitlog_last_ = 0;
+    std::mutex waitlog_mutex_;
+#endif
 
     //! private construction from singleton
     stats();
 
+    //! seconds spent waiting, as if serialized
+    double get_wait_time(size_t time_field, size_t running_field) const;
+
+public:
+    //! microseconds since creation, the time unit of all counters
+    uint64_t micros(double now) const
+    {
+        return now > creation_time_
+               ? static_cast<uint64_t>((now - creation_time_) * 1e6 + 0.5) : 0;
+    }
+
 public:
     enum wait_op_type {
         WAIT_OP_ANY,
@@ -416,43 +944,63 @@ public:
     //! statistics. (for internal library use.)
     file_stats * create_file_stats(unsigned device_id);
 
+    //! return list of queue gauges (copied from each queue_stats)
+    std::vector<queue_stats_data> deepcopy_queue_stats_data_list() const;
+
+    //! create new instance of a queue_stats for a request_queue. (for internal
+    //! library use.)
+    queue_stats * create_queue_stats(int64_t queue_id);
+
     //! I/O wait time counter.
     //! \return number of seconds spent in I/O waiting functions \link
     //! request::wait request::wait \endlink, \c wait_any and \c wait_all
     double get_io_wait_time() const
     {
-        return t_waits_;
+        return get_wait_time(WAIT_TIME, WAITS_RUNNING);
     }
 
     double get_wait_read_time() const
     {
-        return t_wait_read_;
+        return get_wait_time(WAIT_READ_TIME, WAITS_READ_RUNNING);
     }
 
     double get_wait_write_time() const
     {
-        return t_wait_write_;
+        return get_wait_time(WAIT_WRITE_TIME, WAITS_WRITE_RUNNING);
+    }
+
+    //! Number of waits which moved their request to the head of its disk
+    //! queue, since it was still waiting there.
+    uint64_t get_boosted_waits() const
+    {
+        return wait_counters_.get(BOOSTED_WAITS);
+    }
+
+    //! Seconds spent in finished waits which boosted their request.
+    double get_boosted_wait_time() const
+    {
+        return static_cast<double>(wait_counters_.get(BOOSTED_WAIT_TIME)) / 1e6;
     }
 
     //! Period of time when at least one I/O thread was executing a read.
     //! \return seconds spent in reading
     double get_pread_time() const
     {
-        return p_reads_;
+        return p_reads_.seconds(micros(timestamp()));
     }
 
     //! Period of time when at least one I/O thread was executing a write.
     //! \return seconds spent in writing
     double get_pwrite_time() const
     {
-        return p_writes_;
+        return p_writes_.seconds(micros(timestamp()));
     }
 
     //! Period of time when at least one I/O thread was executing a read or a write.
     //! \return seconds spent in I/O
     double get_pio_time() const
     {
-        return p_ios_;
+        return p_ios_.seconds(micros(timestamp()));
     }
 
     friend std::ostream& operator << (std::ostream& o, const stats& s);
@@ -460,15 +1008,18 @@ public:
     // for library use
 
 private:
-    // only called from file_stats
-    void p_write_started(double now);
-    void p_write_finished(double now);
-    void p_read_started(double now);
-    void p_read_finished(double now);
+    // only called from file_stats, with microseconds since creation
+    void p_write_started(uint64_t now);
+    void p_write_finished(uint64_t now);
+    void p_read_started(uint64_t now);
+    void p_read_finished(uint64_t now);
 
 public:
     void wait_started(wait_op_type wait_op_);
     void wait_finished(wait_op_type wait_op_);
+
+    //! a wait which boosted its request finished after the given seconds
+    void boosted_wait_finished(double seconds);
 };
 
 #ifdef STXXL_DO_NOT_COUNT_WAIT_TIME
@@ -485,11 +1036,18 @@ class stats_data
     double t_wait;
     double t_wait_read_, t_wait_write_;
 
+    //! number and seconds of waits which boosted their request
+    uint64_t n_boosted_waits_;
+    double t_boosted_wait_;
+
     double elapsed_;
 
     //! list of individual file statistics.
     std::vector<file_stats_data> file_stats_data_list_;
 
+    //! list of request queue gauges.
+    std::vector<queue_stats_data> queue_stats_data_list_;
+
     //! aggregator
     template <typename T, typename Functor>
     T fetch_sum(const Functor& get_value) const;
@@ -513,6 +1071,7 @@ public:
           p_ios_(0.0),
           t_wait(0.0),
           t_wait_read_(0.0), t_wait_write_(0.0),
+          n_boosted_waits_(0), t_boosted_wait_(0.0),
           elapsed_(0.0)
     { }
 
@@ -523,8 +1082,11 @@ public:
           t_wait(s.get_io_wait_time()),
           t_wait_read_(s.get_wait_read_time()),
           t_wait_write_(s.get_wait_write_time()),
+          n_boosted_waits_(s.get_boosted_waits()),
+          t_boosted_wait_(s.get_boosted_wait_time()),
           elapsed_(timestamp() - s.get_creation_time()),
-          file_stats_data_list_(s.deepcopy_file_stats_data_list())
+          file_stats_data_list_(s.deepcopy_file_stats_data_list()),
+          queue_stats_data_list_(s.deepcopy_queue_stats_data_list())
     { }
 
     stats_data operator + (const stats_data& a) const;
@@ -533,6 +1095,12 @@ public:
     //! Returns the number of file_stats_data objects
     size_t num_files() const;
 
+    //! Returns the gauges of all request queues.
+    const std::vector<queue_stats_data> & get_queue_stats() const
+    {
+        return queue_stats_data_list_;
+    }
+
     //! Returns the sum of all read_count_.
     //! \return the sum of all read_count_
     unsigned get_read_count() const;
@@ -549,6 +1117,12 @@ public:
     //! \returns a summary of the write measurements
     stats_data::summary<unsigned> get_write_count_summary() const;
 
+    //! Returns the number of reads merged into the I/O of an adjacent read.
+    unsigned get_read_merges() const;
+
+    //! Returns the number of writes merged into the I/O of an adjacent write.
+    unsigned get_write_merges() const;
+
     //! Returns number of bytes read from disks in total.
     //! \return number of bytes read
     external_size_type get_read_bytes() const;
@@ -623,8 +1197,53 @@ public:
 
     double get_wait_write_time() const;
 
+    //! Number of waits which moved their request to the head of its disk
+    //! queue.
+    uint64_t get_boosted_waits() const;
+
+    //! Seconds spent in waits which boosted their request.
+    double get_boosted_wait_time() const;
+
+    //! Returns the latency histogram of the given type summed over all files.
+    latency_histogram get_latency(file_stats::latency_type type) const;
+
+    //! Distribution of the time read requests waited in the queues.
+    latency_histogram get_read_queue_latency() const
+    {
+        return get_latency(file_stats::READ_QUEUE_LATENCY);
+    }
+
+    //! Distribution of the time write requests waited in the queues.
+    latency_histogram get_write_queue_latency() const
+    {
+        return get_latency(file_stats::WRITE_QUEUE_LATENCY);
+    }
+
+    //! Distribution of the time read requests took to be served.
+    latency_histogram get_read_service_latency() const
+    {
+        return get_latency(file_stats::READ_SERVICE_LATENCY);
+    }
+
+    //! Distribution of the time write requests took to be served.
+    latency_histogram get_write_service_latency() const
+    {
+        return get_latency(file_stats::WRITE_SERVICE_LATENCY);
+    }
+
     void to_ostream(std::ostream& o, const std::string line_prefix = "") const;
 
+    //! Write all statistics as one JSON object, without newline.
+    void to_json(std::ostream& o) const;
+
+    //! Write the header line matching to_csv(), preceded by line_prefix.
+    static void csv_header(std::ostream& o, const std::string& line_prefix = "");
+
+    //! Write one line of comma separated values per file and per request
+    //! queue, each preceded by line_prefix. File lines leave the queue columns
+    //! empty and vice versa.
+    void to_csv(std::ostream& o, const std::string& line_prefix = "") const;
+
     friend std::ostream& operator << (std::ostream& o, const stats_data& s)
     {
         s.to_ostream(o);
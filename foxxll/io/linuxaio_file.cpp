@@ -35,6 +35,8 @@ request_ptr linuxaio_file::awrite(
     void* buffer, offset_type offset, size_type bytes,
     const completion_handler& on_complete)
 {
+    cancel_discard(offset, bytes);
+
     request_ptr req = tlx::make_counting<linuxaio_request>(
         on_complete, this, buffer, offset, bytes, request::WRITE);
 
@@ -18,10 +18,13 @@
 #include <foxxll/common/error_handling.hpp>
 #include <foxxll/io/linuxaio_queue.hpp>
 #include <foxxll/io/linuxaio_request.hpp>
+#include <foxxll/io/request_trace.hpp>
 #include <foxxll/mng/block_manager.hpp>
 #include <foxxll/verbose.hpp>
 
 #include <algorithm>
+#include <ctime>
+#include <vector>
 
 #include <sys/syscall.h>
 #include <unistd.h>
@@ -32,6 +35,12 @@
 
 namespace foxxll {
 
+//! number of posted requests from which on completions are reaped in batches
+static const int getevents_batch_threshold = 8;
+
+//! maximum time to wait for a batch of completions to accumulate
+static const long getevents_batch_timeout_ns = 50 * 1000;
+
 linuxaio_queue::linuxaio_queue(int desired_queue_length)
     : num_waiting_requests_(0), num_free_events_(0), num_posted_requests_(0),
       post_thread_state_(NOT_RUNNING), wait_thread_state_(NOT_RUNNING)
@@ -81,12 +90,21 @@ void linuxaio_queue::add_request(request_ptr& req)
     if (!dynamic_cast<linuxaio_request*>(req.get()))
         STXXL_ERRMSG("Non-LinuxAIO request submitted to LinuxAIO queue.");
 
+    // before it can be dequeued
+    note_added();
+
     std::unique_lock<std::mutex> lock(waiting_mtx_);
 
     waiting_requests_.push_back(req);
     num_waiting_requests_.signal();
 }
 
+void linuxaio_queue::set_priority_weights(const priority_weights& weights)
+{
+    std::unique_lock<std::mutex> lock(waiting_mtx_);
+    waiting_requests_.set_weights(weights);
+}
+
 bool linuxaio_queue::cancel_request(request_ptr& req)
 {
     if (req.empty())
@@ -96,15 +114,12 @@ bool linuxaio_queue::cancel_request(request_ptr& req)
     if (!dynamic_cast<linuxaio_request*>(req.get()))
         STXXL_ERRMSG("Non-LinuxAIO request submitted to LinuxAIO queue.");
 
-    queue_type::iterator pos;
     {
         std::unique_lock<std::mutex> lock(waiting_mtx_);
 
-        pos = std::find(
-            waiting_requests_.begin(), waiting_requests_.end(), req);
-        if (pos != waiting_requests_.end())
+        if (waiting_requests_.erase(req))
         {
-            waiting_requests_.erase(pos);
+            note_canceled();
 
             // polymorphic_downcast to linuxaio_request,
             // request is canceled, but was not yet posted.
@@ -115,38 +130,27 @@ bool linuxaio_queue::cancel_request(request_ptr& req)
         }
     }
 
-    std::unique_lock<std::mutex> lock(posted_mtx_);
-
-    pos = std::find(posted_requests_.begin(), posted_requests_.end(), req);
-    if (pos != posted_requests_.end())
-    {
-        // polymorphic_downcast to linuxaio_request,
-        bool canceled_io_operation =
-            (dynamic_cast<linuxaio_request*>(req.get()))->cancel_aio();
-
-        if (canceled_io_operation)
-        {
-            posted_requests_.erase(pos);
-
-            // polymorphic_downcast to linuxaio_request,
-
-            // request is canceled, already posted
-            dynamic_cast<linuxaio_request*>(req.get())->completed(true, true);
+    // the request is posted, about to be posted, or completed already. Only
+    // in the first case io_cancel() succeeds, and the request is completed as
+    // canceled via handle_events().
+    return dynamic_cast<linuxaio_request*>(req.get())->cancel_aio();
+}
 
-            num_free_events_.signal();
-            num_posted_requests_.wait(); // will never block
-            return true;
-        }
-    }
+bool linuxaio_queue::boost_request(request_ptr& req)
+{
+    if (req.empty())
+        STXXL_THROW_INVALID_ARGUMENT("Empty request boosted in disk_queue.");
 
-    return false;
+    std::unique_lock<std::mutex> lock(waiting_mtx_);
+    return waiting_requests_.boost(req);
 }
 
 // internal routines, run by the posting thread
 void linuxaio_queue::post_requests()
 {
-    request_ptr req;
     io_event* events = new io_event[max_events_];
+    std::vector<request_ptr> batch;
+    batch.reserve(max_events_);
 
     for ( ; ; ) // as long as thread is running
     {
@@ -158,48 +162,90 @@ void linuxaio_queue::post_requests()
             break;
 
         std::unique_lock<std::mutex> lock(waiting_mtx_);
-        if (!waiting_requests_.empty())
+        if (waiting_requests_.empty())
         {
-            req = waiting_requests_.front();
-            waiting_requests_.pop_front();
             lock.unlock();
 
-            num_free_events_.wait(); // might block because too many requests are posted
+            // num_waiting_requests_-- was premature, compensate for that
+            num_waiting_requests_.signal();
+            continue;
+        }
 
-            // polymorphic_downcast
-            while (!dynamic_cast<linuxaio_request*>(req.get())->post())
-            {
-                // post failed, so first handle events to make queues (more)
-                // empty, then try again.
+        batch.push_back(waiting_requests_.pop());
+        lock.unlock();
+        request_trace::event(batch.back().get(), request_trace::DEQUEUE);
+        note_dequeued();
 
-                // wait for at least one event to complete, no time limit
-                long num_events = syscall(SYS_io_getevents, context_, 1, max_events_, events, nullptr);
-                if (num_events < 0) {
-                    STXXL_THROW_ERRNO(io_error, "linuxaio_queue::post_requests"
-                                      " io_getevents() nr_events=" << num_events);
-                }
+        num_free_events_.wait(); // might block because too many requests are posted
 
-                handle_events(events, num_events, false);
-            }
+        // drain further waiting requests, as long as there are free events,
+        // to submit them with a single io_submit() call.
+        lock.lock();
+        while (!waiting_requests_.empty() &&
+               batch.size() < static_cast<size_t>(max_events_) &&
+               num_free_events_.try_wait())
+        {
+            num_waiting_requests_.wait(); // will never block
+            batch.push_back(waiting_requests_.pop());
+            request_trace::event(batch.back().get(), request_trace::DEQUEUE);
+            note_dequeued();
+        }
+        lock.unlock();
 
-            // request is finally posted
+        for (const request_ptr& req : batch)
+            throttle(req->get_op(), req->get_size());
 
-            {
-                std::unique_lock<std::mutex> lock(posted_mtx_);
-                posted_requests_.push_back(req);
-                num_posted_requests_.signal();
-            }
-        }
-        else
+        submit_batch(batch, events);
+        batch.clear();
+    }
+
+    delete[] events;
+}
+
+void linuxaio_queue::submit_batch(std::vector<request_ptr>& batch, io_event* events)
+{
+    // io_submit might take considerable time, so we have to remember the
+    // current time before the call.
+    double now = timestamp();
+
+    cbs_.resize(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        // polymorphic_downcast, the control block keeps a reference
+        cbs_[i] = dynamic_cast<linuxaio_request*>(batch[i].get())->prepare_post(batch[i], now);
+    }
+
+    size_t submitted = 0;
+    while (submitted < batch.size())
+    {
+        long success = syscall(SYS_io_submit, context_,
+                               batch.size() - submitted, cbs_.data() + submitted);
+
+        if (success > 0)
         {
-            lock.unlock();
+            // requests are finally posted
+            num_posted_requests_.signal(static_cast<size_t>(success));
+            submitted += static_cast<size_t>(success);
+            continue;
+        }
 
-            // num_waiting_requests_-- was premature, compensate for that
-            num_waiting_requests_.signal();
+        if (success == -1 && errno != EAGAIN) {
+            STXXL_THROW_ERRNO(io_error, "linuxaio_queue::submit_batch"
+                              " io_submit() nr=" << batch.size() - submitted);
         }
-    }
 
-    delete[] events;
+        // post failed, so first handle events to make queues (more) empty,
+        // then try again.
+
+        // wait for at least one event to complete, no time limit
+        long num_events = syscall(SYS_io_getevents, context_, 1, max_events_, events, nullptr);
+        if (num_events < 0) {
+            STXXL_THROW_ERRNO(io_error, "linuxaio_queue::submit_batch"
+                              " io_getevents() nr_events=" << num_events);
+        }
+
+        handle_events(events, num_events, false);
+    }
 }
 
 void linuxaio_queue::handle_events(io_event* events, long num_events, bool canceled)
@@ -207,9 +253,12 @@ void linuxaio_queue::handle_events(io_event* events, long num_events, bool cance
     for (int e = 0; e < num_events; ++e)
     {
         // size_t is as long as a pointer, and like this, we avoid an icpc warning
-        request_ptr* r = reinterpret_cast<request_ptr*>(static_cast<size_t>(events[e].data));
-        r->get()->completed(canceled);
-        delete r;                    // release auto_ptr reference
+        linuxaio_request* r = reinterpret_cast<linuxaio_request*>(
+            static_cast<size_t>(events[e].data));
+        // take back reference held by the control block
+        request_ptr req = std::move(r->posted_ref_);
+        note_completed();
+        r->completed(canceled);
         num_free_events_.signal();
         num_posted_requests_.wait(); // will never block
     }
@@ -230,9 +279,24 @@ void linuxaio_queue::wait_requests()
         if (wait_thread_state_() == TERMINATING && num_currently_posted_requests == 0)
             break;
 
+        // under high load, reap several completions per syscall, but do not
+        // delay the first completion by more than a short timeout.
+        long num_events = 0;
+        if (num_currently_posted_requests + 1 >= getevents_batch_threshold)
+        {
+            timespec timeout = { 0, getevents_batch_timeout_ns };
+            num_events = syscall(
+                SYS_io_getevents, context_,
+                (num_currently_posted_requests + 1) / 2, max_events_,
+                events, &timeout);
+            if (num_events < 0 && errno != EINTR) {
+                STXXL_THROW_ERRNO(io_error, "linuxaio_queue::wait_requests"
+                                  " io_getevents() nr_events=" << max_events_);
+            }
+        }
+
         // wait for at least one of them to finish
-        long num_events;
-        while (1) {
+        while (num_events <= 0) {
             num_events = syscall(SYS_io_getevents, context_, 1, max_events_, events, nullptr);
             if (num_events < 0) {
                 if (errno == EINTR) {
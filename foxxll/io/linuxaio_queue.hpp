@@ -14,16 +14,18 @@
 #ifndef STXXL_IO_LINUXAIO_QUEUE_HEADER
 #define STXXL_IO_LINUXAIO_QUEUE_HEADER
 
+#include <foxxll/common/object_pool.hpp>
 #include <foxxll/io/linuxaio_file.hpp>
 
 #if STXXL_HAVE_LINUXAIO_FILE
 
+#include <foxxll/io/fair_request_queue.hpp>
 #include <foxxll/io/request_queue_impl_worker.hpp>
 
 #include <linux/aio_abi.h>
 
-#include <list>
 #include <mutex>
+#include <vector>
 
 namespace foxxll {
 
@@ -43,13 +45,10 @@ private:
     //! OS context_
     aio_context_t context_;
 
-    //! storing linuxaio_request* would drop ownership
-    using queue_type = std::list<request_ptr>;
-
     // "waiting" request have submitted to this queue, but not yet to the OS,
-    // those are "posted"
-    std::mutex waiting_mtx_, posted_mtx_;
-    queue_type waiting_requests_, posted_requests_;
+    // those are "posted" and referenced by their control block only
+    std::mutex waiting_mtx_;
+    fair_request_queue waiting_requests_;
 
     //! max number of OS requests
     int max_events_;
@@ -68,11 +67,13 @@ private:
     //    and the OS to produce I/O completion events at the same time
     //    (IOCB_CMD_NOOP does not seem to help here either)
 
-    static const priority_op priority_op_ = WRITE;
-
     static void * post_async(void* arg);   // thread start callback
     static void * wait_async(void* arg);   // thread start callback
     void post_requests();
+    void submit_batch(std::vector<request_ptr>& batch, io_event* events);
+
+    //! control blocks of the batch being submitted, reused by the post thread
+    std::vector<iocb*> cbs_;
     void handle_events(io_event* events, long num_events, bool canceled);
     void wait_requests();
     void suspend();
@@ -85,8 +86,10 @@ public:
     //! submitted to disk, 0 means as many as possible
     explicit linuxaio_queue(int desired_queue_length = 0);
 
+    void set_priority_weights(const priority_weights& weights) final;
     void add_request(request_ptr& req) final;
     bool cancel_request(request_ptr& req) final;
+    bool boost_request(request_ptr& req) final;
     void complete_request(request_ptr& req);
     ~linuxaio_queue();
 };
@@ -17,6 +17,7 @@
 
 #include <foxxll/common/error_handling.hpp>
 #include <foxxll/io/disk_queues.hpp>
+#include <foxxll/io/request_trace.hpp>
 #include <foxxll/verbose.hpp>
 
 #include <sys/syscall.h>
@@ -45,47 +46,34 @@ void linuxaio_request::completed(bool posted, bool canceled)
     request_with_state::completed(canceled);
 }
 
-void linuxaio_request::fill_control_block()
+iocb* linuxaio_request::prepare_post(const request_ptr& req, double now)
 {
+    STXXL_VERBOSE_LINUXAIO("linuxaio_request[" << this << "] prepare_post()");
+
     linuxaio_file* af = dynamic_cast<linuxaio_file*>(file_);
 
+    assert(req.get() == this);
+    posted_ref_ = req;
+
     memset(&cb_, 0, sizeof(cb_));
-    // indirection, so the I/O system retains a counting_ptr reference
-    cb_.aio_data = reinterpret_cast<__u64>(new request_ptr(this));
+    cb_.aio_data = reinterpret_cast<__u64>(this);
     cb_.aio_fildes = af->file_des_;
     cb_.aio_lio_opcode = (op_ == READ) ? IOCB_CMD_PREAD : IOCB_CMD_PWRITE;
     cb_.aio_reqprio = 0;
     cb_.aio_buf = static_cast<__u64>((unsigned long)(buffer_));
     cb_.aio_nbytes = bytes_;
     cb_.aio_offset = offset_;
-}
 
-//! Submits an I/O request to the OS
-//! \returns false if submission fails
-bool linuxaio_request::post()
-{
-    STXXL_VERBOSE_LINUXAIO("linuxaio_request[" << this << "] post()");
-
-    fill_control_block();
-    iocb* cb_pointer = &cb_;
-    // io_submit might considerable time, so we have to remember the current
-    // time before the call.
-    double now = timestamp();
-    linuxaio_queue* queue = dynamic_cast<linuxaio_queue*>(
-        disk_queues::get_instance()->get_queue(file_->get_queue_id()));
-    long success = syscall(SYS_io_submit, queue->get_io_context(), 1, &cb_pointer);
-    if (success == 1)
-    {
-        if (op_ == READ)
-            file_->get_file_stats()->read_started(bytes_, now);
-        else
-            file_->get_file_stats()->write_started(bytes_, now);
-    }
-    else if (success == -1 && errno != EAGAIN)
-        STXXL_THROW_ERRNO(io_error, "linuxaio_request::post"
-                          " io_submit()");
+    // account before io_submit(), the completion may be handled by the wait
+    // thread before the call returns.
+    mark_started(now);
+    request_trace::event(this, request_trace::DISPATCH);
+    if (op_ == READ)
+        file_->get_file_stats()->read_started(bytes_, now);
+    else
+        file_->get_file_stats()->write_started(bytes_, now);
 
-    return success == 1;
+    return &cb_;
 }
 
 //! Cancel the request
@@ -18,6 +18,7 @@
 
 #if STXXL_HAVE_LINUXAIO_FILE
 
+#include <foxxll/common/object_pool.hpp>
 #include <foxxll/io/request_with_state.hpp>
 #include <linux/aio_abi.h>
 
@@ -34,10 +35,14 @@ class linuxaio_request : public request_with_state
     template <class base_file_type>
     friend class fileperblock_file;
 
+    friend class linuxaio_queue;
+
     //! control block of async request
     iocb cb_;
 
-    void fill_control_block();
+    //! reference held by the kernel while the request is posted, the control
+    //! block's aio_data points to this object.
+    request_ptr posted_ref_;
 
 public:
     linuxaio_request(
@@ -55,11 +60,24 @@ public:
                 " op=" << op << ")");
     }
 
-    bool post();
+    //! Prepares the control block for submission to the OS, storing the
+    //! reference req to this request for the kernel, and accounts the request
+    //! as started at time now
+    iocb * prepare_post(const request_ptr& req, double now);
     bool cancel() final;
     bool cancel_aio();
     void completed(bool posted, bool canceled);
     void completed(bool canceled) { completed(true, canceled); }
+
+    static void * operator new (size_t bytes)
+    {
+        return object_pool<linuxaio_request>::allocate(bytes);
+    }
+
+    static void operator delete (void* p, size_t bytes)
+    {
+        object_pool<linuxaio_request>::deallocate(p, bytes);
+    }
 };
 
 //! \}
@@ -0,0 +1,68 @@
+/***************************************************************************
+ *  foxxll/io/mapped_block.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef STXXL_IO_MAPPED_BLOCK_HEADER
+#define STXXL_IO_MAPPED_BLOCK_HEADER
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace foxxll {
+
+//! \addtogroup iolayer
+//! \{
+
+//! View of a file region which resides in memory, as returned by
+//! file::try_map_block(). The view pins the memory: it stays valid while the
+//! view (or a copy of it) exists, even if the file grows meanwhile. The region
+//! must not be truncated off the file while it is viewed. An empty view
+//! signals that the file cannot provide the region without copying.
+class mapped_block
+{
+    const void* data_ = nullptr;
+    size_t bytes_ = 0;
+    //! keeps the underlying memory alive
+    std::shared_ptr<const void> pin_;
+
+public:
+    //! construct empty view
+    mapped_block() = default;
+
+    mapped_block(const void* data, size_t bytes, std::shared_ptr<const void> pin)
+        : data_(data), bytes_(bytes), pin_(std::move(pin))
+    { }
+
+    //! pointer to the first byte of the region
+    const void * data() const { return data_; }
+
+    //! length of the region
+    size_t size() const { return bytes_; }
+
+    //! whether the view references memory
+    bool valid() const { return data_ != nullptr; }
+
+    //! release pin on the memory
+    void reset()
+    {
+        data_ = nullptr;
+        bytes_ = 0;
+        pin_.reset();
+    }
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !STXXL_IO_MAPPED_BLOCK_HEADER
+// vim: et:ts=4:sw=4
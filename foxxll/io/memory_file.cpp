@@ -11,42 +11,131 @@
  *  http://www.boost.org/LICENSE_1_0.txt)
  **************************************************************************/
 
+#include <foxxll/common/error_handling.hpp>
+#include <foxxll/config.hpp>
 #include <foxxll/io/iostats.hpp>
 #include <foxxll/io/memory_file.hpp>
 
+#if STXXL_HAVE_MMAP_FILE
+ #include <sys/mman.h>
+ #include <unistd.h>
+ #if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+  #define MAP_ANONYMOUS MAP_ANON
+ #endif
+#endif
+
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
 #include <limits>
 
 namespace foxxll {
 
-void memory_file::serve(void* buffer, offset_type offset, size_type bytes,
-                        request::read_or_write op)
+const memory_file::size_type memory_file::chunk_size;
+const memory_file::size_type memory_file::stripe_size;
+const size_t memory_file::num_stripes;
+
+memory_file::chunk::chunk()
+{
+#if STXXL_HAVE_MMAP_FILE
+    // anonymous memory is committed lazily and can be returned via madvise()
+    void* mem = mmap(nullptr, chunk_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED)
+        STXXL_THROW_ERRNO(io_error, "mmap() of memory_file chunk failed, bytes=" << chunk_size);
+    ptr = static_cast<char*>(mem);
+#else
+    ptr = static_cast<char*>(malloc(chunk_size));
+    if (!ptr)
+        STXXL_THROW(io_error, "malloc() of memory_file chunk failed, bytes=" << chunk_size);
+#endif
+}
+
+memory_file::chunk::~chunk()
+{
+#if STXXL_HAVE_MMAP_FILE
+    if (munmap(ptr, chunk_size) != 0)
+        STXXL_ERRMSG("munmap() of memory_file chunk failed: " << strerror(errno));
+#else
+    free(ptr);
+#endif
+}
+
+uint64_t memory_file::stripe_mask(offset_type offset, size_type bytes)
 {
-    std::unique_lock<std::mutex> lock(mutex_);
+    if (bytes == 0)
+        return 0;
 
-    if (op == request::READ)
+    offset_type first = offset / stripe_size;
+    offset_type last = (offset + bytes - 1) / stripe_size;
+    if (last - first + 1 >= num_stripes)
+        return ~uint64_t(0);
+
+    uint64_t mask = 0;
+    for (offset_type s = first; s <= last; ++s)
+        mask |= uint64_t(1) << (s % num_stripes);
+    return mask;
+}
+
+void memory_file::lock_stripes(uint64_t mask)
+{
+    for (size_t i = 0; i < num_stripes; ++i)
     {
-        file_stats::scoped_read_timer read_timer(file_stats_, bytes);
-        memcpy(buffer, ptr_ + offset, bytes);
+        if (mask & (uint64_t(1) << i))
+            stripe_mutex_[i].lock();
     }
-    else
+}
+
+void memory_file::unlock_stripes(uint64_t mask)
+{
+    for (size_t i = 0; i < num_stripes; ++i)
     {
-        file_stats::scoped_write_timer write_timer(file_stats_, bytes);
-        memcpy(ptr_ + offset, buffer, bytes);
+        if (mask & (uint64_t(1) << i))
+            stripe_mutex_[i].unlock();
     }
 }
 
+void memory_file::serve(void* buffer, offset_type offset, size_type bytes,
+                        request::read_or_write op)
+{
+    std::shared_lock<std::shared_timed_mutex> chunks_lock(chunks_mutex_);
+    assert(offset + bytes <= size_);
+
+    file_stats::scoped_read_write_timer read_write_timer(
+        file_stats_, bytes, op == request::WRITE);
+
+    const uint64_t mask = stripe_mask(offset, bytes);
+    lock_stripes(mask);
+
+    char* cbuffer = static_cast<char*>(buffer);
+    while (bytes > 0)
+    {
+        char* ptr = chunks_[static_cast<size_t>(offset / chunk_size)]->ptr
+                    + offset % chunk_size;
+        size_type n = std::min<size_type>(
+            bytes, static_cast<size_type>(chunk_size - offset % chunk_size));
+
+        if (op == request::READ)
+            memcpy(cbuffer, ptr, n);
+        else
+            memcpy(ptr, cbuffer, n);
+
+        offset += n;
+        cbuffer += n;
+        bytes -= n;
+    }
+
+    unlock_stripes(mask);
+}
+
 const char* memory_file::io_type() const
 {
     return "memory";
 }
 
 memory_file::~memory_file()
-{
-    free(ptr_);
-    ptr_ = nullptr;
-}
+{ }
 
 void memory_file::lock()
 {
@@ -60,35 +149,84 @@ file::offset_type memory_file::size()
 
 void memory_file::set_size(offset_type newsize)
 {
-    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_lock<std::shared_timed_mutex> chunks_lock(chunks_mutex_);
     assert(newsize <= std::numeric_limits<size_t>::max());
 
-    ptr_ = static_cast<char*>(realloc(ptr_, static_cast<size_t>(newsize)));
+    const size_t num_chunks =
+        static_cast<size_t>((newsize + chunk_size - 1) / chunk_size);
+
+    // chunks are never moved, mapped blocks may keep dropped ones alive
+    chunks_.resize(std::min(chunks_.size(), num_chunks));
+    while (chunks_.size() < num_chunks)
+        chunks_.push_back(std::make_shared<chunk>());
+
+    offset_type oldsize = size_;
     size_ = newsize;
+
+    // release memory of a truncated tail in the last chunk
+    if (newsize < oldsize && newsize % chunk_size != 0)
+        discard(newsize, std::min(oldsize, num_chunks * chunk_size) - newsize, false);
 }
 
 void memory_file::discard(offset_type offset, offset_type size)
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-#ifndef STXXL_MEMFILE_DONT_CLEAR_FREED_MEMORY
-    // overwrite the freed region with uninitialized memory
+    std::shared_lock<std::shared_timed_mutex> chunks_lock(chunks_mutex_);
+    discard(offset, std::min(size, size_ - std::min(offset, size_)), true);
+}
+
+void memory_file::discard(offset_type offset, offset_type size, bool lock)
+{
+#if STXXL_HAVE_MMAP_FILE && !defined(STXXL_MEMFILE_DONT_CLEAR_FREED_MEMORY)
     STXXL_VERBOSE("discard at " << offset << " len " << size);
-    void* uninitialized = malloc(STXXL_BLOCK_ALIGN);
-    while (size >= STXXL_BLOCK_ALIGN) {
-        memcpy(ptr_ + offset, uninitialized, STXXL_BLOCK_ALIGN);
-        offset += STXXL_BLOCK_ALIGN;
-        size -= STXXL_BLOCK_ALIGN;
+
+    // only whole pages inside the region can be returned
+    static const offset_type page_size = sysconf(_SC_PAGESIZE);
+    offset_type begin = (offset + page_size - 1) / page_size * page_size;
+    offset_type end = (offset + size) / page_size * page_size;
+    if (begin >= end)
+        return;
+
+    const uint64_t mask = lock ? stripe_mask(begin, end - begin) : 0;
+    lock_stripes(mask);
+
+    while (begin < end)
+    {
+        char* ptr = chunks_[static_cast<size_t>(begin / chunk_size)]->ptr
+                    + begin % chunk_size;
+        offset_type n = std::min<offset_type>(
+            end - begin, chunk_size - begin % chunk_size);
+
+        // private anonymous pages read as zero afterwards
+        madvise(ptr, static_cast<size_t>(n), MADV_DONTNEED);
+
+        begin += n;
     }
-    assert(size <= std::numeric_limits<offset_type>::max());
-    if (size > 0)
-        memcpy(ptr_ + offset, uninitialized, (size_t)size);
-    free(uninitialized);
+
+    unlock_stripes(mask);
 #else
     STXXL_UNUSED(offset);
     STXXL_UNUSED(size);
+    STXXL_UNUSED(lock);
 #endif
 }
 
+mapped_block memory_file::try_map_block(offset_type offset, size_type bytes)
+{
+    std::shared_lock<std::shared_timed_mutex> chunks_lock(chunks_mutex_);
+
+    if (bytes == 0 || offset + bytes > size_)
+        return mapped_block();
+
+    // regions crossing a chunk boundary are not contiguous in memory
+    if (offset % chunk_size + bytes > chunk_size)
+        return mapped_block();
+
+    file_stats::scoped_read_timer read_timer(file_stats_, bytes);
+
+    const std::shared_ptr<chunk>& c = chunks_[static_cast<size_t>(offset / chunk_size)];
+    return mapped_block(c->ptr + offset % chunk_size, bytes, c);
+}
+
 } // namespace foxxll
 
 /******************************************************************************/
@@ -18,24 +18,66 @@
 #include <foxxll/io/disk_queued_file.hpp>
 #include <foxxll/io/request.hpp>
 
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <vector>
 
 namespace foxxll {
 
 //! \addtogroup fileimpl
 //! \{
 
-//! Implementation of file based on new[] and memcpy.
+//! Implementation of file based on anonymous memory and memcpy.
+//!
+//! The "file" consists of fixed-size chunks of anonymous memory, such that
+//! set_size() never moves data. Requests on disjoint ranges are served
+//! concurrently, only requests overlapping the same stripe of the file are
+//! serialized. discard() returns the pages of the freed region to the
+//! operating system.
 class memory_file final : public disk_queued_file
 {
-    //! pointer to memory area of "file"
-    char* ptr_;
+public:
+    //! size of one chunk of memory
+    static const size_type chunk_size = size_type(64) * 1024 * 1024;
+
+private:
+    //! chunk of the "file", shared with mapped_block views handed out
+    struct chunk
+    {
+        char* ptr;
+
+        chunk();
+        chunk(const chunk&) = delete;
+        chunk& operator = (const chunk&) = delete;
+        ~chunk();
+    };
+
+    //! chunks covering [0, size_)
+    std::vector<std::shared_ptr<chunk> > chunks_;
 
     //! size of memory area
     offset_type size_;
 
-    //! sequentialize function calls
-    std::mutex mutex_;
+    //! shared by requests, exclusive while adding or removing chunks
+    std::shared_timed_mutex chunks_mutex_;
+
+    //! size of one lock stripe and number of stripe locks
+    static const size_type stripe_size = 1024 * 1024;
+    static const size_t num_stripes = 64;
+
+    //! stripe locks, a request locks all stripes it covers in ascending order
+    std::array<std::mutex, num_stripes> stripe_mutex_;
+
+    //! bit mask of stripes covered by [offset, offset + bytes)
+    static uint64_t stripe_mask(offset_type offset, size_type bytes);
+    void lock_stripes(uint64_t mask);
+    void unlock_stripes(uint64_t mask);
+
+    //! return whole pages of a region, optionally holding its stripe locks
+    void discard(offset_type offset, offset_type size, bool lock);
 
 public:
     //! constructs file object.
@@ -45,7 +87,7 @@ public:
         unsigned int device_id = DEFAULT_DEVICE_ID)
         : file(device_id),
           disk_queued_file(queue_id, allocator_id),
-          ptr_(nullptr), size_(0)
+          size_(0)
     { }
     void serve(void* buffer, offset_type offset, size_type bytes,
                request::read_or_write op) final;
@@ -54,6 +96,7 @@ public:
     void set_size(offset_type newsize) final;
     void lock() final;
     void discard(offset_type offset, offset_type size) final;
+    mapped_block try_map_block(offset_type offset, size_type bytes) final;
     const char * io_type() const final;
 };
 
@@ -21,50 +21,261 @@
 
 #include <sys/mman.h>
 
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <string>
+
 namespace foxxll {
 
+const mmap_file::size_type mmap_file::default_window_size;
+
+static inline file::offset_type page_size()
+{
+    static const file::offset_type ps = sysconf(_SC_PAGESIZE);
+    return ps;
+}
+
+mmap_file::mmap_file(
+    const std::string& filename, int mode, int queue_id, int allocator_id,
+    unsigned int device_id, file_stats* file_stats, size_type window_size)
+    : file(device_id, file_stats),
+      ufs_file_base(filename, mode),
+      disk_queued_file(queue_id, allocator_id),
+      window_size_((window_size + page_size() - 1) / page_size() * page_size()),
+      stride_(0),
+      mapped_size_(0),
+      last_read_end_(0)
+{
+    remap(_size());
+}
+
+mmap_file::~mmap_file()
+{
+    unmap_all();
+}
+
+mmap_file::window::~window()
+{
+    if (munmap(base, length) != 0)
+        STXXL_ERRMSG("munmap() failed: " << strerror(errno));
+}
+
+void mmap_file::unmap_all()
+{
+    windows_.clear();
+    mapped_size_ = 0;
+}
+
+void mmap_file::remap(offset_type new_size)
+{
+    // a mapping requires read access to the file, even for PROT_WRITE only
+    if (mode_ & WRONLY)
+        return;
+
+    if (window_size_ == 0)
+    {
+        // a single window, which has to be replaced on every size change
+        if (new_size == mapped_size_)
+            return;
+        unmap_all();
+        stride_ = new_size;
+    }
+    else
+    {
+        stride_ = window_size_;
+    }
+
+    const size_t num_windows =
+        stride_ == 0 ? 0 : static_cast<size_t>((new_size + stride_ - 1) / stride_);
+
+    // drop windows past the new end and a last window of different length
+    while (!windows_.empty() &&
+           (windows_.size() > num_windows ||
+            windows_.back()->length !=
+            std::min<offset_type>(stride_, new_size - (windows_.size() - 1) * stride_)))
+    {
+        windows_.pop_back();
+    }
+
+    const int prot = (mode_ & RDONLY) ? PROT_READ : (PROT_READ | PROT_WRITE);
+
+    while (windows_.size() < num_windows)
+    {
+        offset_type offset = windows_.size() * stride_;
+        size_type length = static_cast<size_type>(
+            std::min<offset_type>(stride_, new_size - offset));
+
+        void* mem = mmap(nullptr, length, prot, MAP_SHARED, file_des_, offset);
+        if (mem == MAP_FAILED)
+        {
+            STXXL_THROW_ERRNO(io_error,
+                              " mmap() failed." <<
+                              " path=" << filename_ <<
+                              " offset=" << offset <<
+                              " bytes=" << length <<
+                              " Page size: " << page_size());
+        }
+
+        windows_.push_back(
+            std::make_shared<window>(static_cast<char*>(mem), length));
+    }
+
+    mapped_size_ = new_size;
+}
+
+void mmap_file::advise(offset_type offset, offset_type length, int advice)
+{
+    offset_type end = std::min(offset + length, mapped_size_);
+    // madvise() requires a page aligned start address
+    offset -= offset % page_size();
+
+    while (offset < end)
+    {
+        const window& w = *windows_[static_cast<size_t>(offset / stride_)];
+        offset_type in = offset % stride_;
+        offset_type n = std::min<offset_type>(w.length - in, end - offset);
+
+        // only a hint, failure is harmless
+        madvise(w.base + in, static_cast<size_t>(n), advice);
+
+        offset += n;
+    }
+}
+
+void mmap_file::write_unmapped(
+    const char* buffer, offset_type offset, size_type bytes)
+{
+    while (bytes > 0)
+    {
+        ssize_t rc = ::pwrite(file_des_, buffer, bytes, offset);
+        if (rc <= 0)
+        {
+            STXXL_THROW_ERRNO
+                (io_error,
+                " this=" << this <<
+                " call=::pwrite(fd,buffer,bytes,offset)" <<
+                " path=" << filename_ <<
+                " fd=" << file_des_ <<
+                " offset=" << offset <<
+                " buffer=" << static_cast<const void*>(buffer) <<
+                " bytes=" << bytes <<
+                " op=WRITE" <<
+                " rc=" << rc);
+        }
+        buffer += rc;
+        offset += rc;
+        bytes -= static_cast<size_type>(rc);
+    }
+}
+
 void mmap_file::serve(void* buffer, offset_type offset, size_type bytes,
                       request::read_or_write op)
 {
-    std::unique_lock<std::mutex> fd_lock(fd_mutex_);
-
-    //assert(offset + bytes <= _size());
+    if (op == request::WRITE)
+        cancel_discard(offset, bytes);
 
     file_stats::scoped_read_write_timer read_write_timer(
         file_stats_, bytes, op == request::WRITE);
 
-    int prot = (op == request::READ) ? PROT_READ : PROT_WRITE;
-    void* mem = mmap(nullptr, bytes, prot, MAP_SHARED, file_des_, offset);
-    // void *mem = mmap (buffer, bytes, prot , MAP_SHARED|MAP_FIXED , file_des_, offset);
-    // STXXL_MSG("Mmaped to "<<mem<<" , buffer suggested at "<<buffer);
-    if (mem == MAP_FAILED)
+    if (mode_ & WRONLY)
     {
-        STXXL_THROW_ERRNO(io_error,
-                          " mmap() failed." <<
-                          " path=" << filename_ <<
-                          " bytes=" << bytes <<
-                          " Page size: " << sysconf(_SC_PAGESIZE) <<
-                          " offset modulo page size " << (offset % sysconf(_SC_PAGESIZE)));
+        if (op == request::READ)
+            STXXL_THROW(io_error, "mmap_file::serve() read from write-only"
+                        " file path=" << filename_ << " offset=" << offset);
+        write_unmapped(static_cast<const char*>(buffer), offset, bytes);
+        return;
     }
-    else if (mem == 0)
+
+    std::shared_lock<std::shared_timed_mutex> map_lock(map_mutex_);
+
+    if (op == request::WRITE && offset + bytes > mapped_size_)
     {
-        STXXL_THROW_ERRNO(io_error, "mmap() returned nullptr");
+        // extend file, a mapping must not be written past the end of file
+        map_lock.unlock();
+        {
+            std::unique_lock<std::mutex> fd_lock(fd_mutex_);
+            std::unique_lock<std::shared_timed_mutex> remap_lock(map_mutex_);
+            if (offset + bytes > mapped_size_)
+            {
+                _set_size(offset + bytes);
+                remap(_size());
+            }
+        }
+        map_lock.lock();
     }
-    else
+
+    char* cbuffer = static_cast<char*>(buffer);
+
+    if (op == request::READ)
     {
-        if (op == request::READ)
+        offset_type prev_end = last_read_end_.exchange(offset + bytes);
+
+        // sequential access also reads ahead of this request. Access
+        // pattern advice such as MADV_SEQUENTIAL would stick to the range and
+        // split the mapping, only fetching is advised.
+        advise(offset, bytes, MADV_WILLNEED);
+        if (prev_end == offset)
+            advise(offset + bytes, bytes, MADV_WILLNEED);
+
+        if (offset + bytes > mapped_size_)
         {
-            memcpy(buffer, mem, bytes);
+            // read request extends past end-of-file, fill remainder with zeroes
+            size_type valid = offset < mapped_size_
+                              ? static_cast<size_type>(mapped_size_ - offset) : 0;
+            memset(cbuffer + valid, 0, bytes - valid);
+            bytes = valid;
         }
+    }
+
+    while (bytes > 0)
+    {
+        const window& w = *windows_[static_cast<size_t>(offset / stride_)];
+        offset_type in = offset % stride_;
+        size_type n = std::min<size_type>(
+            bytes, static_cast<size_type>(w.length - in));
+
+        if (op == request::READ)
+            memcpy(cbuffer, w.base + in, n);
         else
-        {
-            memcpy(mem, buffer, bytes);
-        }
-        STXXL_THROW_ERRNO_NE_0(munmap(mem, bytes), io_error,
-                               "munmap() failed");
+            memcpy(w.base + in, cbuffer, n);
+
+        offset += n;
+        cbuffer += n;
+        bytes -= n;
     }
 }
 
+void mmap_file::set_size(offset_type newsize)
+{
+    std::unique_lock<std::mutex> fd_lock(fd_mutex_);
+    std::unique_lock<std::shared_timed_mutex> map_lock(map_mutex_);
+    _set_size(newsize);
+    remap(_size());
+}
+
+mapped_block mmap_file::try_map_block(offset_type offset, size_type bytes)
+{
+    std::shared_lock<std::shared_timed_mutex> map_lock(map_mutex_);
+
+    if (bytes == 0 || offset + bytes > mapped_size_)
+        return mapped_block();
+
+    const std::shared_ptr<window>& w =
+        windows_[static_cast<size_t>(offset / stride_)];
+    offset_type in = offset % stride_;
+
+    // regions crossing a window boundary are not contiguous in memory
+    if (in + bytes > w->length)
+        return mapped_block();
+
+    file_stats::scoped_read_timer read_timer(file_stats_, bytes);
+
+    advise(offset, bytes, MADV_WILLNEED);
+
+    return mapped_block(w->base + in, bytes, w);
+}
+
 const char* mmap_file::io_type() const
 {
     return "mmap";
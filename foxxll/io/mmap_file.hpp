@@ -22,7 +22,11 @@
 #include <foxxll/io/disk_queued_file.hpp>
 #include <foxxll/io/ufs_file_base.hpp>
 
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
 #include <string>
+#include <vector>
 
 namespace foxxll {
 
@@ -30,8 +34,57 @@ namespace foxxll {
 //! \{
 
 //! Implementation of memory mapped access file.
+//!
+//! The file is mapped persistently in fixed-size windows (or as a whole),
+//! requests are served by copying from and to the mapping, or without copying
+//! via try_map_block() if they lie within one window. The windows are
+//! remapped when the file size changes. Reads advise the kernel to fetch the
+//! requested range and continue read-ahead for sequential access patterns.
+//! Mappings require read access, hence
+//! write-only files are not mapped and written by pwrite().
 class mmap_file final : public ufs_file_base, public disk_queued_file
 {
+public:
+    //! default size of one mapping window
+    static const size_type default_window_size = size_type(1) << 30;
+
+private:
+    //! one persistent mapping of [index * stride_, index * stride_ + length),
+    //! unmapped once neither the file nor a mapped_block references it.
+    struct window
+    {
+        char* base;
+        size_type length;
+
+        window(char* b, size_type l) : base(b), length(l) { }
+        window(const window&) = delete;
+        window& operator = (const window&) = delete;
+        ~window();
+    };
+
+    //! requested window size, 0 maps the whole file at once
+    const size_type window_size_;
+    //! offset distance between consecutive windows
+    offset_type stride_;
+    //! current windows, covering [0, mapped_size_)
+    std::vector<std::shared_ptr<window> > windows_;
+    offset_type mapped_size_;
+
+    //! shared by serve() and discard(), exclusive while remapping
+    std::shared_timed_mutex map_mutex_;
+
+    //! end offset of the previous read, to detect sequential access
+    std::atomic<offset_type> last_read_end_;
+
+    //! adjust windows to a new file size, map_mutex_ must be held exclusively
+    void remap(offset_type new_size);
+    //! unmap all windows, map_mutex_ must be held exclusively
+    void unmap_all();
+    //! give advice for the pages of [offset, offset + length) in all windows
+    void advise(offset_type offset, offset_type length, int advice);
+    //! serve a write to a write-only file, which is not mapped
+    void write_unmapped(const char* buffer, offset_type offset, size_type bytes);
+
 public:
     //! Constructs file object.
     //! \param filename path of file
@@ -39,19 +92,23 @@ public:
     //! \param queue_id disk queue identifier
     //! \param allocator_id linked disk_allocator
     //! \param device_id physical device identifier
-    inline mmap_file(
+    //! \param window_size size of one mapping window, rounded up to the page
+    //!        size, 0 maps the whole file
+    mmap_file(
         const std::string& filename,
         int mode,
         int queue_id = DEFAULT_QUEUE,
         int allocator_id = NO_ALLOCATOR,
         unsigned int device_id = DEFAULT_DEVICE_ID,
-        file_stats* file_stats = nullptr)
-        : file(device_id, file_stats),
-          ufs_file_base(filename, mode),
-          disk_queued_file(queue_id, allocator_id)
-    { }
+        file_stats* file_stats = nullptr,
+        size_type window_size = default_window_size);
+
+    ~mmap_file();
+
     void serve(void* buffer, offset_type offset, size_type bytes,
                request::read_or_write op) final;
+    void set_size(offset_type newsize) final;
+    mapped_block try_map_block(offset_type offset, size_type bytes) final;
     const char * io_type() const final;
 };
 
@@ -0,0 +1,112 @@
+/***************************************************************************
+ *  foxxll/io/pending_request_index.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef STXXL_IO_PENDING_REQUEST_INDEX_HEADER
+#define STXXL_IO_PENDING_REQUEST_INDEX_HEADER
+
+#include <foxxll/common/object_pool.hpp>
+#include <foxxll/io/request.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+namespace foxxll {
+
+//! \addtogroup reqlayer
+//! \{
+
+//! Hash index of the requests waiting in a request queue by file and offset,
+//! which finds conflicting requests in O(1) on submission. The queue inserts
+//! requests when they are added and erases them when they are dequeued or
+//! canceled, under the lock protecting the queue. The index does not hold
+//! references, the queue does.
+class pending_request_index
+{
+public:
+    using offset_type = request::offset_type;
+
+    //! Insert a request added to the queue.
+    void insert(request* req)
+    {
+        map_.emplace(position_type(req->get_file(), req->get_offset()),
+                     entry { req, ++seq_ });
+    }
+
+    //! Erase a request dequeued or canceled, returns whether it was indexed.
+    bool erase(request* req)
+    {
+        std::pair<map_type::iterator, map_type::iterator> same =
+            map_.equal_range(position_type(req->get_file(), req->get_offset()));
+        for (map_type::iterator i = same.first; i != same.second; ++i)
+        {
+            if (i->second.req == req) {
+                map_.erase(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //! Returns the request of operation op for offset in file inserted last,
+    //! or nullptr.
+    request * find(file* f, offset_type offset, request::read_or_write op) const
+    {
+        std::pair<map_type::const_iterator, map_type::const_iterator> same =
+            map_.equal_range(position_type(f, offset));
+        const entry* last = nullptr;
+        for (map_type::const_iterator i = same.first; i != same.second; ++i)
+        {
+            if (i->second.req->get_op() == op && (!last || i->second.seq > last->seq))
+                last = &i->second;
+        }
+        return last ? last->req : nullptr;
+    }
+
+    //! Number of indexed requests.
+    size_t size() const { return map_.size(); }
+
+private:
+    using position_type = std::pair<file*, offset_type>;
+
+    struct position_hash
+    {
+        size_t operator () (const position_type& p) const
+        {
+            return static_cast<size_t>(
+                uint64_t(reinterpret_cast<uintptr_t>(p.first)) ^
+                (p.second * 0x9E3779B97F4A7C15ull));
+        }
+    };
+
+    struct entry
+    {
+        request* req;
+        //! insertion order, to find the most recent of several requests
+        uint64_t seq;
+    };
+
+    using map_type = std::unordered_multimap<
+              position_type, entry, position_hash, std::equal_to<position_type>,
+              pool_alloc<std::pair<const position_type, entry> > >;
+
+    map_type map_;
+    uint64_t seq_ = 0;
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !STXXL_IO_PENDING_REQUEST_INDEX_HEADER
+// vim: et:ts=4:sw=4
@@ -11,20 +11,26 @@
  *  http://www.boost.org/LICENSE_1_0.txt)
  **************************************************************************/
 
+#include <foxxll/io/disk_queues.hpp>
 #include <foxxll/io/file.hpp>
 #include <foxxll/io/request.hpp>
 
+#include <atomic>
 #include <ostream>
 
 namespace foxxll {
 
+//! priority class set by the innermost scoped_priority_class, or -1
+static thread_local int s_priority_class = -1;
+
 request::request(
     const completion_handler& on_complete,
     file* file, void* buffer, offset_type offset, size_type bytes,
     read_or_write op)
     : on_complete_(on_complete),
       file_(file), buffer_(buffer), offset_(offset), bytes_(bytes),
-      op_(op)
+      op_(op), priority_(scoped_priority_class::current(op)),
+      queue_id_(file->get_queue_id())
 {
     STXXL_VERBOSE3_THIS("request::(...), ref_cnt=" << reference_count());
     file_->add_request_ref();
@@ -81,10 +87,51 @@ std::ostream& request::print(std::ostream& out) const
     return out;
 }
 
+//! seconds before a wait boosts its request
+static std::atomic<double> s_boost_delay { 0.1 };
+
+double request::boost_delay()
+{
+    return s_boost_delay.load(std::memory_order_relaxed);
+}
+
+void request::set_boost_delay(double seconds)
+{
+    s_boost_delay.store(seconds, std::memory_order_relaxed);
+}
+
+bool request::boost()
+{
+    // file_ is reset concurrently on completion, a completed request is not
+    // found in its queue
+    request_ptr rp(this);
+    return disk_queues::get_instance()->boost_request(rp, queue_id_);
+}
+
 std::ostream& operator << (std::ostream& out, const request& req)
 {
     return req.print(out);
 }
 
+constexpr size_t request_interface::num_priority_classes;
+
+scoped_priority_class::scoped_priority_class(request::priority_class priority)
+    : previous_(s_priority_class)
+{
+    s_priority_class = priority;
+}
+
+scoped_priority_class::~scoped_priority_class()
+{
+    s_priority_class = previous_;
+}
+
+request::priority_class scoped_priority_class::current(request::read_or_write op)
+{
+    if (s_priority_class >= 0)
+        return static_cast<request::priority_class>(s_priority_class);
+    return (op == request::READ) ? request::DEMAND : request::WRITEBACK;
+}
+
 } // namespace foxxll
 // vim: et:ts=4:sw=4
@@ -59,6 +59,14 @@ protected:
     offset_type offset_;
     size_type bytes_;
     read_or_write op_;
+    priority_class priority_;
+    //! queue of file_, kept for boost() since file_ is reset on completion
+    const int queue_id_;
+
+    //! timestamps of submission to disk_queues and of the start of serving,
+    //! zero if unknown; used for the latency histograms in file_stats
+    double time_submitted_ = 0.0;
+    double time_started_ = 0.0;
 
 public:
     request(const completion_handler& on_complete,
@@ -73,8 +81,31 @@ public:
     size_type get_size() const { return bytes_; }
     read_or_write get_op() const { return op_; }
 
+    //! Priority class, set from the creating thread's scoped_priority_class
+    //! or else DEMAND for reads and WRITEBACK for writes.
+    priority_class get_priority_class() const { return priority_; }
+
     void check_alignment() const;
 
+    //! Move the request to the head of its disk queue if it is still waiting
+    //! there, called when a thread has been blocked on it for boost_delay().
+    //! \return \c true if the request was waiting
+    bool boost();
+
+    //! Seconds a thread blocked on a request waits before boosting it, such
+    //! that short waits keep the order of the disk queues. Default 0.1 s.
+    static double boost_delay();
+
+    //! Set the seconds a blocked thread waits before boosting, 0 boosts at
+    //! once.
+    static void set_boost_delay(double seconds);
+
+    //! Record the time the request was submitted to disk_queues.
+    void mark_submitted(double now) { time_submitted_ = now; }
+
+    //! Record the time the request started being served.
+    void mark_started(double now) { time_started_ = now; }
+
     std::ostream & print(std::ostream& out) const final;
 
     //! Inform the request object that an error occurred during the I/O
@@ -113,6 +144,30 @@ private:
 
 std::ostream& operator << (std::ostream& out, const request& req);
 
+//! Sets the priority class of the requests the calling thread creates while
+//! the object lives, e.g. request::PREFETCH for reads issued ahead of demand.
+//! Scopes nest.
+class scoped_priority_class
+{
+public:
+    explicit scoped_priority_class(request::priority_class priority);
+
+    //! non-copyable: delete copy-constructor
+    scoped_priority_class(const scoped_priority_class&) = delete;
+    //! non-copyable: delete assignment operator
+    scoped_priority_class& operator = (const scoped_priority_class&) = delete;
+
+    ~scoped_priority_class();
+
+    //! Priority class of a request of operation op created now by the calling
+    //! thread.
+    static request::priority_class current(request::read_or_write op);
+
+private:
+    //! class of the enclosing scope, or -1 if none
+    int previous_;
+};
+
 //! \}
 
 } // namespace foxxll
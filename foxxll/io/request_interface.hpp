@@ -25,6 +25,7 @@ namespace foxxll {
 //! \{
 
 class onoff_switch;
+class completion_queue;
 
 //! Functional interface of a request.
 //!
@@ -41,10 +42,28 @@ public:
 
     enum read_or_write { READ, WRITE };
 
+    //! Priority classes of requests, which share a disk queue by weight, see
+    //! fair_share: reads a computation waits for, prefetching reads, and
+    //! writes back of evicted or finished blocks.
+    enum priority_class { DEMAND, PREFETCH, WRITEBACK };
+
+    //! number of priority classes
+    static constexpr size_t num_priority_classes = 3;
+
 public:
     virtual bool add_waiter(onoff_switch* sw) = 0;
     virtual void delete_waiter(onoff_switch* sw) = 0;
 
+    //! Register a completion_queue which the request is pushed onto when it
+    //! completes. A request is registered with at most one queue.
+    //! \return \c true if the request is already completed, then nothing is
+    //! registered
+    virtual bool set_completion_queue(completion_queue* cq, void* tag) = 0;
+
+    //! Unregister the completion_queue.
+    //! \return \c true if the request had not been pushed onto it yet
+    virtual bool reset_completion_queue(completion_queue* cq) = 0;
+
 protected:
     virtual void notify_waiters() = 0;
 
@@ -130,7 +130,18 @@ RequestIterator wait_any(RequestIterator reqs_begin, RequestIterator reqs_end)
         }
     }
 
-    sw.wait_for_on();
+    // none is done yet, serve the waiting ones first if this takes a while
+    if (!sw.wait_for_on(request::boost_delay()))
+    {
+        size_t boosted = 0;
+        for (cur = reqs_begin; cur != reqs_end; cur++)
+            boosted += (request_ptr(*cur))->boost();
+
+        const double start = boosted ? timestamp() : 0.0;
+        sw.wait_for_on();
+        if (boosted)
+            stats::get_instance()->boosted_wait_finished(timestamp() - start);
+    }
 
     for (cur = reqs_begin; cur != reqs_end; cur++)
     {
@@ -14,6 +14,9 @@
 #ifndef STXXL_IO_REQUEST_QUEUE_HEADER
 #define STXXL_IO_REQUEST_QUEUE_HEADER
 
+#include <foxxll/io/fair_request_queue.hpp>
+#include <foxxll/io/io_throttle.hpp>
+#include <foxxll/io/iostats.hpp>
 #include <foxxll/io/request.hpp>
 
 namespace foxxll {
@@ -38,7 +41,117 @@ public:
     virtual void add_request(request_ptr& req) = 0;
     virtual bool cancel_request(request_ptr& req) = 0;
     virtual ~request_queue() { }
-    virtual void set_priority_op(const priority_op& p) { STXXL_UNUSED(p); }
+
+    //! Serve a waiting request before all others, since a thread is blocked
+    //! on it.
+    //! \return \c true if the request was waiting in the queue
+    virtual bool boost_request(request_ptr& req) = 0;
+
+    //! Set the weights by which the priority classes of waiting requests
+    //! share the queue.
+    virtual void set_priority_weights(const priority_weights& weights) = 0;
+
+    //! Set weights preferring an operation: READ weights demand and
+    //! prefetching reads eight times higher than write-back, WRITE the
+    //! other way round, and NONE weights all classes equally.
+    void set_priority_op(const priority_op& op)
+    {
+        set_priority_weights(priority_op_weights(op));
+    }
+
+    //! The weights set by set_priority_op().
+    static priority_weights priority_op_weights(const priority_op& op)
+    {
+        switch (op)
+        {
+        case READ:
+            return priority_weights { { 8, 8, 1 } };
+        case WRITE:
+            return priority_weights { { 1, 1, 8 } };
+        default:
+            return priority_weights { { 1, 1, 1 } };
+        }
+    }
+
+    //! Limit the bandwidth and I/O operations per second of the requests
+    //! dispatched, zero limits are unlimited. Takes effect immediately.
+    virtual void set_throttle_limits(const throttle_limits& limits)
+    {
+        throttle_.set_limits(limits);
+    }
+
+    throttle_limits get_throttle_limits() const
+    {
+        return throttle_.get_limits();
+    }
+
+    //! Attach gauges, which the queue updates from then on. Called by
+    //! disk_queues before the first request is added.
+    void set_queue_stats(queue_stats* qs)
+    {
+        queue_stats_ = qs;
+    }
+
+    //! Current and high-water numbers of waiting and in-service requests and
+    //! their time-weighted averages, empty if no gauges are attached.
+    queue_stats_data get_queue_stats() const
+    {
+        return queue_stats_ ? queue_stats_data(*queue_stats_) : queue_stats_data();
+    }
+
+protected:
+    //! gauges of this queue, may be nullptr
+    queue_stats* queue_stats_ = nullptr;
+
+    io_throttle throttle_;
+
+    //! Block until the throttle admits an I/O of op and bytes, called before
+    //! dispatching it.
+    //! \return seconds blocked
+    double throttle(request::read_or_write op, uint64_t bytes)
+    {
+        const double delay = throttle_.acquire(op, bytes);
+        note_throttled(delay);
+        return delay;
+    }
+
+    //! Take the throttle's tokens for an I/O of op and bytes if it admits it
+    //! now, for queues which must not block while dispatching.
+    //! \return zero if admitted, otherwise seconds until it may be admitted
+    double try_throttle(request::read_or_write op, uint64_t bytes)
+    {
+        return throttle_.try_acquire(op, bytes);
+    }
+
+    //! an I/O was delayed by the throttle for seconds
+    void note_throttled(double seconds)
+    {
+        if (seconds > 0.0 && queue_stats_) queue_stats_->throttled(seconds);
+    }
+
+    //! a request was added to the queue
+    void note_added()
+    {
+        if (queue_stats_) queue_stats_->added();
+    }
+
+    //! a request was taken from the queue to be served
+    void note_dequeued()
+    {
+        if (queue_stats_) queue_stats_->dequeued();
+    }
+
+    //! a waiting request was canceled
+    void note_canceled()
+    {
+        if (queue_stats_) queue_stats_->canceled();
+    }
+
+    //! a request finished being served
+    void note_completed()
+    {
+        if (queue_stats_) queue_stats_->completed();
+    }
 };
 
 //! \}
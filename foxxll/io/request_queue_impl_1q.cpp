@@ -16,10 +16,9 @@
 #include <foxxll/common/error_handling.hpp>
 #include <foxxll/config.hpp>
 #include <foxxll/io/request_queue_impl_1q.hpp>
+#include <foxxll/io/request_trace.hpp>
 #include <foxxll/io/serving_request.hpp>
 
-#include <algorithm>
-
 #if STXXL_MSVC >= 1700
  #include <windows.hpp>
 #endif
@@ -30,19 +29,6 @@
 
 namespace foxxll {
 
-struct file_offset_match
-    : public std::binary_function<request_ptr, request_ptr, bool>
-{
-    bool operator () (
-        const request_ptr& a,
-        const request_ptr& b) const
-    {
-        // matching file and offset are enough to cause problems
-        return (a->get_offset() == b->get_offset()) &&
-               (a->get_file() == b->get_file());
-    }
-};
-
 request_queue_impl_1q::request_queue_impl_1q(int n)
     : thread_state_(NOT_RUNNING), sem_(0)
 {
@@ -50,6 +36,12 @@ request_queue_impl_1q::request_queue_impl_1q(int n)
     start_thread(worker, static_cast<void*>(this), thread_, thread_state_);
 }
 
+void request_queue_impl_1q::set_priority_weights(const priority_weights& weights)
+{
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    queue_.set_weights(weights);
+}
+
 void request_queue_impl_1q::add_request(request_ptr& req)
 {
     if (req.empty())
@@ -59,19 +51,37 @@ void request_queue_impl_1q::add_request(request_ptr& req)
     if (!dynamic_cast<serving_request*>(req.get()))
         STXXL_ERRMSG("Incompatible request submitted to running queue.");
 
-#if STXXL_CHECK_FOR_PENDING_REQUESTS_ON_SUBMISSION
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+
+    if (req->get_op() == request::READ)
     {
-        std::unique_lock<std::mutex> lock(queue_mutex_);
-        if (std::find_if(queue_.begin(), queue_.end(),
-                         bind2nd(file_offset_match(), req))
-            != queue_.end())
+        if (request* write = index_.find(
+                req->get_file(), req->get_offset(), request::WRITE))
         {
-            STXXL_ERRMSG("request submitted for a BID with a pending request");
+            serving_request* sreq = dynamic_cast<serving_request*>(req.get());
+            if (sreq && write->get_size() >= req->get_size())
+            {
+                // read-after-write: copy the data while the write waits
+                sreq->forward(write);
+                lock.unlock();
+                sreq->completed(false);
+                return;
+            }
         }
     }
+
+#if STXXL_CHECK_FOR_PENDING_REQUESTS_ON_SUBMISSION
+    if (index_.find(req->get_file(), req->get_offset(), request::READ) ||
+        index_.find(req->get_file(), req->get_offset(), request::WRITE))
+    {
+        STXXL_ERRMSG("request submitted for a BID with a pending request");
+    }
 #endif
-    std::unique_lock<std::mutex> lock(queue_mutex_);
+    // before it can be dequeued
+    note_added();
+
     queue_.push_back(req);
+    index_.insert(req.get());
 
     sem_.signal();
 }
@@ -85,22 +95,26 @@ bool request_queue_impl_1q::cancel_request(request_ptr& req)
     if (!dynamic_cast<serving_request*>(req.get()))
         STXXL_ERRMSG("Incompatible request submitted to running queue.");
 
-    bool was_still_in_queue = false;
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        queue_type::iterator pos
-            = std::find(queue_.begin(), queue_.end(), req);
-
-        if (pos != queue_.end())
-        {
-            queue_.erase(pos);
-            was_still_in_queue = true;
-            lock.unlock();
-            sem_.wait();
-        }
+        if (!queue_.erase(req))
+            return false;
+        index_.erase(req.get());
     }
 
-    return was_still_in_queue;
+    sem_.wait();
+    note_canceled();
+
+    return true;
+}
+
+bool request_queue_impl_1q::boost_request(request_ptr& req)
+{
+    if (req.empty())
+        STXXL_THROW_INVALID_ARGUMENT("Empty request boosted in disk_queue.");
+
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    return queue_.boost(req);
 }
 
 request_queue_impl_1q::~request_queue_impl_1q()
@@ -120,13 +134,17 @@ void* request_queue_impl_1q::worker(void* arg)
             std::unique_lock<std::mutex> lock(pthis->queue_mutex_);
             if (!pthis->queue_.empty())
             {
-                request_ptr req = pthis->queue_.front();
-                pthis->queue_.pop_front();
+                request_ptr req = pthis->queue_.pop();
+                pthis->index_.erase(req.get());
 
                 lock.unlock();
 
+                request_trace::event(req.get(), request_trace::DEQUEUE);
+                pthis->note_dequeued();
+                pthis->throttle(req->get_op(), req->get_size());
+
                 //assert(req->nref() > 1);
-                dynamic_cast<serving_request*>(req.get())->serve();
+                dynamic_cast<serving_request*>(req.get())->serve(pthis->queue_stats_);
             }
             else
             {
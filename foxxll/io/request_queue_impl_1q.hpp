@@ -15,9 +15,10 @@
 #ifndef STXXL_IO_REQUEST_QUEUE_IMPL_1Q_HEADER
 #define STXXL_IO_REQUEST_QUEUE_IMPL_1Q_HEADER
 
+#include <foxxll/io/fair_request_queue.hpp>
+#include <foxxll/io/pending_request_index.hpp>
 #include <foxxll/io/request_queue_impl_worker.hpp>
 
-#include <list>
 #include <mutex>
 
 namespace foxxll {
@@ -26,40 +27,35 @@ namespace foxxll {
 //! \{
 
 //! Implementation of a local request queue having only one queue for both read
-//! and write requests, thus having only one thread.
+//! and write requests, thus having only one thread. The priority classes share
+//! the queue by weight, see fair_share.
+//!
+//! A read request for the offset of a waiting write request is served from
+//! the write's buffer when added, without I/O.
 class request_queue_impl_1q : public request_queue_impl_worker
 {
 private:
     using self = request_queue_impl_1q;
-    using queue_type = std::list<request_ptr>;
 
     std::mutex queue_mutex_;
-    queue_type queue_;
+    fair_request_queue queue_;
+    //! requests in queue_, protected by queue_mutex_
+    pending_request_index index_;
 
     shared_state<thread_state> thread_state_;
     std::thread thread_;
     semaphore sem_;
 
-    static const priority_op priority_op_ = WRITE;
-
     static void * worker(void* arg);
 
 public:
     // \param n max number of requests simultaneously submitted to disk
     explicit request_queue_impl_1q(int n = 1);
 
-    // in a multi-threaded setup this does not work as intended
-    // also there were race conditions possible
-    // and actually an old value was never restored once a new one was set ...
-    // so just disable it and all it's nice implications
-    void set_priority_op(const priority_op& op) final
-    {
-        //_priority_op = op;
-        STXXL_UNUSED(op);
-    }
-
+    void set_priority_weights(const priority_weights& weights) final;
     void add_request(request_ptr& req) final;
     bool cancel_request(request_ptr& req) final;
+    bool boost_request(request_ptr& req) final;
     ~request_queue_impl_1q();
 };
 
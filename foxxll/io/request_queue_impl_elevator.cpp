@@ -0,0 +1,355 @@
+/***************************************************************************
+ *  foxxll/io/request_queue_impl_elevator.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/common/error_handling.hpp>
+#include <foxxll/common/timer.hpp>
+#include <foxxll/io/request_queue_impl_elevator.hpp>
+#include <foxxll/io/request_trace.hpp>
+#include <foxxll/io/serving_request.hpp>
+
+#if STXXL_MSVC >= 1700
+ #include <windows.hpp>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#ifndef STXXL_CHECK_FOR_PENDING_REQUESTS_ON_SUBMISSION
+#define STXXL_CHECK_FOR_PENDING_REQUESTS_ON_SUBMISSION 1
+#endif
+
+namespace foxxll {
+
+constexpr double request_queue_impl_elevator::default_max_wait;
+
+request_queue_impl_elevator::request_queue_impl_elevator(double max_wait)
+    : head_(nullptr, 0),
+      max_wait_(max_wait > 0 ? max_wait : default_max_wait),
+      thread_state_(NOT_RUNNING)
+{
+    batch_.reserve(serving_request::max_merge);
+
+    thread_ = std::thread(worker, static_cast<void*>(this));
+    thread_state_.set_to(RUNNING);
+}
+
+void request_queue_impl_elevator::set_priority_weights(const priority_weights& weights)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    share_.set_weights(weights);
+}
+
+void request_queue_impl_elevator::add_request(request_ptr& req)
+{
+    if (req.empty())
+        STXXL_THROW_INVALID_ARGUMENT("Empty request submitted to disk_queue.");
+    if (thread_state_() != RUNNING)
+        STXXL_THROW_INVALID_ARGUMENT("Request submitted to not running queue.");
+    if (!dynamic_cast<serving_request*>(req.get()))
+        STXXL_ERRMSG("Incompatible request submitted to running queue.");
+
+    // before it can be dequeued
+    note_added();
+
+    const position_type pos(req->get_file(), req->get_offset());
+    const double now = timestamp();
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+#if STXXL_CHECK_FOR_PENDING_REQUESTS_ON_SUBMISSION
+        bool pending = false;
+        for (class_queue& cq : classes_)
+        {
+            std::pair<sweep_map::iterator, sweep_map::iterator> same =
+                cq.sweep.equal_range(pos);
+            for (sweep_map::iterator i = same.first; i != same.second; ++i)
+                pending |= (i->second->req->get_op() != req->get_op());
+        }
+        if (pending)
+        {
+            if (req->get_op() == request::READ)
+                STXXL_ERRMSG("READ request submitted for a BID with a pending WRITE request");
+            else
+                STXXL_ERRMSG("WRITE request submitted for a BID with a pending READ request");
+        }
+#endif
+
+        class_queue& cq = classes_[req->get_priority_class()];
+        cq.arrivals.push_back(arrival { req, now, next_seq_++, 0 });
+        cq.sweep.insert(sweep_map::value_type(pos, std::prev(cq.arrivals.end())));
+        ++size_;
+    }
+
+    cv_.notify_one();
+}
+
+bool request_queue_impl_elevator::cancel_request(request_ptr& req)
+{
+    if (req.empty())
+        STXXL_THROW_INVALID_ARGUMENT("Empty request canceled disk_queue.");
+    if (thread_state_() != RUNNING)
+        STXXL_THROW_INVALID_ARGUMENT("Request canceled to not running queue.");
+    if (!dynamic_cast<serving_request*>(req.get()))
+        STXXL_ERRMSG("Incompatible request submitted to running queue.");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    class_queue& cq = classes_[req->get_priority_class()];
+    std::pair<sweep_map::iterator, sweep_map::iterator> same =
+        cq.sweep.equal_range(position_type(req->get_file(), req->get_offset()));
+    for (sweep_map::iterator i = same.first; i != same.second; ++i)
+    {
+        if (i->second->req != req)
+            continue;
+
+        cq.arrivals.erase(i->second);
+        cq.sweep.erase(i);
+        --size_;
+        note_canceled();
+        return true;
+    }
+
+    return false;
+}
+
+bool request_queue_impl_elevator::boost_request(request_ptr& req)
+{
+    if (req.empty())
+        STXXL_THROW_INVALID_ARGUMENT("Empty request boosted in disk_queue.");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    const position_type position(req->get_file(), req->get_offset());
+
+    arrival_list::iterator target;
+    {
+        class_queue& cq = classes_[req->get_priority_class()];
+        std::pair<sweep_map::iterator, sweep_map::iterator> same =
+            cq.sweep.equal_range(position);
+        sweep_map::iterator i = same.first;
+        while (i != same.second && i->second->req != req)
+            ++i;
+        if (i == same.second || i->second->boosted)
+            return false;
+        target = i->second;
+    }
+
+    // the requests of all classes for the same position submitted before,
+    // then the request itself
+    using located = std::pair<size_t, arrival_list::iterator>;
+    std::vector<located> boost;
+    for (size_t c = 0; c < request::num_priority_classes; ++c)
+    {
+        std::pair<sweep_map::iterator, sweep_map::iterator> same =
+            classes_[c].sweep.equal_range(position);
+        for (sweep_map::iterator i = same.first; i != same.second; ++i)
+        {
+            if (!i->second->boosted && i->second->seq <= target->seq)
+                boost.emplace_back(c, i->second);
+        }
+    }
+    std::sort(boost.begin(), boost.end(),
+              [](const located& a, const located& b) {
+                  return a.second->seq < b.second->seq;
+              });
+
+    for (const located& b : boost)
+    {
+        // behind the requests of the class boosted before
+        arrival_list& arrivals = classes_[b.first].arrivals;
+        arrival_list::iterator pos = arrivals.begin();
+        while (pos != arrivals.end() && pos->boosted)
+            ++pos;
+        b.second->boosted = next_boost_++;
+        if (pos != b.second)
+            arrivals.splice(pos, arrivals, b.second);
+    }
+
+    return true;
+}
+
+request_queue_impl_elevator::~request_queue_impl_elevator()
+{
+    assert(thread_state_() == RUNNING);
+    {
+        // set under the lock, such that the worker does not miss the wakeup
+        std::unique_lock<std::mutex> lock(mutex_);
+        thread_state_.set_to(TERMINATING);
+    }
+    cv_.notify_all();
+
+#if STXXL_MSVC >= 1700
+    // see request_queue_impl_worker::stop_thread()
+    WaitForSingleObject(thread_.native_handle(), INFINITE);
+    CloseHandle(thread_.native_handle());
+#else
+    thread_.join();
+#endif
+
+    thread_state_.set_to(NOT_RUNNING);
+}
+
+size_t request_queue_impl_elevator::num_expired()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return expired_;
+}
+
+request_queue_impl_elevator::sweep_map::iterator
+request_queue_impl_elevator::find(size_t c, arrival_list::iterator a)
+{
+    std::pair<sweep_map::iterator, sweep_map::iterator> same =
+        classes_[c].sweep.equal_range(position_type(a->req->get_file(),
+                                                    a->req->get_offset()));
+    for (sweep_map::iterator i = same.first; i != same.second; ++i)
+    {
+        if (i->second == a)
+            return i;
+    }
+    assert(!"request missing in sweep");
+    return classes_[c].sweep.end();
+}
+
+size_t request_queue_impl_elevator::next_request(sweep_map::iterator& pos)
+{
+    assert(size_ > 0);
+
+    // boosted requests first in the order of boosting, then the oldest
+    // request of any class that waited too long, and the sweep continues
+    // from there
+    size_t c = request::num_priority_classes;
+    for (size_t k = 0; k < request::num_priority_classes; ++k)
+    {
+        const arrival_list& arrivals = classes_[k].arrivals;
+        if (arrivals.empty() || !arrivals.front().boosted)
+            continue;
+        if (c == request::num_priority_classes ||
+            arrivals.front().boosted < classes_[c].arrivals.front().boosted)
+            c = k;
+    }
+
+    if (c != request::num_priority_classes)
+    {
+        pos = find(c, classes_[c].arrivals.begin());
+        return c;
+    }
+
+    const double now = timestamp();
+    for (size_t k = 0; k < request::num_priority_classes; ++k)
+    {
+        const arrival_list& arrivals = classes_[k].arrivals;
+        if (arrivals.empty() || now - arrivals.front().time <= max_wait_)
+            continue;
+        if (c == request::num_priority_classes ||
+            arrivals.front().time < classes_[c].arrivals.front().time)
+            c = k;
+    }
+
+    if (c != request::num_priority_classes)
+    {
+        ++expired_;
+        pos = find(c, classes_[c].arrivals.begin());
+        return c;
+    }
+
+    c = share_.pick([this](size_t k) { return !classes_[k].sweep.empty(); });
+
+    sweep_map& sweep = classes_[c].sweep;
+    pos = sweep.lower_bound(head_);
+    if (pos == sweep.end())
+        pos = sweep.begin();
+    return c;
+}
+
+void request_queue_impl_elevator::take_batch(size_t c, sweep_map::iterator pos)
+{
+    class_queue& cq = classes_[c];
+    const request::read_or_write op = pos->second->req->get_op();
+    size_t bytes = 0;
+
+    do
+    {
+        request_ptr& req = pos->second->req;
+        head_ = position_type(req->get_file(), req->get_offset() + req->get_size());
+        bytes += req->get_size();
+        batch_.push_back(std::move(req));
+
+        cq.arrivals.erase(pos->second);
+        cq.sweep.erase(pos);
+        --size_;
+
+        // skips later requests for the position just taken
+        pos = cq.sweep.lower_bound(head_);
+    }
+    while (batch_.size() < serving_request::max_merge &&
+           pos != cq.sweep.end() && pos->first == head_ &&
+           pos->second->req->get_op() == op);
+
+    share_.charge(c, bytes);
+}
+
+void* request_queue_impl_elevator::worker(void* arg)
+{
+    self* pthis = static_cast<self*>(arg);
+
+    std::unique_lock<std::mutex> lock(pthis->mutex_);
+    for ( ; ; )
+    {
+        if (pthis->size_ == 0)
+        {
+            // terminate if it has been requested and the queue is empty
+            if (pthis->thread_state_() == TERMINATING)
+                break;
+
+            pthis->cv_.wait(lock);
+            continue;
+        }
+
+        sweep_map::iterator pos;
+        const size_t c = pthis->next_request(pos);
+        pthis->take_batch(c, pos);
+
+        lock.unlock();
+
+        uint64_t bytes = 0;
+        for (const request_ptr& req : pthis->batch_)
+        {
+            request_trace::event(req.get(), request_trace::DEQUEUE);
+            pthis->note_dequeued();
+            bytes += req->get_size();
+        }
+
+        // a merged batch is one I/O operation
+        pthis->throttle(pthis->batch_.front()->get_op(), bytes);
+
+        serving_request::serve_merged(
+            pthis->batch_.data(), pthis->batch_.size(), pthis->queue_stats_);
+        pthis->batch_.clear();
+
+        lock.lock();
+    }
+
+    lock.unlock();
+
+#if STXXL_MSVC >= 1700
+    // Workaround for deadlock bug in Visual C++ Runtime 2012 and 2013, see
+    // request_queue_impl_worker.cpp. -tb
+    ExitThread(nullptr);
+#else
+    return nullptr;
+#endif
+}
+
+} // namespace foxxll
+// vim: et:ts=4:sw=4
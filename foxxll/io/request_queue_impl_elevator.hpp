@@ -0,0 +1,146 @@
+/***************************************************************************
+ *  foxxll/io/request_queue_impl_elevator.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef STXXL_IO_REQUEST_QUEUE_IMPL_ELEVATOR_HEADER
+#define STXXL_IO_REQUEST_QUEUE_IMPL_ELEVATOR_HEADER
+
+#include <foxxll/common/object_pool.hpp>
+#include <foxxll/io/fair_request_queue.hpp>
+#include <foxxll/io/request_queue_impl_worker.hpp>
+
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace foxxll {
+
+//! \addtogroup reqlayer
+//! \{
+
+//! Implementation of a local request queue for rotating disks: pending read
+//! and write requests are kept sorted by file and offset and served by one
+//! thread in C-SCAN order, i.e. in ascending order from the position of the
+//! last request, wrapping around to the lowest position at the end. Requests
+//! of the same operation on adjacent regions of the same file are merged into
+//! one vectored I/O of up to serving_request::max_merge requests.
+//!
+//! A request pending for longer than max_wait seconds is served next and the
+//! sweep continues from its position, which bounds starvation by requests
+//! arriving just ahead of the sweep. A boosted request, which a thread is
+//! blocked on, is served next likewise, preceded by the requests of any class
+//! for the same file and offset submitted before it. Requests for the same
+//! file and offset are served in submission order within one priority class.
+//!
+//! Each priority class has its own sweep, the classes share the disk by
+//! weighted fair sharing and the sweep of the class served continues from the
+//! position of the last request of any class. Merging is limited to requests
+//! of the same class.
+class request_queue_impl_elevator final : public request_queue_impl_worker
+{
+private:
+    using self = request_queue_impl_elevator;
+
+    //! position of a request on the disk
+    using position_type = std::pair<file*, request::offset_type>;
+
+    struct arrival
+    {
+        request_ptr req;
+        double time;
+        //! submission number
+        uint64_t seq;
+        //! order of boosting, 0 if not boosted
+        uint64_t boosted;
+    };
+
+    //! pending requests in submission order, boosted ones first
+    using arrival_list = std::list<arrival, pool_alloc<arrival> >;
+
+    //! pending requests by position, in submission order for equal positions
+    using sweep_map = std::multimap<
+              position_type, arrival_list::iterator, std::less<position_type>,
+              pool_alloc<std::pair<const position_type, arrival_list::iterator> > >;
+
+    //! pending requests of one priority class
+    struct class_queue
+    {
+        arrival_list arrivals;
+        sweep_map sweep;
+    };
+
+    std::mutex mutex_;
+    //! signaled when requests are added or the queue terminates
+    std::condition_variable cv_;
+
+    class_queue classes_[request::num_priority_classes];
+    //! number of pending requests of all classes
+    size_t size_ = 0;
+    //! numbers of the next request submitted and boosted
+    uint64_t next_seq_ = 0, next_boost_ = 1;
+    fair_share share_;
+
+    //! position following the last request served
+    position_type head_;
+
+    //! seconds a request may be passed over
+    double max_wait_;
+
+    //! number of requests served before their turn in the sweep
+    size_t expired_ = 0;
+
+    //! requests being served, only used by the worker
+    std::vector<request_ptr> batch_;
+
+    shared_state<thread_state> thread_state_;
+    std::thread thread_;
+
+    static void * worker(void* arg);
+
+    //! find the request of class c in its sweep, which must contain it
+    sweep_map::iterator find(size_t c, arrival_list::iterator a);
+
+    //! find the pending request to serve next
+    //! \return its priority class, the request is at pos in its sweep
+    size_t next_request(sweep_map::iterator& pos);
+
+    //! move the request at pos of class c and adjacent ones to batch_
+    void take_batch(size_t c, sweep_map::iterator pos);
+
+public:
+    //! default bound on the seconds a request may be passed over
+    static constexpr double default_max_wait = 0.5;
+
+    //! \param max_wait seconds a request may be passed over, 0 selects
+    //! default_max_wait
+    explicit request_queue_impl_elevator(double max_wait = 0);
+
+    void set_priority_weights(const priority_weights& weights) final;
+    void add_request(request_ptr& req) final;
+    bool cancel_request(request_ptr& req) final;
+    bool boost_request(request_ptr& req) final;
+    ~request_queue_impl_elevator();
+
+    //! Number of requests served out of C-SCAN order since they waited
+    //! longer than max_wait.
+    size_t num_expired();
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !STXXL_IO_REQUEST_QUEUE_IMPL_ELEVATOR_HEADER
+// vim: et:ts=4:sw=4
@@ -0,0 +1,213 @@
+/***************************************************************************
+ *  foxxll/io/request_queue_impl_parallel.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/common/error_handling.hpp>
+#include <foxxll/io/request_queue_impl_parallel.hpp>
+#include <foxxll/io/request_trace.hpp>
+#include <foxxll/io/serving_request.hpp>
+
+#if STXXL_MSVC >= 1700
+ #include <windows.hpp>
+#endif
+
+#include <algorithm>
+#include <cassert>
+
+#ifndef STXXL_CHECK_FOR_PENDING_REQUESTS_ON_SUBMISSION
+#define STXXL_CHECK_FOR_PENDING_REQUESTS_ON_SUBMISSION 1
+#endif
+
+namespace foxxll {
+
+static inline bool same_file_offset(const request_ptr& a, const request_ptr& b)
+{
+    // matching file and offset are enough to cause problems
+    return (a->get_offset() == b->get_offset()) &&
+           (a->get_file() == b->get_file());
+}
+
+request_queue_impl_parallel::request_queue_impl_parallel(int num_threads)
+    : thread_state_(NOT_RUNNING)
+{
+    if (num_threads < 1)
+        num_threads = 1;
+
+    threads_.reserve(num_threads);
+    for (int i = 0; i < num_threads; ++i)
+        threads_.emplace_back(worker, static_cast<void*>(this));
+
+    thread_state_.set_to(RUNNING);
+}
+
+void request_queue_impl_parallel::set_priority_weights(const priority_weights& weights)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiting_.set_weights(weights);
+}
+
+void request_queue_impl_parallel::add_request(request_ptr& req)
+{
+    if (req.empty())
+        STXXL_THROW_INVALID_ARGUMENT("Empty request submitted to disk_queue.");
+    if (thread_state_() != RUNNING)
+        STXXL_THROW_INVALID_ARGUMENT("Request submitted to not running queue.");
+    if (!dynamic_cast<serving_request*>(req.get()))
+        STXXL_ERRMSG("Incompatible request submitted to running queue.");
+
+    // before it can be dequeued
+    note_added();
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+#if STXXL_CHECK_FOR_PENDING_REQUESTS_ON_SUBMISSION
+        const request::read_or_write op = req->get_op();
+
+        bool pending =
+            waiting_.any_of([&req, op](const request_ptr& r) {
+                                return r->get_op() != op && same_file_offset(r, req);
+                            }) ||
+            std::find_if(in_service_.begin(), in_service_.end(),
+                         [&req, op](const request_ptr& r) {
+                             return r->get_op() != op && same_file_offset(r, req);
+                         }) != in_service_.end();
+
+        if (pending) {
+            if (op == request::READ)
+                STXXL_ERRMSG("READ request submitted for a BID with a pending WRITE request");
+            else
+                STXXL_ERRMSG("WRITE request submitted for a BID with a pending READ request");
+        }
+#endif
+
+        waiting_.push_back(req);
+    }
+
+    cv_.notify_one();
+}
+
+bool request_queue_impl_parallel::cancel_request(request_ptr& req)
+{
+    if (req.empty())
+        STXXL_THROW_INVALID_ARGUMENT("Empty request canceled disk_queue.");
+    if (thread_state_() != RUNNING)
+        STXXL_THROW_INVALID_ARGUMENT("Request canceled to not running queue.");
+    if (!dynamic_cast<serving_request*>(req.get()))
+        STXXL_ERRMSG("Incompatible request submitted to running queue.");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (!waiting_.erase(req))
+        return false;
+
+    note_canceled();
+    return true;
+}
+
+bool request_queue_impl_parallel::boost_request(request_ptr& req)
+{
+    if (req.empty())
+        STXXL_THROW_INVALID_ARGUMENT("Empty request boosted in disk_queue.");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    return waiting_.boost(req);
+}
+
+request_queue_impl_parallel::~request_queue_impl_parallel()
+{
+    assert(thread_state_() == RUNNING);
+    {
+        // set under the lock, such that no worker misses the wakeup
+        std::unique_lock<std::mutex> lock(mutex_);
+        thread_state_.set_to(TERMINATING);
+    }
+    cv_.notify_all();
+
+    for (std::thread& t : threads_)
+    {
+#if STXXL_MSVC >= 1700
+        // see request_queue_impl_worker::stop_thread()
+        WaitForSingleObject(t.native_handle(), INFINITE);
+        CloseHandle(t.native_handle());
+#else
+        t.join();
+#endif
+    }
+
+    thread_state_.set_to(NOT_RUNNING);
+}
+
+bool request_queue_impl_parallel::servable(const request_ptr& req) const
+{
+    return std::find_if(
+        in_service_.begin(), in_service_.end(),
+        [&req](const request_ptr& r) { return same_file_offset(r, req); }
+        ) == in_service_.end();
+}
+
+void* request_queue_impl_parallel::worker(void* arg)
+{
+    self* pthis = static_cast<self*>(arg);
+
+    std::unique_lock<std::mutex> lock(pthis->mutex_);
+    for ( ; ; )
+    {
+        request_ptr req = pthis->waiting_.pop_if(
+            [pthis](const request_ptr& r) { return pthis->servable(r); });
+
+        if (!req)
+        {
+            // terminate if it has been requested and queues are empty
+            if (pthis->thread_state_() == TERMINATING && pthis->waiting_.empty())
+                break;
+
+            pthis->cv_.wait(lock);
+            continue;
+        }
+
+        pthis->in_service_.push_front(req);
+        queue_type::iterator slot = pthis->in_service_.begin();
+
+        lock.unlock();
+
+        request_trace::event(req.get(), request_trace::DEQUEUE);
+        pthis->note_dequeued();
+        pthis->throttle(req->get_op(), req->get_size());
+        dynamic_cast<serving_request*>(req.get())->serve(pthis->queue_stats_);
+
+        lock.lock();
+
+        pthis->in_service_.erase(slot);
+
+        // requests held back for the offset just served may now proceed, the
+        // idle workers may all have passed over them. Otherwise one idle
+        // worker suffices to help with the remaining requests.
+        if (pthis->waiting_.any_of(
+                [&req](const request_ptr& r) { return same_file_offset(r, req); }))
+            pthis->cv_.notify_all();
+        else if (!pthis->waiting_.empty())
+            pthis->cv_.notify_one();
+    }
+
+    lock.unlock();
+
+#if STXXL_MSVC >= 1700
+    // Workaround for deadlock bug in Visual C++ Runtime 2012 and 2013, see
+    // request_queue_impl_worker.cpp. -tb
+    ExitThread(nullptr);
+#else
+    return nullptr;
+#endif
+}
+
+} // namespace foxxll
+// vim: et:ts=4:sw=4
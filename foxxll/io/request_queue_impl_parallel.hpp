@@ -0,0 +1,77 @@
+/***************************************************************************
+ *  foxxll/io/request_queue_impl_parallel.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef STXXL_IO_REQUEST_QUEUE_IMPL_PARALLEL_HEADER
+#define STXXL_IO_REQUEST_QUEUE_IMPL_PARALLEL_HEADER
+
+#include <foxxll/common/object_pool.hpp>
+#include <foxxll/io/fair_request_queue.hpp>
+#include <foxxll/io/request_queue_impl_worker.hpp>
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace foxxll {
+
+//! \addtogroup reqlayer
+//! \{
+
+//! Implementation of a local request queue having one queue per priority
+//! class, which are served by a pool of worker threads. This keeps several
+//! synchronous requests in flight per disk, which pays off on devices with
+//! internal parallelism (SSDs, RAID). Like request_queue_impl_qwqr, the
+//! priority classes share the queue by weight. Requests for the same file
+//! offset are never served concurrently and are served in submission order
+//! within one priority class.
+class request_queue_impl_parallel final : public request_queue_impl_worker
+{
+private:
+    using self = request_queue_impl_parallel;
+    using queue_type = std::list<request_ptr, pool_alloc<request_ptr> >;
+
+    //! protects both queues
+    std::mutex mutex_;
+    //! signaled when requests are added, finished, or the queue terminates
+    std::condition_variable cv_;
+
+    fair_request_queue waiting_;
+    //! requests currently being served by a worker
+    queue_type in_service_;
+
+    shared_state<thread_state> thread_state_;
+    std::vector<std::thread> threads_;
+
+    static void * worker(void* arg);
+
+    //! whether req does not overlap an in-service request
+    bool servable(const request_ptr& req) const;
+
+public:
+    //! \param num_threads number of worker threads serving requests
+    explicit request_queue_impl_parallel(int num_threads = 2);
+
+    void set_priority_weights(const priority_weights& weights) final;
+    void add_request(request_ptr& req) final;
+    bool cancel_request(request_ptr& req) final;
+    bool boost_request(request_ptr& req) final;
+    ~request_queue_impl_parallel();
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !STXXL_IO_REQUEST_QUEUE_IMPL_PARALLEL_HEADER
+// vim: et:ts=4:sw=4
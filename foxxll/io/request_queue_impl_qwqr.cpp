@@ -15,33 +15,19 @@
 
 #include <foxxll/common/error_handling.hpp>
 #include <foxxll/io/request_queue_impl_qwqr.hpp>
+#include <foxxll/io/request_trace.hpp>
 #include <foxxll/io/serving_request.hpp>
 
 #if STXXL_MSVC >= 1700
  #include <windows.hpp>
 #endif
 
-#include <algorithm>
-
 #ifndef STXXL_CHECK_FOR_PENDING_REQUESTS_ON_SUBMISSION
 #define STXXL_CHECK_FOR_PENDING_REQUESTS_ON_SUBMISSION 1
 #endif
 
 namespace foxxll {
 
-struct file_offset_match
-    : public std::binary_function<request_ptr, request_ptr, bool>
-{
-    bool operator () (
-        const request_ptr& a,
-        const request_ptr& b) const
-    {
-        // matching file and offset are enough to cause problems
-        return (a->get_offset() == b->get_offset()) &&
-               (a->get_file() == b->get_file());
-    }
-};
-
 request_queue_impl_qwqr::request_queue_impl_qwqr(int n)
     : thread_state_(NOT_RUNNING), sem_(0)
 {
@@ -49,6 +35,12 @@ request_queue_impl_qwqr::request_queue_impl_qwqr(int n)
     start_thread(worker, static_cast<void*>(this), thread_, thread_state_);
 }
 
+void request_queue_impl_qwqr::set_priority_weights(const priority_weights& weights)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_.set_weights(weights);
+}
+
 void request_queue_impl_qwqr::add_request(request_ptr& req)
 {
     if (req.empty())
@@ -58,38 +50,40 @@ void request_queue_impl_qwqr::add_request(request_ptr& req)
     if (!dynamic_cast<serving_request*>(req.get()))
         STXXL_ERRMSG("Incompatible request submitted to running queue.");
 
-    if (req.get()->get_op() == request::READ)
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (req->get_op() == request::READ)
     {
-#if STXXL_CHECK_FOR_PENDING_REQUESTS_ON_SUBMISSION
+        if (request* write = index_.find(
+                req->get_file(), req->get_offset(), request::WRITE))
         {
-            std::unique_lock<std::mutex> lock(write_mutex_);
-            if (std::find_if(write_queue_.begin(), write_queue_.end(),
-                             bind2nd(file_offset_match(), req))
-                != write_queue_.end())
+            serving_request* sreq = dynamic_cast<serving_request*>(req.get());
+            if (sreq && write->get_size() >= req->get_size())
             {
-                STXXL_ERRMSG("READ request submitted for a BID with a pending WRITE request");
+                // read-after-write: copy the data while the write waits
+                sreq->forward(write);
+                lock.unlock();
+                sreq->completed(false);
+                return;
             }
-        }
+#if STXXL_CHECK_FOR_PENDING_REQUESTS_ON_SUBMISSION
+            STXXL_ERRMSG("READ request submitted for a BID with a pending WRITE request");
 #endif
-        std::unique_lock<std::mutex> lock(read_mutex_);
-        read_queue_.push_back(req);
+        }
     }
-    else
-    {
 #if STXXL_CHECK_FOR_PENDING_REQUESTS_ON_SUBMISSION
-        {
-            std::unique_lock<std::mutex> lock(read_mutex_);
-            if (std::find_if(read_queue_.begin(), read_queue_.end(),
-                             bind2nd(file_offset_match(), req))
-                != read_queue_.end())
-            {
-                STXXL_ERRMSG("WRITE request submitted for a BID with a pending READ request");
-            }
-        }
-#endif
-        std::unique_lock<std::mutex> lock(write_mutex_);
-        write_queue_.push_back(req);
+    else if (index_.find(req->get_file(), req->get_offset(), request::READ))
+    {
+        STXXL_ERRMSG("WRITE request submitted for a BID with a pending READ request");
     }
+#endif
+
+    // before it can be dequeued
+    note_added();
+
+    queue_.push_back(req);
+    index_.insert(req.get());
+    lock.unlock();
 
     sem_.signal();
 }
@@ -103,35 +97,26 @@ bool request_queue_impl_qwqr::cancel_request(request_ptr& req)
     if (!dynamic_cast<serving_request*>(req.get()))
         STXXL_ERRMSG("Incompatible request submitted to running queue.");
 
-    bool was_still_in_queue = false;
-    if (req.get()->get_op() == request::READ)
-    {
-        std::unique_lock<std::mutex> lock(read_mutex_);
-        queue_type::iterator pos
-            = std::find(read_queue_.begin(), read_queue_.end(), req);
-        if (pos != read_queue_.end())
-        {
-            read_queue_.erase(pos);
-            was_still_in_queue = true;
-            lock.unlock();
-            sem_.wait();
-        }
-    }
-    else
     {
-        std::unique_lock<std::mutex> lock(write_mutex_);
-        queue_type::iterator pos
-            = std::find(write_queue_.begin(), write_queue_.end(), req);
-        if (pos != write_queue_.end())
-        {
-            write_queue_.erase(pos);
-            was_still_in_queue = true;
-            lock.unlock();
-            sem_.wait();
-        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!queue_.erase(req))
+            return false;
+        index_.erase(req.get());
     }
 
-    return was_still_in_queue;
+    sem_.wait();
+    note_canceled();
+
+    return true;
+}
+
+bool request_queue_impl_qwqr::boost_request(request_ptr& req)
+{
+    if (req.empty())
+        STXXL_THROW_INVALID_ARGUMENT("Empty request boosted in disk_queue.");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    return queue_.boost(req);
 }
 
 request_queue_impl_qwqr::~request_queue_impl_qwqr()
@@ -143,67 +128,35 @@ void* request_queue_impl_qwqr::worker(void* arg)
 {
     self* pthis = static_cast<self*>(arg);
 
-    bool write_phase = true;
     for ( ; ; )
     {
         pthis->sem_.wait();
 
-        if (write_phase)
         {
-            std::unique_lock<std::mutex> write_lock(pthis->write_mutex_);
-            if (!pthis->write_queue_.empty())
+            std::unique_lock<std::mutex> lock(pthis->mutex_);
+            if (!pthis->queue_.empty())
             {
-                request_ptr req = pthis->write_queue_.front();
-                pthis->write_queue_.pop_front();
+                request_ptr req = pthis->queue_.pop();
+                pthis->index_.erase(req.get());
 
-                write_lock.unlock();
+                lock.unlock();
 
-                //assert(req->get_reference_count()) > 1);
-                dynamic_cast<serving_request*>(req.get())->serve();
-            }
-            else
-            {
-                write_lock.unlock();
-
-                pthis->sem_.signal();
-
-                if (pthis->priority_op_ == WRITE)
-                    write_phase = false;
-            }
-
-            if (pthis->priority_op_ == NONE || pthis->priority_op_ == READ)
-                write_phase = false;
-        }
-        else
-        {
-            std::unique_lock<std::mutex> read_lock(pthis->read_mutex_);
-
-            if (!pthis->read_queue_.empty())
-            {
-                request_ptr req = pthis->read_queue_.front();
-                pthis->read_queue_.pop_front();
-
-                read_lock.unlock();
+                request_trace::event(req.get(), request_trace::DEQUEUE);
+                pthis->note_dequeued();
+                pthis->throttle(req->get_op(), req->get_size());
 
                 STXXL_VERBOSE2("queue: before serve request has "
                                << req->reference_count() << " references ");
-                //assert(req->get_reference_count() > 1);
-                dynamic_cast<serving_request*>(req.get())->serve();
+                dynamic_cast<serving_request*>(req.get())->serve(pthis->queue_stats_);
                 STXXL_VERBOSE2("queue: after serve request has "
                                << req->reference_count() << " references ");
             }
             else
             {
-                read_lock.unlock();
+                lock.unlock();
 
                 pthis->sem_.signal();
-
-                if (pthis->priority_op_ == READ)
-                    write_phase = true;
             }
-
-            if (pthis->priority_op_ == NONE || pthis->priority_op_ == WRITE)
-                write_phase = true;
         }
 
         // terminate if it has been requested and queues are empty
@@ -16,9 +16,10 @@
 #ifndef STXXL_IO_REQUEST_QUEUE_IMPL_QWQR_HEADER
 #define STXXL_IO_REQUEST_QUEUE_IMPL_QWQR_HEADER
 
+#include <foxxll/io/fair_request_queue.hpp>
+#include <foxxll/io/pending_request_index.hpp>
 #include <foxxll/io/request_queue_impl_worker.hpp>
 
-#include <list>
 #include <mutex>
 
 namespace foxxll {
@@ -26,43 +27,36 @@ namespace foxxll {
 //! \addtogroup reqlayer
 //! \{
 
-//! Implementation of a local request queue having two queues, one for read and
-//! one for write requests, thus having two threads. This is the default
-//! implementation.
+//! Implementation of a local request queue having one queue per priority
+//! class, which share the thread serving them by weight, see fair_share. This
+//! is the default implementation.
+//!
+//! A read request for the offset of a waiting write request is served from
+//! the write's buffer when added, without I/O.
 class request_queue_impl_qwqr final : public request_queue_impl_worker
 {
 private:
     using self = request_queue_impl_qwqr;
-    using queue_type = std::list<request_ptr>;
 
-    std::mutex write_mutex_;
-    std::mutex read_mutex_;
-    queue_type write_queue_;
-    queue_type read_queue_;
+    std::mutex mutex_;
+    fair_request_queue queue_;
+    //! requests in queue_
+    pending_request_index index_;
 
     shared_state<thread_state> thread_state_;
     std::thread thread_;
     semaphore sem_;
 
-    static const priority_op priority_op_ = WRITE;
-
     static void * worker(void* arg);
 
 public:
     // \param n max number of requests simultaneously submitted to disk
     explicit request_queue_impl_qwqr(int n = 1);
 
-    // in a multi-threaded setup this does not work as intended
-    // also there were race conditions possible
-    // and actually an old value was never restored once a new one was set ...
-    // so just disable it and all it's nice implications
-    void set_priority_op(const priority_op& op) final
-    {
-        //_priority_op = op;
-        STXXL_UNUSED(op);
-    }
+    void set_priority_weights(const priority_weights& weights) final;
     void add_request(request_ptr& req) final;
     bool cancel_request(request_ptr& req) final;
+    bool boost_request(request_ptr& req) final;
     ~request_queue_impl_qwqr();
 };
 
@@ -0,0 +1,297 @@
+/***************************************************************************
+ *  foxxll/io/request_trace.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/common/error_handling.hpp>
+#include <foxxll/common/exceptions.hpp>
+#include <foxxll/io/file.hpp>
+#include <foxxll/io/request.hpp>
+#include <foxxll/io/request_trace.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <stdexcept>
+
+namespace foxxll {
+
+static_assert(sizeof(request_trace::record) == 48,
+              "request_trace::record must have a fixed layout");
+
+//! magic at the beginning of trace files
+static const char trace_magic[8] = "FOXXTRC";
+
+constexpr uint32_t request_trace::version;
+
+std::atomic<bool> request_trace::enabled_ { false };
+
+//! Single-producer single-consumer ring of events: the owning thread appends,
+//! the flush thread removes.
+class request_trace::ring
+{
+public:
+    static constexpr size_t capacity = 8192;
+
+    explicit ring(uint32_t thread)
+        : thread_(thread), records_(capacity)
+    { }
+
+    const uint32_t thread_;
+
+    //! set when the owning thread exits, the ring is removed once drained
+    std::atomic<bool> orphaned_ { false };
+
+    //! append, or return false if full
+    bool push(const record& r)
+    {
+        const uint64_t h = head_.load(std::memory_order_relaxed);
+        if (h - tail_.load(std::memory_order_acquire) >= capacity)
+            return false;
+        records_[h % capacity] = r;
+        head_.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! move all records to out
+    void drain(std::vector<record>& out)
+    {
+        const uint64_t t = tail_.load(std::memory_order_relaxed);
+        const uint64_t h = head_.load(std::memory_order_acquire);
+        for (uint64_t i = t; i < h; ++i)
+            out.push_back(records_[i % capacity]);
+        tail_.store(h, std::memory_order_release);
+    }
+
+private:
+    std::vector<record> records_;
+    std::atomic<uint64_t> head_ { 0 };
+    std::atomic<uint64_t> tail_ { 0 };
+};
+
+constexpr size_t request_trace::ring::capacity;
+
+request_trace::~request_trace()
+{
+    stop();
+}
+
+void request_trace::start(const std::string& path)
+{
+    stop();
+
+    out_.open(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out_)
+        STXXL_THROW_ERRNO(io_error, "Cannot open trace file '" << path << "'");
+
+    const uint32_t header[2] = { version, sizeof(record) };
+    out_.write(trace_magic, sizeof(trace_magic));
+    out_.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    {
+        // discard events left over from a previous trace
+        std::unique_lock<std::mutex> lock(rings_mutex_);
+        std::vector<record> stale;
+        for (std::shared_ptr<ring>& r : rings_)
+            r->drain(stale);
+    }
+
+    terminate_ = false;
+    thread_ = std::thread([this]() { worker(); });
+
+    enabled_.store(true);
+}
+
+void request_trace::stop()
+{
+    if (!thread_.joinable())
+        return;
+
+    enabled_.store(false);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        terminate_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+
+    flush();
+    out_.close();
+}
+
+request_trace::ring* request_trace::local_ring()
+{
+    //! owner of the calling thread's ring, marks it orphaned on thread exit
+    struct holder
+    {
+        std::shared_ptr<ring> ring_;
+
+        ~holder()
+        {
+            if (ring_)
+                ring_->orphaned_.store(true, std::memory_order_release);
+        }
+    };
+    static thread_local holder s_holder;
+
+    if (!s_holder.ring_)
+    {
+        std::unique_lock<std::mutex> lock(rings_mutex_);
+        s_holder.ring_ = std::make_shared<ring>(next_thread_++);
+        rings_.push_back(s_holder.ring_);
+    }
+    return s_holder.ring_.get();
+}
+
+void request_trace::record_event(const request* req, event_type type)
+{
+    request_trace* self = get_instance();
+
+    record r;
+    r.time = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    r.request = reinterpret_cast<uintptr_t>(req);
+    r.offset = req->get_offset();
+    r.size = req->get_size();
+    r.device = req->get_file() ? req->get_file()->get_device_id() : ~0u;
+    r.type = type;
+    r.op = static_cast<uint8_t>(req->get_op());
+    std::memset(r.padding, 0, sizeof(r.padding));
+
+    ring* rg = self->local_ring();
+    r.thread = rg->thread_;
+
+    if (!rg->push(r))
+        self->dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void request_trace::flush()
+{
+    std::vector<record> records;
+    {
+        std::unique_lock<std::mutex> lock(rings_mutex_);
+        for (size_t i = 0; i < rings_.size(); )
+        {
+            // check before draining, such that no event is left behind
+            const bool orphaned = rings_[i]->orphaned_.load(std::memory_order_acquire);
+            rings_[i]->drain(records);
+            if (orphaned) {
+                rings_[i] = rings_.back();
+                rings_.pop_back();
+            }
+            else {
+                ++i;
+            }
+        }
+    }
+
+    out_.write(reinterpret_cast<const char*>(records.data()),
+               static_cast<std::streamsize>(records.size() * sizeof(record)));
+    out_.flush();
+}
+
+void request_trace::worker()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!terminate_)
+    {
+        cv_.wait_for(lock, std::chrono::milliseconds(100));
+
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+uint64_t request_trace::to_chrome_json(std::istream& in, std::ostream& out)
+{
+    char magic[sizeof(trace_magic)];
+    uint32_t header[2];
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+
+    if (!in || std::memcmp(magic, trace_magic, sizeof(magic)) != 0)
+        STXXL_THROW(std::runtime_error, "Not a foxxll request trace.");
+    if (header[0] != version || header[1] != sizeof(record)) {
+        STXXL_THROW(std::runtime_error,
+                    "Unsupported request trace version " << header[0] << ".");
+    }
+
+    // threads are flushed one after another, hence sort events by time
+    std::vector<record> records;
+    record rec;
+    while (in.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
+        records.push_back(rec);
+    std::stable_sort(records.begin(), records.end(),
+                     [](const record& a, const record& b) { return a.time < b.time; });
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    uint64_t count = 0;
+    const uint64_t first_time = records.empty() ? 0 : records.front().time;
+    for (const record& r : records)
+    {
+        const double ts = static_cast<double>(r.time - first_time) / 1e3;
+        // requests are grouped by device, waits by thread
+        const unsigned pid = (r.type == WAIT_BEGIN || r.type == WAIT_END)
+                             ? 0 : r.device + 1;
+
+        auto emit = [&](const char* name, const char* phase) {
+                        out << (count ? ",\n" : "\n")
+                            << "{\"name\":\"" << name << "\""
+                            << ",\"cat\":\"" << (r.op == request::READ ? "read" : "write") << "\""
+                            << ",\"ph\":\"" << phase << "\""
+                            << ",\"pid\":" << pid
+                            << ",\"tid\":" << r.thread
+                            << ",\"ts\":" << std::fixed << std::setprecision(3) << ts;
+                        if (pid != 0)
+                            out << ",\"id\":\"0x" << std::hex << r.request << std::dec << "\"";
+                        out << ",\"args\":{\"offset\":" << r.offset
+                            << ",\"size\":" << r.size << "}}";
+                        ++count;
+                    };
+
+        switch (r.type)
+        {
+        case SUBMIT:
+            emit("queued", "b");
+            break;
+        case DEQUEUE:
+            emit("dequeue", "n");
+            break;
+        case DISPATCH:
+            emit("queued", "e");
+            emit("service", "b");
+            break;
+        case COMPLETE:
+            emit("service", "e");
+            break;
+        case CANCEL:
+            emit("queued", "e");
+            emit("cancel", "n");
+            break;
+        case WAIT_BEGIN:
+            emit("wait", "B");
+            break;
+        case WAIT_END:
+            emit("wait", "E");
+            break;
+        }
+    }
+
+    out << "\n]}\n";
+    return count;
+}
+
+} // namespace foxxll
+// vim: et:ts=4:sw=4
@@ -0,0 +1,168 @@
+/***************************************************************************
+ *  foxxll/io/request_trace.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef STXXL_IO_REQUEST_TRACE_HEADER
+#define STXXL_IO_REQUEST_TRACE_HEADER
+
+#include <foxxll/singleton.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace foxxll {
+
+//! \addtogroup iolayer
+//! \{
+
+class request;
+
+//! Records the lifecycle of I/O requests into a binary trace file. Each
+//! thread writes events into a lock-free ring buffer of its own, which a
+//! background thread flushes to the file; events are dropped rather than
+//! blocking if a ring buffer is full. While tracing is stopped, recording an
+//! event costs a single relaxed atomic load.
+//!
+//! The file starts with the 8 byte magic "FOXXTRC", followed by a 32 bit
+//! version and record size, and then consists of request_trace::record
+//! entries in native byte order. to_chrome_json() converts it for
+//! chrome://tracing and Perfetto.
+//!
+//! \remarks is a singleton
+class request_trace : public singleton<request_trace>
+{
+    friend class singleton<request_trace>;
+
+public:
+    enum event_type : uint8_t {
+        //! request submitted to disk_queues
+        SUBMIT,
+        //! request taken from the queue
+        DEQUEUE,
+        //! request handed to the operating system
+        DISPATCH,
+        //! request completed
+        COMPLETE,
+        //! request canceled
+        CANCEL,
+        //! a thread starts waiting for the request
+        WAIT_BEGIN,
+        //! the thread stopped waiting
+        WAIT_END
+    };
+
+    //! one event as stored in the trace file
+    struct record
+    {
+        //! steady clock time in nanoseconds
+        uint64_t time;
+        //! identity of the request object
+        uint64_t request;
+        uint64_t offset;
+        uint64_t size;
+        //! device id of the file, or ~0 if unknown
+        uint32_t device;
+        //! index of the recording thread
+        uint32_t thread;
+        //! event_type
+        uint8_t type;
+        //! request::read_or_write
+        uint8_t op;
+        uint8_t padding[6];
+    };
+
+    static constexpr uint32_t version = 1;
+
+    //! Start writing events to a file, which is truncated.
+    void start(const std::string& path);
+
+    //! Stop recording and flush all events to the file.
+    void stop();
+
+    //! Whether events are currently recorded.
+    static bool enabled()
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    //! Record an event of a request, if tracing is enabled.
+    static void event(const request* req, event_type type)
+    {
+        if (enabled())
+            record_event(req, type);
+    }
+
+    //! Number of events dropped because a ring buffer was full.
+    uint64_t dropped() const
+    {
+        return dropped_.load();
+    }
+
+    //! Convert a binary trace to Chrome trace-event JSON. Requests are shown
+    //! as asynchronous "queued" and "service" spans per device, waits as
+    //! spans on the waiting thread.
+    //! \return number of events converted
+    static uint64_t to_chrome_json(std::istream& in, std::ostream& out);
+
+private:
+    //! ring buffer of one thread, see request_trace.cpp
+    class ring;
+
+    //! fast path flag, static such that it outlives the singleton
+    static std::atomic<bool> enabled_;
+
+    //! rings of all threads which recorded events
+    std::vector<std::shared_ptr<ring> > rings_;
+    //! protects rings_
+    std::mutex rings_mutex_;
+    //! index of the next thread to record events
+    uint32_t next_thread_ = 0;
+
+    std::atomic<uint64_t> dropped_ { 0 };
+
+    //! output file, written by the flush thread only
+    std::ofstream out_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool terminate_ = false;
+    std::thread thread_;
+
+    request_trace() = default;
+
+    //! stops tracing
+    ~request_trace();
+
+    static void record_event(const request* req, event_type type);
+
+    //! return the calling thread's ring buffer
+    ring * local_ring();
+
+    //! write the events of all rings to the file
+    void flush();
+
+    void worker();
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !STXXL_IO_REQUEST_TRACE_HEADER
+// vim: et:ts=4:sw=4
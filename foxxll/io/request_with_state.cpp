@@ -17,6 +17,7 @@
 #include <foxxll/io/file.hpp>
 #include <foxxll/io/iostats.hpp>
 #include <foxxll/io/request.hpp>
+#include <foxxll/io/request_trace.hpp>
 #include <foxxll/io/request_with_state.hpp>
 #include <foxxll/singleton.hpp>
 #include <foxxll/verbose.hpp>
@@ -45,7 +46,19 @@ void request_with_state::wait(bool measure_time)
     stats::scoped_wait_timer wait_timer(
         op_ == READ ? stats::WAIT_OP_READ : stats::WAIT_OP_WRITE, measure_time);
 
-    state_.wait_for(READY2DIE);
+    request_trace::event(this, request_trace::WAIT_BEGIN);
+    // serve the request first if the wait takes a while
+    if (state_() == OP && !state_.wait_for(READY2DIE, boost_delay()) && boost())
+    {
+        const double start = timestamp();
+        state_.wait_for(READY2DIE);
+        stats::get_instance()->boosted_wait_finished(timestamp() - start);
+    }
+    else
+    {
+        state_.wait_for(READY2DIE);
+    }
+    request_trace::event(this, request_trace::WAIT_END);
 
     check_errors();
 }
@@ -61,6 +74,7 @@ bool request_with_state::cancel()
     request_ptr rp(this);
     if (disk_queues::get_instance()->cancel_request(rp, file_->get_queue_id()))
     {
+        request_trace::event(this, request_trace::CANCEL);
         state_.set_to(DONE);
         if (on_complete_)
             on_complete_(this, /* success */ false);
@@ -85,6 +99,10 @@ bool request_with_state::poll()
 void request_with_state::completed(bool canceled)
 {
     STXXL_VERBOSE3_THIS("request_with_state::completed()");
+    if (!canceled && time_started_ != 0.0)
+        file_->get_file_stats()->add_latency(
+            op_ == WRITE, time_submitted_, time_started_, timestamp());
+    request_trace::event(this, request_trace::COMPLETE);
     // change state
     state_.set_to(DONE);
     // user callback
@@ -12,9 +12,11 @@
  **************************************************************************/
 
 #include <foxxll/common/onoff_switch.hpp>
+#include <foxxll/io/completion_queue.hpp>
 #include <foxxll/io/request_with_waiters.hpp>
 
 #include <algorithm>
+#include <cassert>
 #include <functional>
 #include <mutex>
 
@@ -44,11 +46,50 @@ void request_with_waiters::delete_waiter(onoff_switch* sw)
     m_waiters.erase(sw);
 }
 
+bool request_with_waiters::set_completion_queue(completion_queue* cq, void* tag)
+{
+    // same race as in add_waiter()
+    std::unique_lock<std::mutex> lock(m_waiters_mutex);
+
+    bool done;
+    try
+    {
+        done = poll();
+    }
+    catch (const io_error&)
+    {
+        // failed requests are completed, the error is raised on wait()
+        done = true;
+    }
+    if (done)
+        return true;
+
+    assert(m_completion_queue == nullptr);
+    m_completion_queue = cq;
+    m_completion_tag = tag;
+
+    return false;
+}
+
+bool request_with_waiters::reset_completion_queue(completion_queue* cq)
+{
+    std::unique_lock<std::mutex> lock(m_waiters_mutex);
+    if (m_completion_queue != cq)
+        return false;
+    m_completion_queue = nullptr;
+    return true;
+}
+
 void request_with_waiters::notify_waiters()
 {
     std::unique_lock<std::mutex> lock(m_waiters_mutex);
     std::for_each(m_waiters.begin(), m_waiters.end(),
                   std::mem_fun(&onoff_switch::on));
+    if (m_completion_queue)
+    {
+        m_completion_queue->push(this, m_completion_tag);
+        m_completion_queue = nullptr;
+    }
 }
 
 size_t request_with_waiters::num_waiters()
@@ -31,9 +31,15 @@ class request_with_waiters : public request
     std::mutex m_waiters_mutex;
     std::set<onoff_switch*> m_waiters;
 
+    //! queue to push this request onto on completion, and the caller's tag
+    completion_queue* m_completion_queue = nullptr;
+    void* m_completion_tag = nullptr;
+
 protected:
     bool add_waiter(onoff_switch* sw) final;
     void delete_waiter(onoff_switch* sw) final;
+    bool set_completion_queue(completion_queue* cq, void* tag) final;
+    bool reset_completion_queue(completion_queue* cq) final;
     void notify_waiters() final;
 
     //! returns number of waiters
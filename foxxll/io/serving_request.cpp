@@ -13,12 +13,16 @@
 
 #include <foxxll/common/exceptions.hpp>
 #include <foxxll/common/shared_state.hpp>
+#include <foxxll/common/timer.hpp>
 #include <foxxll/io/file.hpp>
 #include <foxxll/io/request_interface.hpp>
+#include <foxxll/io/request_trace.hpp>
 #include <foxxll/io/request_with_state.hpp>
 #include <foxxll/io/serving_request.hpp>
 #include <foxxll/verbose.hpp>
 
+#include <cassert>
+#include <cstring>
 #include <iomanip>
 
 namespace foxxll {
@@ -37,7 +41,7 @@ serving_request::serving_request(
 #endif
 }
 
-void serving_request::serve()
+void serving_request::serve(queue_stats* gauges)
 {
     check_nref();
     STXXL_VERBOSE2_THIS(
@@ -48,6 +52,9 @@ void serving_request::serve()
             offset_ << "/0x" << bytes_ <<
         (op_ == request::READ ? " READ" : " WRITE"));
 
+    mark_started(timestamp());
+    request_trace::event(this, request_trace::DISPATCH);
+
     try
     {
         file_->serve(buffer_, offset_, bytes_, op_);
@@ -59,9 +66,92 @@ void serving_request::serve()
 
     check_nref(true);
 
+    // before waking waiters, such that the gauges are current for them
+    if (gauges)
+        gauges->completed();
+
     completed(false);
 }
 
+constexpr size_t serving_request::max_merge;
+
+void serving_request::serve_merged(const request_ptr* reqs, size_t count,
+                                   queue_stats* gauges)
+{
+    assert(count > 0 && count <= max_merge);
+
+    if (count == 1)
+        return static_cast<serving_request*>(reqs[0].get())->serve(gauges);
+
+    serving_request* first = static_cast<serving_request*>(reqs[0].get());
+    file::io_vector vec[max_merge];
+
+    const double now = timestamp();
+    for (size_t i = 0; i < count; ++i)
+    {
+        serving_request* req = static_cast<serving_request*>(reqs[i].get());
+        assert(req->file_ == first->file_ && req->op_ == first->op_);
+        assert(i == 0 || req->offset_ ==
+               static_cast<serving_request*>(reqs[i - 1].get())->offset_ + vec[i - 1].bytes);
+
+        req->check_nref();
+        req->mark_started(now);
+        request_trace::event(req, request_trace::DISPATCH);
+
+        vec[i].buffer = req->buffer_;
+        vec[i].bytes = req->bytes_;
+    }
+
+    STXXL_VERBOSE2("serving_request::serve_merged(): " << count <<
+                   " requests @ [" << first->file_ << "]0x" <<
+                   std::hex << first->offset_ <<
+                   (first->op_ == request::READ ? " READ" : " WRITE"));
+
+    try
+    {
+        first->file_->serve_vectored(vec, count, first->offset_, first->op_);
+    }
+    catch (const io_error& ex)
+    {
+        for (size_t i = 0; i < count; ++i)
+            static_cast<serving_request*>(reqs[i].get())->error_occured(ex.what());
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        serving_request* req = static_cast<serving_request*>(reqs[i].get());
+        req->check_nref(true);
+
+        // before waking waiters, such that the gauges are current for them
+        if (gauges)
+            gauges->completed();
+
+        req->completed(false);
+    }
+}
+
+void serving_request::forward(const request* write)
+{
+    assert(op_ == READ && write->get_op() == WRITE);
+    assert(write->get_file() == file_ && write->get_offset() == offset_);
+    assert(write->get_size() >= bytes_);
+
+    check_nref();
+    STXXL_VERBOSE2_THIS(
+        "serving_request::forward(): " <<
+            buffer_ << " @ [" <<
+            file_ << "|" << file_->get_allocator_id() << "]0x" <<
+            std::hex << std::setfill('0') << std::setw(8) <<
+            offset_ << "/0x" << bytes_ << " READ from pending WRITE");
+
+    mark_started(timestamp());
+    request_trace::event(this, request_trace::DISPATCH);
+
+    memcpy(buffer_, write->get_buffer(), bytes_);
+
+    check_nref(true);
+}
+
 const char* serving_request::io_type() const
 {
     return file_->io_type();
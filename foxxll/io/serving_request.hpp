@@ -14,6 +14,8 @@
 #ifndef STXXL_IO_SERVING_REQUEST_HEADER
 #define STXXL_IO_SERVING_REQUEST_HEADER
 
+#include <foxxll/common/object_pool.hpp>
+#include <foxxll/io/iostats.hpp>
 #include <foxxll/io/request_with_state.hpp>
 
 namespace foxxll {
@@ -29,6 +31,8 @@ class serving_request : public request_with_state
 
     friend class request_queue_impl_qwqr;
     friend class request_queue_impl_1q;
+    friend class request_queue_impl_parallel;
+    friend class request_queue_impl_elevator;
 
 public:
     serving_request(
@@ -37,10 +41,37 @@ public:
         read_or_write op);
 
 protected:
-    virtual void serve();
+    //! Perform the I/O and complete the request. The gauges of the serving
+    //! queue, if any, are updated before waiters are woken.
+    virtual void serve(queue_stats* gauges = nullptr);
+
+    //! maximum number of requests served by one serve_merged() call
+    static constexpr size_t max_merge = 64;
+
+    //! Perform the I/O of count requests of the same operation on adjacent
+    //! regions of the same file, in order of their offsets, with one vectored
+    //! I/O and complete them. An I/O error fails all of them.
+    static void serve_merged(const request_ptr* reqs, size_t count,
+                             queue_stats* gauges = nullptr);
+
+    //! Serve a read request from the buffer of a pending write request to the
+    //! same offset and at least as many bytes, without I/O. The caller must
+    //! keep the write pending meanwhile and complete the read afterwards with
+    //! completed(false).
+    void forward(const request* write);
 
 public:
     const char * io_type() const final;
+
+    static void * operator new (size_t bytes)
+    {
+        return object_pool<serving_request>::allocate(bytes);
+    }
+
+    static void operator delete (void* p, size_t bytes)
+    {
+        object_pool<serving_request>::deallocate(p, bytes);
+    }
 };
 
 //! \}
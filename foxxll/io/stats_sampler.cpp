@@ -0,0 +1,109 @@
+/***************************************************************************
+ *  foxxll/io/stats_sampler.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/common/error_handling.hpp>
+#include <foxxll/common/exceptions.hpp>
+#include <foxxll/common/timer.hpp>
+#include <foxxll/io/iostats.hpp>
+#include <foxxll/io/stats_sampler.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace foxxll {
+
+stats_sampler::stats_sampler(const std::string& path, unsigned interval_ms,
+                             format_type format)
+    : out_(path.c_str(), std::ios::out | std::ios::trunc),
+      interval_(interval_ms ? interval_ms : 1),
+      format_(format),
+      start_(timestamp()),
+      last_(*stats::get_instance())
+{
+    if (!out_)
+        STXXL_THROW_ERRNO(io_error, "Cannot open statistics file '" << path << "'");
+
+    if (format_ == CSV)
+        stats_data::csv_header(out_, "time,");
+    out_.flush();
+
+    thread_ = std::thread([this]() { worker(); });
+}
+
+stats_sampler::~stats_sampler()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        terminate_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+
+    sample();
+}
+
+stats_sampler::format_type stats_sampler::parse_format(const std::string& name)
+{
+    if (name == "csv")
+        return CSV;
+    if (name == "json")
+        return JSON;
+
+    STXXL_THROW(std::runtime_error,
+                "Unknown statistics format '" << name << "', use csv or json.");
+}
+
+void stats_sampler::sample()
+{
+    stats_data now(*stats::get_instance());
+    stats_data delta = now - last_;
+    last_ = now;
+
+    const double time = timestamp() - start_;
+
+    if (format_ == CSV)
+    {
+        std::ostringstream prefix;
+        prefix << time << ',';
+        delta.to_csv(out_, prefix.str());
+    }
+    else
+    {
+        out_ << "{\"time\":" << time << ",\"stats\":";
+        delta.to_json(out_);
+        out_ << "}\n";
+    }
+    out_.flush();
+}
+
+void stats_sampler::worker()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto next = std::chrono::steady_clock::now() + interval_;
+
+    while (!terminate_)
+    {
+        if (cv_.wait_until(lock, next) != std::cv_status::timeout)
+            continue;
+
+        lock.unlock();
+        sample();
+        lock.lock();
+
+        // skip samples rather than catching up after a stall
+        next = std::max(next + interval_, std::chrono::steady_clock::now());
+    }
+}
+
+} // namespace foxxll
+// vim: et:ts=4:sw=4
@@ -0,0 +1,84 @@
+/***************************************************************************
+ *  foxxll/io/stats_sampler.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef STXXL_IO_STATS_SAMPLER_HEADER
+#define STXXL_IO_STATS_SAMPLER_HEADER
+
+#include <foxxll/io/iostats.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace foxxll {
+
+//! \addtogroup iolayer
+//! \{
+
+//! Background thread which periodically writes the change of the I/O
+//! statistics since the previous sample to a file. In CSV format, each sample
+//! is one line per file preceded by the time since the sampler started; in
+//! JSON format, each sample is one object per line. Enabled by the line
+//! "stats=<path>,<interval ms>[,csv|json]" in the config file.
+class stats_sampler
+{
+public:
+    enum format_type { CSV, JSON };
+
+    //! Open the output file and start sampling.
+    //! \param path output file, truncated
+    //! \param interval_ms milliseconds between samples
+    //! \param format output format
+    stats_sampler(const std::string& path, unsigned interval_ms,
+                  format_type format = CSV);
+
+    //! non-copyable: delete copy-constructor
+    stats_sampler(const stats_sampler&) = delete;
+    //! non-copyable: delete assignment operator
+    stats_sampler& operator = (const stats_sampler&) = delete;
+
+    //! Write a last sample and stop.
+    ~stats_sampler();
+
+    //! Parse a format name ("csv" or "json").
+    static format_type parse_format(const std::string& name);
+
+private:
+    std::ofstream out_;
+    const std::chrono::milliseconds interval_;
+    const format_type format_;
+
+    //! time of construction
+    const double start_;
+    //! statistics at the previous sample
+    stats_data last_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool terminate_ = false;
+    std::thread thread_;
+
+    //! write the change since the previous sample
+    void sample();
+
+    void worker();
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !STXXL_IO_STATS_SAMPLER_HEADER
+// vim: et:ts=4:sw=4
@@ -20,24 +20,57 @@
 #include <foxxll/io/request_interface.hpp>
 #include <foxxll/io/syscall_file.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 #include <mutex>
 
+// Positional I/O does not touch the shared file position, hence concurrent
+// requests on the same file need no lock. Windows lacks pread()/pwrite().
+#ifndef STXXL_SYSCALL_FILE_POSITIONAL_IO
+ #if STXXL_WINDOWS || defined(__MINGW32__)
+  #define STXXL_SYSCALL_FILE_POSITIONAL_IO 0
+ #else
+  #define STXXL_SYSCALL_FILE_POSITIONAL_IO 1
+ #endif
+#endif
+
+// Vectored positional I/O serves adjacent requests merged by a queue with a
+// single system call.
+#ifndef STXXL_SYSCALL_FILE_VECTORED_IO
+ #if STXXL_SYSCALL_FILE_POSITIONAL_IO && (defined(__linux__) || defined(__FreeBSD__))
+  #define STXXL_SYSCALL_FILE_VECTORED_IO 1
+ #else
+  #define STXXL_SYSCALL_FILE_VECTORED_IO 0
+ #endif
+#endif
+
+#if STXXL_SYSCALL_FILE_VECTORED_IO
+ #include <sys/uio.h>
+#endif
+
 namespace foxxll {
 
 void syscall_file::serve(void* buffer, offset_type offset, size_type bytes,
                          request::read_or_write op)
 {
+#if !STXXL_SYSCALL_FILE_POSITIONAL_IO
     std::unique_lock<std::mutex> fd_lock(fd_mutex_);
+#endif
 
     char* cbuffer = static_cast<char*>(buffer);
 
+    if (op == request::WRITE)
+        cancel_discard(offset, bytes);
+
     file_stats::scoped_read_write_timer read_write_timer(
         file_stats_, bytes, op == request::WRITE);
 
     while (bytes > 0)
     {
-        off_t rc = ::lseek(file_des_, offset, SEEK_SET);
+        off_t rc;
+#if !STXXL_SYSCALL_FILE_POSITIONAL_IO
+        rc = ::lseek(file_des_, offset, SEEK_SET);
         if (rc < 0)
         {
             STXXL_THROW_ERRNO
@@ -52,10 +85,13 @@ void syscall_file::serve(void* buffer, offset_type offset, size_type bytes,
                 " op=" << ((op == request::READ) ? "READ" : "WRITE") <<
                 " rc=" << rc);
         }
+#endif
 
         if (op == request::READ)
         {
-#if STXXL_MSVC
+#if STXXL_SYSCALL_FILE_POSITIONAL_IO
+            if ((rc = ::pread(file_des_, cbuffer, bytes, offset)) <= 0)
+#elif STXXL_MSVC
             assert(bytes <= std::numeric_limits<unsigned int>::max());
             if ((rc = ::read(file_des_, cbuffer, (unsigned int)bytes)) <= 0)
 #else
@@ -65,7 +101,9 @@ void syscall_file::serve(void* buffer, offset_type offset, size_type bytes,
                 STXXL_THROW_ERRNO
                     (io_error,
                     " this=" << this <<
-                    " call=::read(fd,buffer,bytes)" <<
+                    " call=" << (STXXL_SYSCALL_FILE_POSITIONAL_IO ?
+                                 "::pread(fd,buffer,bytes,offset)" :
+                                 "::read(fd,buffer,bytes)") <<
                     " path=" << filename_ <<
                     " fd=" << file_des_ <<
                     " offset=" << offset <<
@@ -88,7 +126,9 @@ void syscall_file::serve(void* buffer, offset_type offset, size_type bytes,
         }
         else
         {
-#if STXXL_MSVC
+#if STXXL_SYSCALL_FILE_POSITIONAL_IO
+            if ((rc = ::pwrite(file_des_, cbuffer, bytes, offset)) <= 0)
+#elif STXXL_MSVC
             assert(bytes <= std::numeric_limits<unsigned int>::max());
             if ((rc = ::write(file_des_, cbuffer, (unsigned int)bytes)) <= 0)
 #else
@@ -98,7 +138,9 @@ void syscall_file::serve(void* buffer, offset_type offset, size_type bytes,
                 STXXL_THROW_ERRNO
                     (io_error,
                     " this=" << this <<
-                    " call=::write(fd,buffer,bytes)" <<
+                    " call=" << (STXXL_SYSCALL_FILE_POSITIONAL_IO ?
+                                 "::pwrite(fd,buffer,bytes,offset)" :
+                                 "::write(fd,buffer,bytes)") <<
                     " path=" << filename_ <<
                     " fd=" << file_des_ <<
                     " offset=" << offset <<
@@ -114,6 +156,87 @@ void syscall_file::serve(void* buffer, offset_type offset, size_type bytes,
     }
 }
 
+void syscall_file::serve_vectored(const io_vector* vec, size_t count,
+                                  offset_type offset, request::read_or_write op)
+{
+#if STXXL_SYSCALL_FILE_VECTORED_IO
+    size_type bytes = 0;
+    for (size_t i = 0; i < count; ++i)
+        bytes += vec[i].bytes;
+
+    if (op == request::WRITE)
+        cancel_discard(offset, bytes);
+
+    file_stats::scoped_read_write_timer read_write_timer(
+        file_stats_, bytes, op == request::WRITE);
+    // count the requests, and the merge separately
+    file_stats_->merged(op == request::WRITE, count);
+
+    static const size_t max_iov = 64;
+    struct iovec iov[max_iov];
+
+    // vec[i] is the first buffer not transferred completely, of which done
+    // bytes are transferred already
+    size_t i = 0;
+    size_type done = 0;
+    while (i < count)
+    {
+        const size_t n = std::min(count - i, max_iov);
+        for (size_t j = 0; j < n; ++j)
+        {
+            const size_type skip = (j == 0) ? done : 0;
+            iov[j].iov_base = static_cast<char*>(vec[i + j].buffer) + skip;
+            iov[j].iov_len = vec[i + j].bytes - skip;
+        }
+
+        ssize_t rc = (op == request::READ)
+                     ? ::preadv(file_des_, iov, static_cast<int>(n), offset)
+                     : ::pwritev(file_des_, iov, static_cast<int>(n), offset);
+        if (rc <= 0)
+        {
+            STXXL_THROW_ERRNO
+                (io_error,
+                " this=" << this <<
+                " call=" << ((op == request::READ) ?
+                             "::preadv(fd,iov,count,offset)" :
+                             "::pwritev(fd,iov,count,offset)") <<
+                " path=" << filename_ <<
+                " fd=" << file_des_ <<
+                " offset=" << offset <<
+                " count=" << n <<
+                " bytes=" << bytes <<
+                " op=" << ((op == request::READ) ? "READ" : "WRITE") <<
+                " rc=" << rc);
+        }
+        offset += rc;
+
+        size_type left = static_cast<size_type>(rc);
+        while (left > 0)
+        {
+            const size_type rest = vec[i].bytes - done;
+            if (left < rest) {
+                done += left;
+                break;
+            }
+            left -= rest;
+            done = 0;
+            ++i;
+        }
+
+        if (op == request::READ && i < count && offset == this->_size())
+        {
+            // read request extends past end-of-file
+            // fill reminder with zeroes
+            memset(static_cast<char*>(vec[i].buffer) + done, 0, vec[i].bytes - done);
+            for (++i; i < count; ++i)
+                memset(vec[i].buffer, 0, vec[i].bytes);
+        }
+    }
+#else
+    file::serve_vectored(vec, count, offset, op);
+#endif
+}
+
 const char* syscall_file::io_type() const
 {
     return "syscall";
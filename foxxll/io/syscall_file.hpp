@@ -26,7 +26,9 @@ namespace foxxll {
 //! \addtogroup fileimpl
 //! \{
 
-//! Implementation of file based on UNIX syscalls.
+//! Implementation of file based on UNIX syscalls. Requests are served with
+//! positional pread()/pwrite() where available, so several queue workers can
+//! transfer to and from the same file concurrently.
 class syscall_file final : public ufs_file_base, public disk_queued_file
 {
 public:
@@ -51,6 +53,10 @@ public:
     void serve(void* buffer, offset_type offset, size_type bytes,
                request::read_or_write op) final;
 
+    //! Transfers all buffers with preadv()/pwritev() where available.
+    void serve_vectored(const io_vector* vec, size_t count,
+                        offset_type offset, request::read_or_write op) final;
+
     const char * io_type() const final;
 };
 
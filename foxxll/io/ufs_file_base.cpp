@@ -22,8 +22,241 @@
 #include <foxxll/io/ufs_file_base.hpp>
 #include <foxxll/verbose.hpp>
 
+#if defined(__linux__)
+  #include <linux/falloc.h>
+  #include <linux/fs.h>
+  #include <sys/ioctl.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <thread>
+
 namespace foxxll {
 
+//! Collects discarded regions of a ufs_file_base, coalesces adjacent ones,
+//! and releases them in the background at a limited rate. Writes cancel
+//! overlapping pending regions, since those may have been reallocated.
+class ufs_file_base::discard_worker
+{
+    //! pending regions, offset -> size
+    using region_map_type = std::map<uint64_t, uint64_t>;
+
+    //! wait for further adjacent discards before releasing
+    static constexpr std::chrono::milliseconds batch_delay { 10 };
+    //! largest region released by one call
+    static constexpr uint64_t max_region = uint64_t(64) << 20;
+    //! BLKDISCARD requires ranges aligned to the logical block size
+    static constexpr uint64_t device_alignment = 4096;
+
+    const int file_des_;
+    const bool is_device_;
+    const std::string& filename_;
+    const uint64_t rate_;
+
+    std::mutex mutex_;
+    //! signaled on new regions, finished releases, and termination
+    std::condition_variable cv_;
+
+    region_map_type pending_;
+    //! region being released right now, empty if none
+    uint64_t active_begin_ = 0, active_end_ = 0;
+    bool terminate_ = false;
+
+    std::thread thread_;
+
+    void worker();
+
+    //! release a region, returns false if not supported
+    bool release(uint64_t offset, uint64_t size);
+
+public:
+    discard_worker(int file_des, bool is_device, const std::string& filename,
+                   uint64_t rate)
+        : file_des_(file_des), is_device_(is_device), filename_(filename),
+          rate_(rate), thread_(&discard_worker::worker, this)
+    { }
+
+    //! stop thread, pending regions are dropped
+    ~discard_worker()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            terminate_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    //! queue region for release
+    void add(uint64_t offset, uint64_t size)
+    {
+        uint64_t end = offset + size;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (terminate_)
+            return;
+
+        bool was_empty = pending_.empty();
+
+        // merge with touching or overlapping neighbors
+        region_map_type::iterator it = pending_.upper_bound(offset);
+        if (it != pending_.begin())
+        {
+            region_map_type::iterator pred = std::prev(it);
+            if (pred->first + pred->second >= offset)
+            {
+                offset = pred->first;
+                end = std::max(end, pred->first + pred->second);
+                pending_.erase(pred);
+            }
+        }
+        while (it != pending_.end() && it->first <= end)
+        {
+            end = std::max(end, it->first + it->second);
+            it = pending_.erase(it);
+        }
+        pending_[offset] = end - offset;
+
+        if (was_empty)
+            cv_.notify_one();
+    }
+
+    //! withdraw region from the pending ones and wait until it is not being
+    //! released anymore
+    void cancel(uint64_t offset, uint64_t size)
+    {
+        const uint64_t end = offset + size;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        while (active_begin_ < end && offset < active_end_)
+            cv_.wait(lock);
+
+        region_map_type::iterator it = pending_.upper_bound(offset);
+        if (it != pending_.begin())
+            --it;
+        while (it != pending_.end() && it->first < end)
+        {
+            const uint64_t r_begin = it->first, r_end = it->first + it->second;
+            if (r_end <= offset) {
+                ++it;
+                continue;
+            }
+
+            it = pending_.erase(it);
+            // keep the parts outside the written region
+            if (r_begin < offset)
+                pending_[r_begin] = offset - r_begin;
+            if (r_end > end)
+                pending_[end] = r_end - end;
+        }
+    }
+};
+
+constexpr std::chrono::milliseconds ufs_file_base::discard_worker::batch_delay;
+constexpr uint64_t ufs_file_base::discard_worker::max_region;
+constexpr uint64_t ufs_file_base::discard_worker::device_alignment;
+
+void ufs_file_base::discard_worker::worker()
+{
+    using clock = std::chrono::steady_clock;
+    clock::time_point next = clock::now();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!terminate_)
+    {
+        if (pending_.empty())
+        {
+            cv_.wait(lock);
+            if (terminate_ || pending_.empty())
+                continue;
+
+            // give adjacent discards of the same deletion a chance to merge
+            cv_.wait_for(lock, batch_delay, [this]() { return terminate_; });
+            continue;
+        }
+
+        // release the lowest region, or a piece of it
+        region_map_type::iterator it = pending_.begin();
+        const uint64_t offset = it->first;
+        const uint64_t size = std::min(it->second, max_region);
+        if (size < it->second)
+            pending_[offset + size] = it->second - size;
+        pending_.erase(it);
+
+        active_begin_ = offset, active_end_ = offset + size;
+        lock.unlock();
+
+        bool supported = release(offset, size);
+
+        lock.lock();
+        active_begin_ = active_end_ = 0;
+        cv_.notify_all();
+
+        if (!supported)
+        {
+            STXXL_ERRMSG("discard is not supported on path=" << filename_ <<
+                         ", freed regions are kept allocated.");
+            terminate_ = true;
+            pending_.clear();
+            break;
+        }
+
+        // rate limit: the region costs size / rate seconds
+        next = std::max(next, clock::now()) +
+               std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(size) / rate_));
+        cv_.wait_until(lock, next, [this]() { return terminate_; });
+    }
+}
+
+bool ufs_file_base::discard_worker::release(uint64_t offset, uint64_t size)
+{
+    STXXL_VERBOSE2("discard path=" << filename_ << " " << offset << " + " << size);
+
+#if defined(__linux__) && defined(BLKDISCARD) && defined(FALLOC_FL_PUNCH_HOLE)
+    int rc;
+    if (is_device_)
+    {
+        uint64_t range[2];
+        range[0] = (offset + device_alignment - 1) / device_alignment * device_alignment;
+        uint64_t end = (offset + size) / device_alignment * device_alignment;
+        if (range[0] >= end)
+            return true;
+        range[1] = end - range[0];
+
+        rc = ::ioctl(file_des_, BLKDISCARD, &range);
+    }
+    else
+    {
+        rc = ::fallocate(file_des_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                         static_cast<off_t>(offset), static_cast<off_t>(size));
+    }
+
+    if (rc == 0)
+        return true;
+    if (errno == EOPNOTSUPP || errno == ENOTTY || errno == ENOSYS)
+        return false;
+
+    // the region just stays allocated
+    STXXL_ERRMSG("discard failed on path=" << filename_ <<
+                 " offset=" << offset << " size=" << size <<
+                 " error=" << strerror(errno));
+    return true;
+#else
+    STXXL_UNUSED(offset);
+    STXXL_UNUSED(size);
+    return false;
+#endif
+}
+
+constexpr uint64_t ufs_file_base::default_discard_rate;
+
 const char* ufs_file_base::io_type() const
 {
     return "ufs_base";
@@ -126,6 +359,29 @@ ufs_file_base::~ufs_file_base()
     close();
 }
 
+void ufs_file_base::enable_discard(uint64_t rate)
+{
+    std::unique_lock<std::mutex> fd_lock(fd_mutex_);
+
+    if (file_des_ == -1 || (mode_ & RDONLY) || discard_worker_)
+        return;
+
+    discard_worker_.reset(
+        new discard_worker(file_des_, is_device_, filename_,
+                           rate ? rate : default_discard_rate));
+}
+
+void ufs_file_base::discard(offset_type offset, offset_type size)
+{
+    if (discard_worker_ && size != 0)
+        discard_worker_->add(offset, size);
+}
+
+void ufs_file_base::_cancel_discard(offset_type offset, offset_type size)
+{
+    discard_worker_->cancel(offset, size);
+}
+
 void ufs_file_base::_after_open()
 {
     // stat file type
@@ -166,6 +422,9 @@ void ufs_file_base::_after_open()
 
 void ufs_file_base::close()
 {
+    // stop releasing regions before the descriptor becomes invalid
+    discard_worker_.reset();
+
     std::unique_lock<std::mutex> fd_lock(fd_mutex_);
 
     if (file_des_ == -1)
@@ -197,7 +456,8 @@ file::offset_type ufs_file_base::_size()
 {
     // We use lseek SEEK_END to find the file size. This works for raw devices
     // (where stat() returns zero), and we need not reset the position because
-    // serve() always lseek()s before read/write.
+    // serve() either uses positional I/O or always lseek()s before
+    // read/write.
 
     off_t rc = ::lseek(file_des_, 0, SEEK_END);
     if (rc < 0)
@@ -20,6 +20,7 @@
 
 #include <foxxll/io/file.hpp>
 
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -37,16 +38,30 @@ protected:
     int mode_;            // open mode
     const std::string filename_;
     bool is_device_;      //!< is special device node
+
+    //! punches holes for discarded regions in the background
+    class discard_worker;
+    std::unique_ptr<discard_worker> discard_worker_;
+
     ufs_file_base(const std::string& filename, int mode);
     void _after_open();
     offset_type _size();
     void _set_size(offset_type newsize);
     void close();
 
+    //! withdraw pending discards overlapping a region, waiting for one in
+    //! progress. Must be called before writing to the region.
+    void cancel_discard(offset_type offset, offset_type size)
+    {
+        if (discard_worker_)
+            _cancel_discard(offset, size);
+    }
+    void _cancel_discard(offset_type offset, offset_type size);
+
 public:
     ~ufs_file_base();
     offset_type size() final;
-    void set_size(offset_type newsize) final;
+    void set_size(offset_type newsize) override;
     void lock() final;
     const char * io_type() const override;
     void close_remove() final;
@@ -54,6 +69,19 @@ public:
     void unlink();
     //! return true if file is special device node
     bool is_device() const;
+
+    //! default rate limit of discards in bytes per second
+    static constexpr uint64_t default_discard_rate = uint64_t(4) << 30;
+
+    //! Let discard() release the region to the file system by punching a
+    //! hole, or to the device by BLKDISCARD (TRIM) for raw devices. Regions
+    //! are coalesced and released by a background thread, issuing at most
+    //! \c rate bytes per second. Disabled again if the file system or device
+    //! does not support it.
+    void enable_discard(uint64_t rate = default_discard_rate);
+
+    //! queue region for release if enable_discard() was called.
+    void discard(offset_type offset, offset_type size) override;
 };
 
 //! \}
@@ -183,6 +183,26 @@ std::ostream& operator << (std::ostream& s, const BID<BlockSize>& bid)
 template <size_t BlockSize>
 using BIDArray = tlx::simple_vector<BID<BlockSize> >;
 
+//! Hash function object for BIDs, to index blocks in hash tables. Offsets
+//! are multiples of the block size, hence all bits are mixed, such that the
+//! low bits used by power-of-two tables are well distributed.
+struct bid_hash
+{
+    template <size_t BlockSize>
+    size_t operator () (const BID<BlockSize>& bid) const
+    {
+        uint64_t h = uint64_t(reinterpret_cast<uintptr_t>(bid.storage)) ^
+                     (bid.offset * 0x9E3779B97F4A7C15ull);
+        // finalizer of MurmurHash3
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+};
+
 //! \}
 
 } // namespace foxxll
@@ -0,0 +1,179 @@
+/***************************************************************************
+ *  foxxll/mng/bid_table.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#ifndef STXXL_MNG_BID_TABLE_HEADER
+#define STXXL_MNG_BID_TABLE_HEADER
+
+#include <foxxll/mng/bid.hpp>
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace foxxll {
+
+//! \addtogroup mnglayer
+//! \{
+
+//! Hash table from BIDs to values with open addressing and linear probing,
+//! stored in one array. Inserting and erasing does not allocate unless the
+//! table grows, which reserve() avoids. The table is kept at most half full.
+template <typename BidType, typename ValueType>
+class bid_table
+{
+public:
+    using bid_type = BidType;
+    using value_type = ValueType;
+
+private:
+    struct slot
+    {
+        bid_type bid;
+        value_type value;
+        bool used = false;
+    };
+
+    //! number of slots is zero or a power of two
+    std::vector<slot> slots_;
+    size_t size_ = 0;
+
+    size_t mask() const { return slots_.size() - 1; }
+
+    size_t home(const bid_type& bid) const
+    {
+        return bid_hash()(bid) & mask();
+    }
+
+    //! index of the slot holding bid, or of the empty slot ending its probe
+    //! sequence; the table must not be empty
+    size_t probe(const bid_type& bid) const
+    {
+        size_t i = home(bid);
+        while (slots_[i].used && slots_[i].bid != bid)
+            i = (i + 1) & mask();
+        return i;
+    }
+
+    void rehash(size_t num_slots)
+    {
+        std::vector<slot> old(num_slots);
+        old.swap(slots_);
+        for (slot& s : old)
+        {
+            if (!s.used) continue;
+            slot& t = slots_[probe(s.bid)];
+            t.bid = s.bid;
+            t.value = std::move(s.value);
+            t.used = true;
+        }
+    }
+
+public:
+    bid_table() = default;
+
+    //! Number of entries.
+    size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    //! Make room for n entries without growing.
+    void reserve(size_t n)
+    {
+        size_t num_slots = slots_.empty() ? 16 : slots_.size();
+        while (num_slots < 2 * n)
+            num_slots *= 2;
+        if (num_slots != slots_.size())
+            rehash(num_slots);
+    }
+
+    //! Returns the value of bid, or nullptr.
+    value_type * find(const bid_type& bid)
+    {
+        if (size_ == 0)
+            return nullptr;
+        slot& s = slots_[probe(bid)];
+        return s.used ? &s.value : nullptr;
+    }
+
+    //! Returns whether bid has a value.
+    bool contains(const bid_type& bid) const
+    {
+        return size_ != 0 && slots_[probe(bid)].used;
+    }
+
+    //! Returns the value of bid, inserting a default value if missing.
+    value_type& operator [] (const bid_type& bid)
+    {
+        reserve(size_ + 1);
+        slot& s = slots_[probe(bid)];
+        if (!s.used)
+        {
+            s.bid = bid;
+            s.value = value_type();
+            s.used = true;
+            ++size_;
+        }
+        return s.value;
+    }
+
+    //! Removes bid, returns whether it was present.
+    bool erase(const bid_type& bid)
+    {
+        if (size_ == 0)
+            return false;
+
+        size_t i = probe(bid);
+        if (!slots_[i].used)
+            return false;
+
+        // backward shift deletion: move later entries of the probe sequence
+        // into the gap, unless they would move before their home slot
+        for (size_t j = (i + 1) & mask(); slots_[j].used; j = (j + 1) & mask())
+        {
+            size_t h = home(slots_[j].bid);
+            if (((j - h) & mask()) >= ((j - i) & mask()))
+            {
+                slots_[i].bid = slots_[j].bid;
+                slots_[i].value = std::move(slots_[j].value);
+                i = j;
+            }
+        }
+        slots_[i].used = false;
+        slots_[i].value = value_type();
+        --size_;
+        return true;
+    }
+
+    //! Call f(bid, value) for all entries, in no particular order.
+    template <typename Functor>
+    void for_each(Functor f)
+    {
+        for (slot& s : slots_)
+        {
+            if (s.used)
+                f(s.bid, s.value);
+        }
+    }
+
+    void swap(bid_table& obj)
+    {
+        std::swap(slots_, obj.slots_);
+        std::swap(size_, obj.size_);
+    }
+};
+
+//! \}
+
+} // namespace foxxll
+
+#endif // !STXXL_MNG_BID_TABLE_HEADER
+// vim: et:ts=4:sw=4
@@ -18,17 +18,95 @@
 #include <foxxll/io/create_file.hpp>
 #include <foxxll/io/disk_queues.hpp>
 #include <foxxll/io/file.hpp>
+#include <foxxll/io/request_trace.hpp>
+#include <foxxll/io/stats_sampler.hpp>
 #include <foxxll/mng/config.hpp>
 #include <foxxll/mng/disk_block_allocator.hpp>
 #include <foxxll/verbose.hpp>
 
+#include <algorithm>
 #include <cstddef>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace foxxll {
 
 class io_error;
 
+//! protects block_manager::caches_ and bid_cache::owner_ against concurrent
+//! thread exit and block_manager destruction.
+static std::mutex s_cache_registry_mutex;
+
+//! Per-thread cache of pre-allocated blocks, keyed by disk and block size.
+//! Only its own thread takes and puts blocks. Other threads return the blocks
+//! to the allocators if their allocation fails, and so does the destruction
+//! of the block_manager, which must not happen while threads still allocate
+//! blocks.
+class block_manager::bid_cache
+{
+public:
+    struct entry
+    {
+        size_t   disk;
+        uint64_t size;
+        //! maximum number of cached blocks
+        size_t   capacity;
+        std::vector<uint64_t> offsets;
+    };
+
+    //! cached bytes upper bound per disk and block size
+    static constexpr uint64_t max_bytes = 16 * 1024 * 1024;
+    //! cached blocks upper bound per disk and block size
+    static constexpr size_t max_blocks = 16;
+
+    std::vector<entry> entries_;
+
+    //! taken by the owning thread on every use, uncontended unless another
+    //! thread releases the cache
+    std::mutex mutex_;
+
+    //! total bytes held by this cache, read by block_manager::free_bytes()
+    std::atomic<uint64_t> bytes_ { 0 };
+
+    //! block_manager the blocks belong to
+    std::atomic<block_manager*> owner_ { nullptr };
+
+    //! find or create the entry for a disk and block size, returns nullptr if
+    //! blocks of this size are too large for caching
+    entry * get(size_t disk, uint64_t size)
+    {
+        for (entry& e : entries_) {
+            if (e.disk == disk && e.size == size)
+                return &e;
+        }
+
+        size_t capacity = static_cast<size_t>(
+            std::min<uint64_t>(max_blocks, max_bytes / size));
+        if (capacity < 2)
+            return nullptr;
+
+        entries_.push_back(entry { disk, size, capacity, std::vector<uint64_t>() });
+        entries_.back().offsets.reserve(capacity);
+        return &entries_.back();
+    }
+
+    ~bid_cache()
+    {
+        std::unique_lock<std::mutex> lock(s_cache_registry_mutex);
+        block_manager* owner = owner_;
+        if (owner)
+        {
+            owner->release_cache(this);
+            owner->caches_.erase(
+                std::find(owner->caches_.begin(), owner->caches_.end(), this));
+        }
+    }
+};
+
+constexpr uint64_t block_manager::bid_cache::max_bytes;
+constexpr size_t block_manager::bid_cache::max_blocks;
+
 block_manager::block_manager()
 {
     config* config = config::get_instance();
@@ -70,7 +148,17 @@ block_manager::block_manager()
         total_size += cfg.size;
 
         // create queue for the file.
-        disk_queues::get_instance()->make_queue(disk_files_[i].get());
+        disk_queues::get_instance()->make_queue(
+            disk_files_[i].get(), cfg.queue_length,
+            cfg.elevator, cfg.elevator_max_wait);
+
+        throttle_limits limits;
+        limits.max_read_bw = cfg.max_read_bw;
+        limits.max_write_bw = cfg.max_write_bw;
+        limits.max_iops = cfg.max_iops;
+        if (!limits.unlimited())
+            disk_queues::get_instance()->set_throttle_limits(
+                disk_files_[i]->get_queue_id(), limits);
 
         block_allocators_[i] = new disk_block_allocator(disk_files_[i].get(), cfg);
     }
@@ -81,11 +169,40 @@ block_manager::block_manager()
                   (total_size / (1024 * 1024)) <<
                   " MiB");
     }
+
+    if (!config->stats_sampler_path().empty())
+    {
+        stats_sampler_.reset(new stats_sampler(
+                                 config->stats_sampler_path(),
+                                 config->stats_sampler_interval(),
+                                 stats_sampler::parse_format(config->stats_sampler_format())));
+
+        STXXL_MSG("Writing I/O statistics to '" << config->stats_sampler_path() <<
+                  "' every " << config->stats_sampler_interval() << " ms");
+    }
+
+    if (!config->request_trace_path().empty())
+    {
+        request_trace::get_instance()->start(config->request_trace_path());
+
+        STXXL_MSG("Tracing requests to '" << config->request_trace_path() << "'");
+    }
 }
 
 block_manager::~block_manager()
 {
     STXXL_VERBOSE1("Block manager destructor");
+    stats_sampler_.reset();
+    {
+        // return blocks still cached by running threads
+        std::unique_lock<std::mutex> lock(s_cache_registry_mutex);
+        for (bid_cache* cache : caches_)
+        {
+            release_cache(cache);
+            cache->owner_ = nullptr;
+        }
+        caches_.clear();
+    }
     for (size_t i = ndisks_; i > 0; )
     {
         --i;
@@ -94,10 +211,138 @@ block_manager::~block_manager()
     }
 }
 
-uint64_t block_manager::total_bytes() const
+void block_manager::add_allocation(uint64_t bytes)
+{
+    total_allocation_ += bytes;
+    uint64_t current = (current_allocation_ += bytes);
+
+    uint64_t maximum = maximum_allocation_;
+    while (current > maximum &&
+           !maximum_allocation_.compare_exchange_weak(maximum, current)) { }
+}
+
+block_manager::bid_cache* block_manager::local_cache()
 {
-    std::unique_lock<std::mutex> lock(mutex_);
+    static thread_local bid_cache cache;
 
+    if (cache.owner_ != this)
+    {
+        std::unique_lock<std::mutex> lock(s_cache_registry_mutex);
+        // first use by this thread, or a previous block_manager instance has
+        // been destroyed and has already taken back the cached blocks
+        cache.entries_.clear();
+        cache.bytes_ = 0;
+        cache.owner_ = this;
+        caches_.push_back(&cache);
+    }
+
+    return &cache;
+}
+
+bool block_manager::cached_new_block(size_t disk, uint64_t size, uint64_t& offset)
+{
+    bid_cache* cache = local_cache();
+    std::unique_lock<std::mutex> lock(cache->mutex_);
+    bid_cache::entry* e = cache->get(disk, size);
+    if (!e)
+        return false;
+
+    if (e->offsets.empty())
+    {
+        // refill half of the capacity in one allocation
+        size_t count = e->capacity / 2;
+        if (!block_allocators_[disk]->has_available_space(count * size))
+            return false;
+
+        std::vector<BID<0> > bids(count, BID<0>(disk_files_[disk].get(), 0, size));
+        block_allocators_[disk]->new_blocks(bids.begin(), bids.end());
+
+        // hand out in ascending order, blocks are taken from the back
+        for (size_t i = count; i > 0; --i)
+            e->offsets.push_back(bids[i - 1].offset);
+        cache->bytes_ += count * size;
+    }
+
+    offset = e->offsets.back();
+    e->offsets.pop_back();
+    cache->bytes_ -= size;
+    return true;
+}
+
+bool block_manager::cached_delete_block(size_t disk, uint64_t offset, uint64_t size)
+{
+    bid_cache* cache = local_cache();
+    std::unique_lock<std::mutex> lock(cache->mutex_);
+    bid_cache::entry* e = cache->get(disk, size);
+    if (!e || e->offsets.size() >= e->capacity)
+        return false;
+
+    e->offsets.push_back(offset);
+    cache->bytes_ += size;
+    return true;
+}
+
+void block_manager::release_cache(bid_cache* cache)
+{
+    std::unique_lock<std::mutex> lock(cache->mutex_);
+    for (bid_cache::entry& e : cache->entries_)
+    {
+        for (uint64_t offset : e.offsets)
+        {
+            block_allocators_[e.disk]->delete_block(
+                BID<0>(disk_files_[e.disk].get(), offset, e.size));
+        }
+        e.offsets.clear();
+    }
+    cache->bytes_ = 0;
+}
+
+void block_manager::release_all_caches()
+{
+    std::unique_lock<std::mutex> lock(s_cache_registry_mutex);
+    for (bid_cache* cache : caches_)
+        release_cache(cache);
+}
+
+void block_manager::delete_extents(std::vector<extent>& extents)
+{
+    std::sort(extents.begin(), extents.end(),
+              [](const extent& a, const extent& b) {
+                  return a.disk < b.disk || (a.disk == b.disk && a.offset < b.offset);
+              });
+
+    uint64_t bytes = 0;
+    disk_block_allocator::region_list_type regions;
+
+    for (size_t i = 0; i < extents.size(); )
+    {
+        const size_t disk = extents[i].disk;
+
+        regions.clear();
+        for ( ; i < extents.size() && extents[i].disk == disk; ++i)
+        {
+            const extent& e = extents[i];
+            bytes += e.size;
+
+            if (!regions.empty() &&
+                regions.back().first + regions.back().second == e.offset)
+                regions.back().second += e.size;
+            else
+                regions.emplace_back(e.offset, e.size);
+        }
+
+        // discard before the regions can be handed out again
+        for (const auto& r : regions)
+            disk_files_[disk]->discard(r.first, r.second);
+
+        block_allocators_[disk]->delete_regions(regions);
+    }
+
+    current_allocation_ -= bytes;
+}
+
+uint64_t block_manager::total_bytes() const
+{
     uint64_t total = 0;
 
     for (size_t i = 0; i < ndisks_; ++i)
@@ -108,31 +353,31 @@ uint64_t block_manager::total_bytes() const
 
 uint64_t block_manager::free_bytes() const
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-
     uint64_t total = 0;
 
     for (size_t i = 0; i < ndisks_; ++i)
         total += block_allocators_[i]->free_bytes();
 
+    // blocks cached by threads are free as well
+    std::unique_lock<std::mutex> lock(s_cache_registry_mutex);
+    for (const bid_cache* cache : caches_)
+        total += cache->bytes_;
+
     return total;
 }
 
 uint64_t block_manager::total_allocation() const
 {
-    std::unique_lock<std::mutex> lock(mutex_);
     return total_allocation_;
 }
 
 uint64_t block_manager::current_allocation() const
 {
-    std::unique_lock<std::mutex> lock(mutex_);
     return current_allocation_;
 }
 
 uint64_t block_manager::maximum_allocation() const
 {
-    std::unique_lock<std::mutex> lock(mutex_);
     return maximum_allocation_;
 }
 
@@ -30,9 +30,10 @@
 #include <tlx/simple_vector.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdlib>
+#include <iterator>
 #include <memory>
-#include <mutex>
 #include <string>
 #include <vector>
 
@@ -42,6 +43,8 @@
 
 namespace foxxll {
 
+class stats_sampler;
+
 //! \addtogroup mnglayer
 //! \{
 
@@ -50,6 +53,11 @@ namespace foxxll {
  *
  * Manages allocation and deallocation of blocks in multiple/single disk setting
  * \remarks is a singleton
+ *
+ * All methods are thread-safe and only lock the disk_block_allocator of the
+ * disks involved. Each thread additionally caches a few pre-allocated blocks
+ * per disk and block size, from which single-block allocations of fixed-size
+ * BIDs are served, and to which deleted blocks are returned.
  */
 class block_manager : public singleton<block_manager>
 {
@@ -94,7 +102,11 @@ public:
 
     //! Deallocates blocks.
     //!
-    //! Deallocates blocks in the range [ \b bid_begin, \b bid_end)
+    //! Deallocates blocks in the range [ \b bid_begin, \b bid_end). Adjacent
+    //! blocks are merged into extents, which are discarded and returned to
+    //! the disk allocators at once. Unlike delete_block(), this bypasses the
+    //! calling thread's cache of free blocks, which serves single-block
+    //! allocations only.
     //! \param bid_begin iterator object of \b bid_iterator concept
     //! \param bid_end iterator object of \b bid_iterator concept
     template <typename BIDIterator>
@@ -141,19 +153,58 @@ private:
     tlx::simple_vector<disk_block_allocator*> block_allocators_;
 
     //! total requested allocation in bytes
-    uint64_t total_allocation_ = 0;
+    std::atomic<uint64_t> total_allocation_ { 0 };
 
     //! currently allocated bytes
-    uint64_t current_allocation_ = 0;
+    std::atomic<uint64_t> current_allocation_ { 0 };
 
     //! maximum number of bytes allocated during program run.
-    uint64_t maximum_allocation_ = 0;
+    std::atomic<uint64_t> maximum_allocation_ { 0 };
+
+    //! periodic writer of I/O statistics, if configured
+    std::unique_ptr<stats_sampler> stats_sampler_;
 
     //! private construction from singleton
     block_manager();
 
-    //! protect internal data structures
-    mutable std::mutex mutex_;
+    //! update statistics for allocated bytes
+    void add_allocation(uint64_t bytes);
+
+    //! per-thread cache of pre-allocated blocks, see block_manager.cpp
+    class bid_cache;
+
+    //! caches of all threads, protected by a global mutex
+    std::vector<bid_cache*> caches_;
+
+    //! return the calling thread's cache
+    bid_cache * local_cache();
+
+    //! take a block of the given size on disk from the calling thread's
+    //! cache, which is refilled from the disk's allocator if empty.
+    //! \return false if the block size is not cached or the disk is full
+    bool cached_new_block(size_t disk, uint64_t size, uint64_t& offset);
+
+    //! put a deleted block into the calling thread's cache.
+    //! \return false if the cache is full or the size is not cached
+    bool cached_delete_block(size_t disk, uint64_t offset, uint64_t size);
+
+    //! return all blocks of a cache to the disk allocators
+    void release_cache(bid_cache* cache);
+
+    //! return the blocks cached by all threads to the disk allocators, before
+    //! an allocation the free space of a disk does not cover
+    void release_all_caches();
+
+    //! a managed block to be deallocated
+    struct extent
+    {
+        size_t   disk;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    //! deallocate blocks sorted by disk and offset, merging adjacent ones
+    void delete_extents(std::vector<extent>& extents);
 };
 
 template <typename DiskAssignFunctor, typename BIDIterator>
@@ -162,8 +213,6 @@ void block_manager::new_blocks(
     BIDIterator bid_begin, BIDIterator bid_end,
     size_t alloc_offset)
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-
     using BIDType = typename std::iterator_traits<BIDIterator>::value_type;
 
     // choose disks for each block, sum up bytes allocated on a disk
@@ -214,14 +263,35 @@ void block_manager::new_blocks(
     for (size_t d = 0; d < ndisks_; ++d)
     {
         if (disk_blocks[d] == 0) continue;
-        bids.resize(disk_blocks[d]);
 
         std::vector<size_t>& bid_perm = disk_out[d];
 
+        // single fixed-size blocks are served from the thread's cache, larger
+        // requests are allocated contiguously
+        if (BIDType::t_size != 0 && disk_blocks[d] == 1)
+        {
+            BIDType& out = bid_begin[bid_perm[0]];
+            uint64_t offset;
+            if (cached_new_block(d, out.size, offset))
+            {
+                out.storage = disk_files_[d].get();
+                out.offset = offset;
+                STXXL_VERBOSE_BLOCK_LIFE_CYCLE("BLC:new    " << FMT_BID(out));
+                add_allocation(out.size);
+                continue;
+            }
+        }
+
+        bids.resize(disk_blocks[d]);
+
         // collect bids from output (due to size field for BID<0>)
         for (size_t i = 0; i < disk_blocks[d]; ++i)
             bids[i] = bid_begin[bid_perm[i]];
 
+        // the free space may be held by the caches of other threads
+        if (!block_allocators_[d]->has_available_space(disk_bytes[d]))
+            release_all_caches();
+
         // let block_allocator fill in offset fields
         block_allocators_[d]->new_blocks(bids);
 
@@ -232,19 +302,14 @@ void block_manager::new_blocks(
             STXXL_VERBOSE_BLOCK_LIFE_CYCLE("BLC:new    " << FMT_BID(bids[i]));
             bid_begin[bid_perm[i]] = bids[i];
 
-            total_allocation_ += bids[i].size;
-            current_allocation_ += bids[i].size;
+            add_allocation(bids[i].size);
         }
     }
-
-    maximum_allocation_ = std::max(maximum_allocation_, current_allocation_);
 }
 
 template <size_t BlockSize>
 void block_manager::delete_block(const BID<BlockSize>& bid)
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-
     if (!bid.valid()) {
         //STXXL_MSG("Warning: invalid block to be deleted.");
         return;
@@ -253,18 +318,36 @@ void block_manager::delete_block(const BID<BlockSize>& bid)
         return;  // self managed disk
     STXXL_VERBOSE_BLOCK_LIFE_CYCLE("BLC:delete " << FMT_BID(bid));
     assert(bid.storage->get_allocator_id() >= 0);
-    block_allocators_[bid.storage->get_allocator_id()]->delete_block(bid);
-    disk_files_[bid.storage->get_allocator_id()]->discard(bid.offset, bid.size);
+    const size_t disk = static_cast<size_t>(bid.storage->get_allocator_id());
+
+    // discard before the region can be handed out again
+    disk_files_[disk]->discard(bid.offset, bid.size);
 
-    current_allocation_ -= BlockSize;
+    if (BlockSize == 0 || !cached_delete_block(disk, bid.offset, bid.size))
+        block_allocators_[disk]->delete_block(bid);
+
+    current_allocation_ -= bid.size;
 }
 
 template <typename BIDIterator>
 void block_manager::delete_blocks(
     const BIDIterator& bid_begin, const BIDIterator& bid_end)
 {
+    std::vector<extent> extents;
+    extents.reserve(std::distance(bid_begin, bid_end));
+
     for (BIDIterator it = bid_begin; it != bid_end; ++it)
-        delete_block(*it);
+    {
+        if (!it->valid() || !it->is_managed())
+            continue;
+        STXXL_VERBOSE_BLOCK_LIFE_CYCLE("BLC:delete " << FMT_BID(*it));
+        assert(it->storage->get_allocator_id() >= 0);
+        extents.push_back(
+            extent { static_cast<size_t>(it->storage->get_allocator_id()),
+                     it->offset, it->size });
+    }
+
+    delete_extents(extents);
 }
 
 // in bytes
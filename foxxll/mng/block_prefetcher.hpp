@@ -16,10 +16,14 @@
 #define STXXL_MNG_BLOCK_PREFETCHER_HEADER
 
 #include <foxxll/common/onoff_switch.hpp>
+#include <foxxll/common/timer.hpp>
+#include <foxxll/io/disk_queues.hpp>
 #include <foxxll/io/iostats.hpp>
+#include <foxxll/io/mapped_block.hpp>
 #include <foxxll/io/request.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <queue>
 #include <vector>
 
@@ -52,6 +56,10 @@ public:
 //!
 //! \c block_prefetcher overlaps I/Os with consumption of read data.
 //! Utilizes optimal asynchronous prefetch scheduling (by Peter Sanders et.al.)
+//!
+//! If enabled, blocks of files that reside in memory (see
+//! file::try_map_block()) are not copied into the prefetch buffers. The
+//! returned block then points into the file's memory and must not be modified.
 template <typename BlockType, typename BidIteratorType>
 class block_prefetcher
 {
@@ -73,7 +81,7 @@ protected:
 
     const size_t nreadblocks;
 
-    block_type* read_buffers;
+    registered_blocks<block_type> read_buffers;
     request_ptr* read_reqs;
     bid_type* read_bids;
 
@@ -82,19 +90,71 @@ protected:
 
     completion_handler do_after_fetch;
 
+    //! whether blocks may be consumed from file memory directly
+    const bool map_blocks;
+    //! views of blocks mapped instead of read, per buffer
+    mapped_block* read_views;
+
+    //! start fetching block iblock of the consumption sequence into buffer
+    void fetch(size_t ibuffer, size_t iblock)
+    {
+        assert(iblock < seq_length);
+        assert(!completed[iblock].is_on());
+
+        pref_buffer[iblock] = ibuffer;
+        read_bids[ibuffer] = *(consume_seq_begin + iblock);
+
+        if (map_blocks && !do_after_fetch)
+        {
+            mapped_block& view = read_views[ibuffer];
+            view = read_bids[ibuffer].storage->try_map_block(
+                read_bids[ibuffer].offset, block_type::raw_size);
+
+            if (view.valid() &&
+                reinterpret_cast<uintptr_t>(view.data()) % alignof(block_type) == 0)
+            {
+                STXXL_VERBOSE1("block_prefetcher: mapped block " << iblock <<
+                               " @ " << read_bids[ibuffer]);
+                completed[iblock].on();
+                return;
+            }
+            view.reset();
+        }
+
+        scoped_priority_class priority(request::PREFETCH);
+        read_reqs[ibuffer] = read_buffers[ibuffer].read(
+            read_bids[ibuffer],
+            set_switch_handler(*(completed + iblock), do_after_fetch));
+    }
+
     block_type * wait(size_t iblock)
     {
         STXXL_VERBOSE1("block_prefetcher: waiting block " << iblock);
         {
             stats::scoped_wait_timer wait_timer(stats::WAIT_OP_READ);
 
-            completed[iblock].wait_for_on();
+            // serve the read first if the wait takes a while, mapped blocks
+            // are complete already
+            if (!completed[iblock].wait_for_on(request::boost_delay()) &&
+                read_reqs[pref_buffer[iblock]]->boost())
+            {
+                const double start = timestamp();
+                completed[iblock].wait_for_on();
+                stats::get_instance()->boosted_wait_finished(timestamp() - start);
+            }
+            else
+            {
+                completed[iblock].wait_for_on();
+            }
         }
         STXXL_VERBOSE1("block_prefetcher: finished waiting block " << iblock);
         size_t ibuffer = pref_buffer[iblock];
         STXXL_VERBOSE1("block_prefetcher: returning buffer " << ibuffer);
         assert(ibuffer >= 0 && ibuffer < nreadblocks);
-        return (read_buffers + ibuffer);
+        if (read_views[ibuffer].valid())
+            return reinterpret_cast<block_type*>(
+                const_cast<void*>(read_views[ibuffer].data()));
+        return &read_buffers[ibuffer];
     }
 
 public:
@@ -105,12 +165,16 @@ public:
     //!        the indices of the blocks in the consumption sequence
     //! \param _prefetch_buf_size amount of prefetch buffers to use
     //! \param do_after_fetch unknown
+    //! \param map_blocks consume blocks from file memory directly if possible,
+    //!        the returned blocks are then read-only. Ignored if do_after_fetch
+    //!        is given.
     block_prefetcher(
         bid_iterator_type _cons_begin,
         bid_iterator_type _cons_end,
         size_t* _pref_seq,
         size_t _prefetch_buf_size,
-        completion_handler do_after_fetch = completion_handler())
+        completion_handler do_after_fetch = completion_handler(),
+        bool map_blocks = false)
         : consume_seq_begin(_cons_begin),
           consume_seq_end(_cons_end),
           seq_length(_cons_end - _cons_begin),
@@ -118,16 +182,18 @@ public:
           nextread(std::min(_prefetch_buf_size, seq_length)),
           nextconsume(0),
           nreadblocks(nextread),
-          do_after_fetch(do_after_fetch)
+          read_buffers(nreadblocks),
+          do_after_fetch(do_after_fetch),
+          map_blocks(map_blocks)
     {
         STXXL_VERBOSE1("block_prefetcher: seq_length=" << seq_length);
         STXXL_VERBOSE1("block_prefetcher: _prefetch_buf_size=" << _prefetch_buf_size);
         assert(seq_length > 0);
         assert(_prefetch_buf_size > 0);
         size_t i;
-        read_buffers = new block_type[nreadblocks];
         read_reqs = new request_ptr[nreadblocks];
         read_bids = new bid_type[nreadblocks];
+        read_views = new mapped_block[nreadblocks];
         pref_buffer = new size_t[seq_length];
 
         std::fill(pref_buffer, pref_buffer + seq_length, -1);
@@ -137,15 +203,10 @@ public:
         for (i = 0; i < nreadblocks; ++i)
         {
             assert(prefetch_seq[i] < seq_length);
-            read_bids[i] = *(consume_seq_begin + prefetch_seq[i]);
             STXXL_VERBOSE1("block_prefetcher: reading block " << i <<
                            " prefetch_seq[" << i << "]=" << prefetch_seq[i] <<
-                           " @ " << &read_buffers[i] <<
-                           " @ " << read_bids[i]);
-            read_reqs[i] = read_buffers[i].read(
-                read_bids[i],
-                set_switch_handler(*(completed + prefetch_seq[i]), do_after_fetch));
-            pref_buffer[prefetch_seq[i]] = i;
+                           " @ " << &read_buffers[i]);
+            fetch(i, prefetch_seq[i]);
         }
     }
 
@@ -168,12 +229,18 @@ public:
     //! \return \c false if there are no blocks to prefetch left, \c true if consumption sequence is not emptied
     bool block_consumed(block_type*& buffer)
     {
-        size_t ibuffer = buffer - read_buffers;
+        assert(nextconsume > 0);
+        size_t ibuffer = pref_buffer[nextconsume - 1];
         STXXL_VERBOSE1("block_prefetcher: buffer " << ibuffer << " consumed");
+        assert(buffer == (read_views[ibuffer].valid()
+                          ? static_cast<const void*>(read_views[ibuffer].data())
+                          : static_cast<const void*>(&read_buffers[ibuffer])));
+        STXXL_UNUSED(buffer);
         if (read_reqs[ibuffer].valid())
             read_reqs[ibuffer]->wait();
 
         read_reqs[ibuffer] = nullptr;
+        read_views[ibuffer].reset();
 
         if (nextread < seq_length)
         {
@@ -181,14 +248,7 @@ public:
             size_t next_2_prefetch = prefetch_seq[nextread++];
             STXXL_VERBOSE1("block_prefetcher: prefetching block " << next_2_prefetch);
 
-            assert(next_2_prefetch < seq_length);
-            assert(!completed[next_2_prefetch].is_on());
-
-            pref_buffer[next_2_prefetch] = ibuffer;
-            read_bids[ibuffer] = *(consume_seq_begin + next_2_prefetch);
-            read_reqs[ibuffer] = read_buffers[ibuffer].read(
-                read_bids[ibuffer],
-                set_switch_handler(*(completed + next_2_prefetch), do_after_fetch));
+            fetch(ibuffer, next_2_prefetch);
         }
 
         if (nextconsume >= seq_length)
@@ -221,9 +281,9 @@ public:
 
         delete[] read_reqs;
         delete[] read_bids;
+        delete[] read_views;
         delete[] completed;
         delete[] pref_buffer;
-        delete[] read_buffers;
     }
 };
 
@@ -66,7 +66,11 @@ public:
     //! \param begin \c bid_iterator pointing to the first block of the stream
     //! \param end \c bid_iterator pointing to the ( \b last + 1 ) block of the stream
     //! \param nbuffers number of buffers for internal use
-    buf_istream_reverse(bid_iterator_type begin, bid_iterator_type end, size_t nbuffers)
+    //! \param map_blocks read blocks of files residing in memory without
+    //!        copying. Records must then not be modified through the returned
+    //!        references, and no write to the blocks may be pending.
+    buf_istream_reverse(bid_iterator_type begin, bid_iterator_type end,
+                        size_t nbuffers, bool map_blocks = false)
         : current_elem(0),
 #ifdef BUF_ISTREAM_CHECK_END
           not_finished(true),
@@ -88,7 +92,8 @@ public:
                                   nbuffers, mdevid);
 
         // create stream prefetcher
-        prefetcher = new prefetcher_type(bids_.begin(), bids_.end(), prefetch_seq, nbuffers);
+        prefetcher = new prefetcher_type(bids_.begin(), bids_.end(), prefetch_seq, nbuffers,
+                                         completion_handler(), map_blocks);
 
         // fetch block: last in sequence
         current_blk = prefetcher->pull_block();
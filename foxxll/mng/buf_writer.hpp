@@ -81,8 +81,6 @@ public:
 
         for (size_t i = 0; i < nwriteblocks; i++)
             free_write_blocks.push_back(i);
-
-        disk_queues::get_instance()->set_priority_op(request_queue::WRITE);
     }
 
     //! non-copyable: delete copy-constructor
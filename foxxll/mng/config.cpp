@@ -22,7 +22,10 @@
 #include <tlx/string/parse_si_iec_units.hpp>
 #include <tlx/string/split.hpp>
 
+#include <cstdlib>
 #include <fstream>
+#include <string>
+#include <vector>
 
 #if STXXL_WINDOWS
    #ifndef NOMINMAX
@@ -157,6 +160,15 @@ void config::load_config_file(const std::string& config_path)
         // skip comments
         if (line.size() == 0 || line[0] == '#') continue;
 
+        if (line.compare(0, 6, "stats=") == 0) {
+            parse_stats_line(line);
+            continue;
+        }
+        if (line.compare(0, 6, "trace=") == 0) {
+            set_request_trace(line.substr(6));
+            continue;
+        }
+
         disk_config entry;
         entry.parse_line(line); // throws on errors
 
@@ -177,6 +189,46 @@ void config::load_config_file(const std::string& config_path)
     }
 }
 
+config& config::set_stats_sampler(
+    const std::string& path, unsigned interval_ms, const std::string& format)
+{
+    if (interval_ms == 0) {
+        STXXL_THROW(std::runtime_error,
+                    "Invalid statistics interval 0 for '" << path << "'.");
+    }
+    if (format != "csv" && format != "json") {
+        STXXL_THROW(std::runtime_error,
+                    "Unknown statistics format '" << format << "', use csv or json.");
+    }
+
+    stats_path = path;
+    stats_interval = interval_ms;
+    stats_format = format;
+    return *this;
+}
+
+void config::parse_stats_line(const std::string& line)
+{
+    std::vector<std::string> eqfield = tlx::split('=', line, 2, 2);
+    if (eqfield[0] != "stats") {
+        STXXL_THROW(std::runtime_error,
+                    "Unknown configuration token " << eqfield[0]);
+    }
+
+    // path, interval, and optional format
+    std::vector<std::string> cmfield = tlx::split(',', eqfield[1], 3, 3);
+
+    char* endp;
+    unsigned long interval = strtoul(cmfield[1].c_str(), &endp, 10);
+    if (cmfield[1].empty() || *endp != 0) {
+        STXXL_THROW(std::runtime_error,
+                    "Invalid statistics interval '" << cmfield[1] << "' in configuration file.");
+    }
+
+    set_stats_sampler(cmfield[0], static_cast<unsigned>(interval),
+                      cmfield[2].empty() ? "csv" : cmfield[2]);
+}
+
 //! Returns automatic physical device id counter
 unsigned int config::get_max_device_id()
 {
@@ -223,6 +275,13 @@ disk_config::disk_config()
       device_id(file::DEFAULT_DEVICE_ID),
       raw_device(false),
       unlink_on_open(false),
+      discard(false),
+      discard_rate(0),
+      elevator(false),
+      elevator_max_wait(0),
+      max_read_bw(0),
+      max_write_bw(0),
+      max_iops(0),
       queue_length(0)
 { }
 
@@ -239,6 +298,13 @@ disk_config::disk_config(const std::string& _path, external_size_type _size,
       device_id(file::DEFAULT_DEVICE_ID),
       raw_device(false),
       unlink_on_open(false),
+      discard(false),
+      discard_rate(0),
+      elevator(false),
+      elevator_max_wait(0),
+      max_read_bw(0),
+      max_write_bw(0),
+      max_iops(0),
       queue_length(0)
 {
     parse_fileio();
@@ -254,6 +320,13 @@ disk_config::disk_config(const std::string& line)
       device_id(file::DEFAULT_DEVICE_ID),
       raw_device(false),
       unlink_on_open(false),
+      discard(false),
+      discard_rate(0),
+      elevator(false),
+      elevator_max_wait(0),
+      max_read_bw(0),
+      max_write_bw(0),
+      max_iops(0),
       queue_length(0)
 {
     parse_line(line);
@@ -284,6 +357,14 @@ void disk_config::parse_line(const std::string& line)
     queue = file::DEFAULT_QUEUE;
     device_id = file::DEFAULT_DEVICE_ID;
     unlink_on_open = false;
+    discard = false;
+    discard_rate = 0;
+    elevator = false;
+    elevator_max_wait = 0;
+    max_read_bw = 0;
+    max_write_bw = 0;
+    max_iops = 0;
+    queue_length = 0;
 
     // *** Save Basic Options ***
 
@@ -389,6 +470,52 @@ void disk_config::parse_fileio()
                             "Invalid parameter '" << *p << "' in disk configuration file.");
             }
         }
+        else if (*p == "discard" || eq[0] == "discard")
+        {
+            if (!(io_impl == "syscall" || io_impl == "linuxaio" ||
+                  io_impl == "io_uring" || io_impl == "mmap"))
+            {
+                STXXL_THROW(std::runtime_error, "Parameter '" << *p << "' invalid for fileio '" << io_impl << "' in disk configuration file.");
+            }
+
+            // optional rate limit in bytes per second, e.g. discard=1GiB
+            if (!eq[1].empty() && !tlx::parse_si_iec_units(eq[1], &discard_rate)) {
+                STXXL_THROW(std::runtime_error,
+                            "Invalid parameter '" << *p << "' in disk configuration file.");
+            }
+
+            discard = true;
+        }
+        else if (*p == "elevator" || eq[0] == "elevator")
+        {
+            if (io_impl == "linuxaio" || io_impl == "io_uring") {
+                STXXL_THROW(std::runtime_error, "Parameter '" << *p << "' invalid for fileio '" << io_impl << "' in disk configuration file.");
+            }
+
+            // optional starvation bound in milliseconds, e.g. elevator=200
+            if (!eq[1].empty())
+            {
+                char* endp;
+                elevator_max_wait = (unsigned)strtoul(eq[1].c_str(), &endp, 10);
+                if (endp && *endp != 0) {
+                    STXXL_THROW(std::runtime_error,
+                                "Invalid parameter '" << *p << "' in disk configuration file.");
+                }
+            }
+
+            elevator = true;
+        }
+        else if (eq[0] == "max_read_bw" || eq[0] == "max_write_bw" ||
+                 eq[0] == "max_iops")
+        {
+            // rate limits per second, e.g. max_read_bw=200MiB or max_iops=10k
+            uint64_t* limit = (eq[0] == "max_read_bw") ? &max_read_bw
+                              : (eq[0] == "max_write_bw") ? &max_write_bw : &max_iops;
+            if (!tlx::parse_si_iec_units(eq[1], limit)) {
+                STXXL_THROW(std::runtime_error,
+                            "Invalid parameter '" << *p << "' in disk configuration file.");
+            }
+        }
         else if (eq[0] == "queue")
         {
             if (io_impl == "linuxaio") {
@@ -404,12 +531,6 @@ void disk_config::parse_fileio()
         }
         else if (eq[0] == "queue_length")
         {
-            if (io_impl != "linuxaio") {
-                STXXL_THROW(std::runtime_error, "Parameter '" << *p << "' "
-                            "is only valid for fileio linuxaio "
-                            "in disk configuration file.");
-            }
-
             char* endp;
             queue_length = (int)strtoul(eq[1].c_str(), &endp, 10);
             if (endp && *endp != 0) {
@@ -437,7 +558,7 @@ void disk_config::parse_fileio()
         else if (*p == "unlink" || *p == "unlink_on_open")
         {
             if (!(io_impl == "syscall" || io_impl == "linuxaio" ||
-                  io_impl == "mmap"))
+                  io_impl == "io_uring" || io_impl == "mmap"))
             {
                 STXXL_THROW(std::runtime_error, "Parameter '" << *p << "' invalid for fileio '" << io_impl << "' in disk configuration file.");
             }
@@ -450,6 +571,11 @@ void disk_config::parse_fileio()
                         "Invalid optional parameter '" << *p << "' in disk configuration file.");
         }
     }
+
+    // disks sharing a queue use the queue type of the first one created
+    if (elevator && queue != file::DEFAULT_QUEUE) {
+        STXXL_THROW(std::runtime_error, "Parameter 'elevator' cannot be combined with 'queue' in disk configuration file.");
+    }
 }
 
 std::string disk_config::fileio_string() const
@@ -489,6 +615,27 @@ std::string disk_config::fileio_string() const
     if (unlink_on_open)
         oss << " unlink_on_open";
 
+    if (discard) {
+        oss << " discard";
+        if (discard_rate != 0)
+            oss << "=" << discard_rate;
+    }
+
+    if (elevator) {
+        oss << " elevator";
+        if (elevator_max_wait != 0)
+            oss << "=" << elevator_max_wait;
+    }
+
+    if (max_read_bw != 0)
+        oss << " max_read_bw=" << max_read_bw;
+
+    if (max_write_bw != 0)
+        oss << " max_write_bw=" << max_write_bw;
+
+    if (max_iops != 0)
+        oss << " max_iops=" << max_iops;
+
     if (queue_length != 0)
         oss << " queue_length=" << queue_length;
 
@@ -101,7 +101,28 @@ public:
     //! unlink file immediately after opening (available on most Unix)
     bool unlink_on_open;
 
-    //! desired queue length for linuxaio_file and linuxaio_queue
+    //! release freed blocks to the file system by punching holes, or to raw
+    //! devices by TRIM, with at most discard_rate bytes per second (0 is the
+    //! default rate), see ufs_file_base::enable_discard().
+    bool discard;
+    uint64_t discard_rate;
+
+    //! serve requests sorted by offset in C-SCAN order and merge adjacent
+    //! ones (for rotating disks), passing over a request for at most
+    //! elevator_max_wait milliseconds (0 is the default of 500 ms), see
+    //! request_queue_impl_elevator.
+    bool elevator;
+    unsigned elevator_max_wait;
+
+    //! limits of the bytes read and written and the I/O operations per second
+    //! of the disk's queue (0 is unlimited), see io_throttle.
+    uint64_t max_read_bw;
+    uint64_t max_write_bw;
+    uint64_t max_iops;
+
+    //! desired queue length for linuxaio_file and linuxaio_queue, the
+    //! number of ring entries of io_uring_queue, or the number of worker
+    //! threads serving the disk for all other fileio (default: one)
     int queue_length;
 
     //! \}
@@ -126,10 +147,22 @@ class config : public singleton<config>
     //! Finished initializing config
     bool is_initialized;
 
+    //! statistics file written by a stats_sampler, empty if disabled
+    std::string stats_path;
+    //! milliseconds between statistics samples
+    unsigned stats_interval;
+    //! format of the statistics file, "csv" or "json"
+    std::string stats_format;
+
+    //! file request_trace writes to, empty if disabled
+    std::string trace_path;
+
     //! Constructor: this must be inlined to print the header version
     //! string.
     inline config()
-        : is_initialized(false)
+        : is_initialized(false),
+          stats_interval(1000),
+          stats_format("csv")
     {
         logger::get_instance();
         STXXL_MSG(get_version_string_long());
@@ -174,6 +207,26 @@ public:
         return *this;
     }
 
+    //! Periodically write I/O statistics to a file, see stats_sampler.
+    //!
+    //! \warning This function should only be used during initialization, as it
+    //! has no effect after construction of block_manager.
+    config & set_stats_sampler(const std::string& path, unsigned interval_ms = 1000,
+                               const std::string& format = "csv");
+
+    //! Parse a line "stats=<path>,<interval ms>[,csv|json]" of a config file.
+    void parse_stats_line(const std::string& line);
+
+    //! Record the lifecycle of all requests to a file, see request_trace.
+    //!
+    //! \warning This function should only be used during initialization, as it
+    //! has no effect after construction of block_manager.
+    config & set_request_trace(const std::string& path)
+    {
+        trace_path = path;
+        return *this;
+    }
+
     //! \}
 
 protected:
@@ -266,6 +319,30 @@ public:
     //! Returns the total size over all disks
     external_size_type total_size() const;
 
+    //! Returns the file statistics are sampled to, empty if disabled.
+    const std::string & stats_sampler_path() const
+    {
+        return stats_path;
+    }
+
+    //! Returns the milliseconds between statistics samples.
+    unsigned stats_sampler_interval() const
+    {
+        return stats_interval;
+    }
+
+    //! Returns the format of the statistics file, "csv" or "json".
+    const std::string & stats_sampler_format() const
+    {
+        return stats_format;
+    }
+
+    //! Returns the file requests are traced to, empty if disabled.
+    const std::string & request_trace_path() const
+    {
+        return trace_path;
+    }
+
     //! \}
 };
 
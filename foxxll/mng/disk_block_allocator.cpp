@@ -101,7 +101,7 @@ void disk_block_allocator::add_free_region(uint64_t block_pos, uint64_t block_si
                 // coalesce with predecessor
                 region_size += (*pred).second;
                 region_pos = (*pred).first;
-                free_space_.erase(pred);
+                erase_space(pred);
             }
         }
         else
@@ -120,7 +120,7 @@ void disk_block_allocator::add_free_region(uint64_t block_pos, uint64_t block_si
                 {
                     // coalesce with successor
                     region_size += (*succ).second;
-                    free_space_.erase(succ);
+                    erase_space(succ);
                     //-tb: set succ to pred afterwards due to iterator invalidation
                     succ = pred;
                 }
@@ -136,7 +136,7 @@ void disk_block_allocator::add_free_region(uint64_t block_pos, uint64_t block_si
                         // coalesce with predecessor
                         region_size += (*pred).second;
                         region_pos = (*pred).first;
-                        free_space_.erase(pred);
+                        erase_space(pred);
                     }
                 }
             }
@@ -146,13 +146,13 @@ void disk_block_allocator::add_free_region(uint64_t block_pos, uint64_t block_si
                 {
                     // coalesce with successor
                     region_size += (*succ).second;
-                    free_space_.erase(succ);
+                    erase_space(succ);
                 }
             }
         }
     }
 
-    free_space_[region_pos] = region_size;
+    insert_space(region_pos, region_size);
     free_bytes_ += block_size;
 
     //dump();
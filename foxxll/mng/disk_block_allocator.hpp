@@ -25,11 +25,14 @@
 #include <foxxll/verbose.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <map>
 #include <mutex>
 #include <ostream>
+#include <set>
 #include <utility>
+#include <vector>
 
 namespace foxxll {
 
@@ -39,19 +42,25 @@ namespace foxxll {
 /*!
  * This class manages allocation of blocks onto a single disk. It contains a map
  * of all currently allocated blocks. The block_manager selects which of the
- * disk_block_allocator objects blocks are drawn from.
+ * disk_block_allocator objects blocks are drawn from. All methods are thread
+ * safe.
  */
 class disk_block_allocator
 {
     //! pair (offset, size) used for free space calculation
     using place = std::pair<uint64_t, uint64_t>;
     using space_map_type = std::map<uint64_t, uint64_t>;
+    //! pairs (size, offset) of free regions, ordered by size for best-fit
+    using size_index_type = std::set<std::pair<uint64_t, uint64_t> >;
 
     std::mutex mutex_;
     //! map of free space as places
     space_map_type free_space_;
-    uint64_t free_bytes_ = 0;
-    uint64_t disk_bytes_ = 0;
+    //! the same free regions, indexed by size
+    size_index_type free_size_index_;
+    //! atomic for reading statistics without taking mutex_
+    std::atomic<uint64_t> free_bytes_ { 0 };
+    std::atomic<uint64_t> disk_bytes_ { 0 };
     uint64_t cfg_bytes_;
     file* storage_;
     bool autogrow_;
@@ -66,6 +75,31 @@ class disk_block_allocator
     // expects the mutex_ to be locked to prevent concurrent access
     void add_free_region(uint64_t block_pos, uint64_t block_size);
 
+    //! insert a free region into both indexes
+    void insert_space(uint64_t region_pos, uint64_t region_size)
+    {
+        free_space_[region_pos] = region_size;
+        free_size_index_.emplace(region_size, region_pos);
+    }
+
+    //! remove a free region from both indexes
+    void erase_space(space_map_type::iterator it)
+    {
+        free_size_index_.erase(std::make_pair(it->second, it->first));
+        free_space_.erase(it);
+    }
+
+    //! find the smallest free region of at least the given size, preferring
+    //! the lowest offset among equally sized regions
+    space_map_type::iterator find_space(uint64_t size)
+    {
+        size_index_type::const_iterator it =
+            free_size_index_.lower_bound(std::make_pair(size, uint64_t(0)));
+        if (it == free_size_index_.end())
+            return free_space_.end();
+        return free_space_.find(it->second);
+    }
+
     // expects the mutex_ to be locked to prevent concurrent access
     void grow_file(uint64_t extend_bytes)
     {
@@ -138,6 +172,24 @@ public:
             delete_block(bids[i]);
     }
 
+    //! list of regions as pairs (position, size)
+    using region_list_type = std::vector<std::pair<uint64_t, uint64_t> >;
+
+    //! free several regions, taking the mutex only once
+    void delete_regions(const region_list_type& regions)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        for (const auto& r : regions)
+        {
+            STXXL_VERBOSE2("disk_block_allocator::delete_regions(pos=" <<
+                           r.first << ", size=" << r.second <<
+                           "), free:" << free_bytes_ << " total:" << disk_bytes_);
+
+            add_free_region(r.first, r.second);
+        }
+    }
+
     template <size_t BlockSize>
     void delete_block(const BID<BlockSize>& bid)
     {
@@ -188,11 +240,7 @@ void disk_block_allocator::new_blocks(BIDIterator begin, BIDIterator end)
 
     // dump();
 
-    space_map_type::iterator space =
-        std::find_if(free_space_.begin(), free_space_.end(),
-                     [requested_size](const place& entry) {
-                         return (entry.second >= requested_size);
-                     });
+    space_map_type::iterator space = find_space(requested_size);
 
     if (space == free_space_.end() && begin + 1 == end)
     {
@@ -207,20 +255,17 @@ void disk_block_allocator::new_blocks(BIDIterator begin, BIDIterator end)
 
         grow_file(begin->size);
 
-        space = std::find_if(free_space_.begin(), free_space_.end(),
-                             [requested_size](const place& entry) {
-                                 return (entry.second >= requested_size);
-                             });
+        space = find_space(requested_size);
     }
 
     if (space != free_space_.end())
     {
         uint64_t region_pos = (*space).first;
         uint64_t region_size = (*space).second;
-        free_space_.erase(space);
+        erase_space(space);
 
         if (region_size > requested_size)
-            free_space_[region_pos + requested_size] = region_size - requested_size;
+            insert_space(region_pos + requested_size, region_size - requested_size);
 
         for (uint64_t pos = region_pos; begin != end; ++begin)
         {
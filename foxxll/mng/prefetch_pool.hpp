@@ -15,12 +15,12 @@
 #define STXXL_MNG_PREFETCH_POOL_HEADER
 
 #include <foxxll/config.hpp>
+#include <foxxll/mng/bid_table.hpp>
 #include <foxxll/mng/write_pool.hpp>
 
 #include <algorithm>
-#include <list>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace foxxll {
 
@@ -36,39 +36,17 @@ public:
     using bid_type = typename block_type::bid_type;
 
 protected:
-    struct bid_hash
-    {
-        size_t operator () (const bid_type& bid) const
-        {
-            size_t result = size_t(bid.storage) +
-                            size_t(bid.offset & 0xffffffff) +
-                            size_t(bid.offset >> 32);
-            return result;
-        }
-#if STXXL_MSVC
-        bool operator () (const bid_type& a, const bid_type& b) const
-        {
-            return (a.storage < b.storage) || (a.storage == b.storage && a.offset < b.offset);
-        }
-        enum
-        {                               // parameters for hash table
-            bucket_size = 4,            // 0 < bucket_size
-            min_buckets = 8             // min_buckets = 2 ^^ N, 0 < N
-        };
-#endif
-    };
     using busy_entry = std::pair<block_type*, request_ptr>;
-    using unordered_map_type = typename std::unordered_map<bid_type, busy_entry, bid_hash>;
-    using free_blocks_iterator = typename std::list<block_type*>::iterator;
-    using busy_blocks_iterator = typename unordered_map_type::iterator;
+    using busy_table_type = bid_table<bid_type, busy_entry>;
 
-    //! contains free prefetch blocks
-    std::list<block_type*> free_blocks;
+    //! contains free prefetch blocks, each allocated by new since steal()
+    //! passes them to callers which delete them
+    std::vector<block_type*> free_blocks;
 
     //! blocks that are in reading or already read but not retrieved by user
-    unordered_map_type busy_blocks;
+    busy_table_type busy_blocks;
 
-    //! count number of free blocks, since traversing the std::list is slow.
+    //! number of free blocks, equals free_blocks.size()
     size_t free_blocks_size;
 
 public:
@@ -77,6 +55,7 @@ public:
     explicit prefetch_pool(size_t init_size = 1)
         : free_blocks_size(init_size)
     {
+        reserve(init_size);
         size_t i = 0;
         for ( ; i < init_size; ++i)
             free_blocks.push_back(new block_type);
@@ -90,7 +69,7 @@ public:
     void swap(prefetch_pool& obj)
     {
         std::swap(free_blocks, obj.free_blocks);
-        std::swap(busy_blocks, obj.busy_blocks);
+        busy_blocks.swap(obj.busy_blocks);
         std::swap(free_blocks_size, obj.free_blocks_size);
     }
 
@@ -105,12 +84,12 @@ public:
 
         try
         {
-            busy_blocks_iterator i2 = busy_blocks.begin();
-            for ( ; i2 != busy_blocks.end(); ++i2)
-            {
-                i2->second.second->wait();
-                delete i2->second.first;
-            }
+            busy_blocks.for_each(
+                [](const bid_type&, busy_entry& e) {
+                    e.second->wait();
+                    delete e.first;
+                    e.first = nullptr;
+                });
         }
         catch (...)
         { }
@@ -137,6 +116,7 @@ public:
     //! Add a new block to prefetch pool, enlarges size of pool.
     void add(block_type*& block)
     {
+        reserve(size() + 1);
         free_blocks.push_back(block);
         ++free_blocks_size;
         block = nullptr; // prevent caller from using the block any further
@@ -181,6 +161,7 @@ public:
             block_type* block = free_blocks.back();
             free_blocks.pop_back();
             STXXL_VERBOSE2("prefetch_pool::hint bid=" << bid << " => prefetching");
+            scoped_priority_class priority(request::PREFETCH);
             request_ptr req = block->read(bid);
             busy_blocks[bid] = busy_entry(block, req);
             return true;
@@ -228,6 +209,7 @@ public:
                 return true;
             }
             STXXL_VERBOSE2("prefetch_pool::hint2 bid=" << bid << " => prefetching");
+            scoped_priority_class priority(request::PREFETCH);
             request_ptr req = block->read(bid);
             busy_blocks[bid] = busy_entry(block, req);
             return true;
@@ -239,38 +221,38 @@ public:
     //! Cancel a hint request in case the block is no longer desired.
     bool invalidate(bid_type bid)
     {
-        busy_blocks_iterator cache_el = busy_blocks.find(bid);
-        if (cache_el == busy_blocks.end())
+        busy_entry* cache_el = busy_blocks.find(bid);
+        if (!cache_el)
             return false;
 
         // cancel request if it is a read request, there might be
         // write requests 'stolen' from a write_pool that may not be canceled
-        if (cache_el->second.second->get_op() == request::READ)
-            cache_el->second.second->cancel();
+        if (cache_el->second->get_op() == request::READ)
+            cache_el->second->cancel();
         // finish the request
-        cache_el->second.second->wait();
+        cache_el->second->wait();
         ++free_blocks_size;
-        free_blocks.push_back(cache_el->second.first);
-        busy_blocks.erase(cache_el);
+        free_blocks.push_back(cache_el->first);
+        busy_blocks.erase(bid);
         return true;
     }
 
     //! Checks if a block is in the hinted block set.
     bool in_prefetching(bid_type bid)
     {
-        return (busy_blocks.find(bid) != busy_blocks.end());
+        return busy_blocks.contains(bid);
     }
 
     //! Returns the request pointer for a hinted block, or an invalid nullptr
     //! request in case it was not requested due to lack of prefetch buffers.
     request_ptr find(bid_type bid)
     {
-        busy_blocks_iterator cache_el = busy_blocks.find(bid);
+        busy_entry* cache_el = busy_blocks.find(bid);
 
-        if (cache_el == busy_blocks.end())
+        if (!cache_el)
             return request_ptr(); // invalid pointer
         else
-            return cache_el->second.second;
+            return cache_el->second;
     }
 
     //! Returns true if the blocks was hinted and the request is finished.
@@ -296,8 +278,8 @@ public:
      */
     request_ptr read(block_type*& block, bid_type bid)
     {
-        busy_blocks_iterator cache_el = busy_blocks.find(bid);
-        if (cache_el == busy_blocks.end())
+        busy_entry* cache_el = busy_blocks.find(bid);
+        if (!cache_el)
         {
             // not cached
             STXXL_VERBOSE1("prefetch_pool::read bid=" << bid << " => no copy in cache, retrieving to " << block);
@@ -308,25 +290,25 @@ public:
         STXXL_VERBOSE1("prefetch_pool::read bid=" << bid << " => copy in cache exists");
         ++free_blocks_size;
         free_blocks.push_back(block);
-        block = cache_el->second.first;
-        request_ptr result = cache_el->second.second;
-        busy_blocks.erase(cache_el);
+        block = cache_el->first;
+        request_ptr result = cache_el->second;
+        busy_blocks.erase(bid);
         return result;
     }
 
     request_ptr read(block_type*& block, bid_type bid, write_pool<block_type>& w_pool)
     {
         // try cache
-        busy_blocks_iterator cache_el = busy_blocks.find(bid);
-        if (cache_el != busy_blocks.end())
+        busy_entry* cache_el = busy_blocks.find(bid);
+        if (cache_el)
         {
             // cached
             STXXL_VERBOSE1("prefetch_pool::read bid=" << bid << " => copy in cache exists");
             ++free_blocks_size;
             free_blocks.push_back(block);
-            block = cache_el->second.first;
-            request_ptr result = cache_el->second.second;
-            busy_blocks.erase(cache_el);
+            block = cache_el->first;
+            request_ptr result = cache_el->second;
+            busy_blocks.erase(bid);
             return result;
         }
 
@@ -357,6 +339,7 @@ public:
         int64_t diff = int64_t(new_size) - int64_t(size());
         if (diff > 0)
         {
+            reserve(new_size);
             free_blocks_size += diff;
             while (--diff >= 0)
                 free_blocks.push_back(new block_type);
@@ -373,6 +356,15 @@ public:
         }
         return size();
     }
+
+protected:
+    //! make room for n blocks, such that neither the free stack nor the busy
+    //! table allocate while hinting and reading
+    void reserve(size_t n)
+    {
+        free_blocks.reserve(n);
+        busy_blocks.reserve(n);
+    }
 };
 
 //! \}
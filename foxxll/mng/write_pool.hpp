@@ -16,11 +16,16 @@
 
 #include <foxxll/config.hpp>
 #include <foxxll/deprecated.hpp>
+#include <foxxll/io/completion_queue.hpp>
 #include <foxxll/io/request_operations.hpp>
+#include <foxxll/mng/bid.hpp>
+#include <foxxll/mng/bid_table.hpp>
 
 #include <algorithm>
-#include <list>
+#include <cstdint>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #define STXXL_VERBOSE_WPOOL(msg) STXXL_VERBOSE1("write_pool[" << static_cast<void*>(this) << "]" << msg)
 
@@ -37,7 +42,6 @@ public:
     using block_type = BlockType;
     using bid_type = typename block_type::bid_type;
 
-    // a hack to make wait_any work with busy_entry type
     struct busy_entry
     {
         block_type* block;
@@ -45,26 +49,36 @@ public:
         bid_type bid;
 
         busy_entry() : block(nullptr) { }
-        busy_entry(const busy_entry& a) : block(a.block), req(a.req), bid(a.bid) { }
         busy_entry(block_type*& bl, request_ptr& r, bid_type& bi)
             : block(bl), req(r), bid(bi) { }
 
         operator request_ptr () { return req; }
     };
-    using free_blocks_iterator = typename std::list<block_type*>::iterator;
-    using busy_blocks_iterator = typename std::list<busy_entry>::iterator;
 
 protected:
-    // contains free write blocks
-    std::list<block_type*> free_blocks;
-    // blocks that are in writing
-    std::list<busy_entry> busy_blocks;
+    // contains free write blocks; they are single allocations rather than
+    // parts of one array, as callers free the blocks they steal() by delete
+    std::vector<block_type*> free_blocks;
+    // blocks that are in writing, unused slots have no block
+    std::vector<busy_entry> busy_blocks;
+    // indexes of unused slots in busy_blocks
+    std::vector<size_t> free_slots;
+    // number of used slots in busy_blocks
+    size_t busy_size = 0;
+    // slot of the most recent write of each bid in busy_blocks, earlier
+    // writes to the same bid are stale and not indexed
+    bid_table<bid_type, size_t> busy_index;
+    // write requests of busy_blocks in completion order, tagged with their
+    // slot, on the heap since requests point to it
+    std::unique_ptr<completion_queue> completions;
 
 public:
     //! Constructs pool.
     //! \param init_size initial number of blocks in the pool
     explicit write_pool(size_t init_size = 1)
+        : completions(new completion_queue)
     {
+        reserve(init_size);
         for (size_t i = 0; i < init_size; ++i)
         {
             free_blocks.push_back(new block_type);
@@ -81,13 +95,17 @@ public:
     {
         std::swap(free_blocks, obj.free_blocks);
         std::swap(busy_blocks, obj.busy_blocks);
+        std::swap(free_slots, obj.free_slots);
+        std::swap(busy_size, obj.busy_size);
+        busy_index.swap(obj.busy_index);
+        std::swap(completions, obj.completions);
     }
 
     //! Waits for completion of all ongoing write requests and frees memory.
     ~write_pool()
     {
         STXXL_VERBOSE_WPOOL("::~write_pool free_blocks.size()=" << free_blocks.size() <<
-                            " busy_blocks.size()=" << busy_blocks.size());
+                            " busy_blocks.size()=" << busy_size);
         while (!free_blocks.empty())
         {
             STXXL_VERBOSE_WPOOL("  delete free block=" << free_blocks.back());
@@ -97,22 +115,28 @@ public:
 
         try
         {
-            for (busy_blocks_iterator i2 = busy_blocks.begin(); i2 != busy_blocks.end(); ++i2)
+            for (busy_entry& e : busy_blocks)
             {
-                i2->req->wait();
-                if (free_blocks.empty())
-                    STXXL_VERBOSE_WPOOL("  delete busy block=(empty)");
-                else
-                    STXXL_VERBOSE_WPOOL("  delete busy block=" << free_blocks.back());
-                delete i2->block;
+                if (!e.block) continue;
+                e.req->wait();
+                STXXL_VERBOSE_WPOOL("  delete busy block=" << e.block);
+                delete e.block;
+                e.block = nullptr;
             }
         }
         catch (...)
-        { }
+        {
+            // requests still running must not push onto the deleted queue
+            for (busy_entry& e : busy_blocks)
+            {
+                if (e.block)
+                    completions->remove(e.req);
+            }
+        }
     }
 
     //! Returns number of owned blocks.
-    size_t size() const { return free_blocks.size() + busy_blocks.size(); }
+    size_t size() const { return free_blocks.size() + busy_size; }
 
     //! Passes a block to the pool for writing.
     //! \param block block to write. Ownership of the block goes to the pool.
@@ -123,20 +147,34 @@ public:
     request_ptr write(block_type*& block, bid_type bid)
     {
         STXXL_VERBOSE_WPOOL("::write: " << block << " @ " << bid);
-        for (busy_blocks_iterator i2 = busy_blocks.begin(); i2 != busy_blocks.end(); ++i2)
+        if (size_t* stale = busy_index.find(bid))
         {
-            if (i2->bid == bid) {
-                assert(i2->block != block);
-                STXXL_VERBOSE_WPOOL("WAW dependency");
-                // try to cancel the obsolete request
-                i2->req->cancel();
-                // invalidate the bid of the stale write request,
-                // prevents prefetch_pool from stealing a stale block
-                i2->bid.storage = 0;
-            }
+            busy_entry& e = busy_blocks[*stale];
+            assert(e.block != block);
+            STXXL_VERBOSE_WPOOL("WAW dependency");
+            // try to cancel the obsolete request
+            e.req->cancel();
+            // invalidate the bid of the stale write request,
+            // prevents prefetch_pool from stealing a stale block
+            e.bid.storage = 0;
+            busy_index.erase(bid);
         }
         request_ptr result = block->write(bid);
-        busy_blocks.push_back(busy_entry(block, result, bid));
+
+        size_t slot;
+        if (!free_slots.empty()) {
+            slot = free_slots.back();
+            free_slots.pop_back();
+            busy_blocks[slot] = busy_entry(block, result, bid);
+        }
+        else {
+            slot = busy_blocks.size();
+            busy_blocks.push_back(busy_entry(block, result, bid));
+        }
+        ++busy_size;
+        busy_index[bid] = slot;
+        completions->add(result, slot_tag(slot));
+
         block = nullptr; // prevent caller from using the block any further
         return result;
     }
@@ -153,13 +191,14 @@ public:
             free_blocks.pop_back();
             return p;
         }
-        STXXL_VERBOSE_WPOOL("::steal : all " << busy_blocks.size() << " are busy");
-        busy_blocks_iterator completed = wait_any(busy_blocks.begin(), busy_blocks.end());
-        assert(completed != busy_blocks.end()); // we got something reasonable from wait_any
-        assert(completed->req->poll());         // and it is *really* completed
-        block_type* p = completed->block;
-        busy_blocks.erase(completed);
-        check_all_busy();                       // for debug
+        STXXL_VERBOSE_WPOOL("::steal : all " << busy_size << " are busy");
+        completion_queue::entry e = completions->pop();
+        e.req->check_errors();
+        const size_t slot = tag_slot(e.tag);
+        assert(busy_blocks[slot].req == e.req);
+        block_type* p = busy_blocks[slot].block;
+        erase_busy(slot);
+        check_all_busy();
         STXXL_VERBOSE_WPOOL("  serve block=" << p);
         return p;
     }
@@ -177,6 +216,7 @@ public:
         int64_t diff = int64_t(new_size) - int64_t(size());
         if (diff > 0)
         {
+            reserve(new_size);
             while (--diff >= 0)
             {
                 free_blocks.push_back(new block_type);
@@ -192,57 +232,46 @@ public:
 
     STXXL_DEPRECATED(request_ptr get_request(bid_type bid))
     {
-        busy_blocks_iterator i2 = busy_blocks.begin();
-        for ( ; i2 != busy_blocks.end(); ++i2)
-        {
-            if (i2->bid == bid)
-                return i2->req;
-        }
-        return request_ptr();
+        size_t* slot = busy_index.find(bid);
+        if (!slot)
+            return request_ptr();
+        return busy_blocks[*slot].req;
     }
 
     bool has_request(bid_type bid)
     {
-        for (busy_blocks_iterator i2 = busy_blocks.begin(); i2 != busy_blocks.end(); ++i2)
-        {
-            if (i2->bid == bid)
-                return true;
-        }
-        return false;
+        return busy_index.contains(bid);
     }
 
     STXXL_DEPRECATED(block_type * steal(bid_type bid))
     {
-        busy_blocks_iterator i2 = busy_blocks.begin();
-        for ( ; i2 != busy_blocks.end(); ++i2)
-        {
-            if (i2->bid == bid)
-            {
-                block_type* p = i2->block;
-                i2->req->wait();
-                busy_blocks.erase(i2);
-                return p;
-            }
-        }
-        return nullptr;
+        size_t* found = busy_index.find(bid);
+        if (!found)
+            return nullptr;
+
+        const size_t slot = *found;
+        block_type* p = busy_blocks[slot].block;
+        busy_blocks[slot].req->wait();
+        completions->remove(busy_blocks[slot].req);
+        erase_busy(slot);
+        return p;
     }
 
     // returns a block and a (potentially unfinished) I/O request associated with it
     std::pair<block_type*, request_ptr> steal_request(bid_type bid)
     {
-        for (busy_blocks_iterator i2 = busy_blocks.begin(); i2 != busy_blocks.end(); ++i2)
+        if (size_t* found = busy_index.find(bid))
         {
-            if (i2->bid == bid)
-            {
-                // remove busy block from list, request has not yet been waited for!
-                block_type* blk = i2->block;
-                request_ptr req = i2->req;
-                busy_blocks.erase(i2);
-
-                STXXL_VERBOSE_WPOOL("::steal_request block=" << blk);
-                // hand over block and (unfinished) request to caller
-                return std::pair<block_type*, request_ptr>(blk, req);
-            }
+            // remove busy block, request has not yet been waited for!
+            const size_t slot = *found;
+            block_type* blk = busy_blocks[slot].block;
+            request_ptr req = busy_blocks[slot].req;
+            completions->remove(req);
+            erase_busy(slot);
+
+            STXXL_VERBOSE_WPOOL("::steal_request block=" << blk);
+            // hand over block and (unfinished) request to caller
+            return std::pair<block_type*, request_ptr>(blk, req);
         }
         STXXL_VERBOSE_WPOOL("::steal_request NOT FOUND");
         // not matching request found, return a dummy
@@ -257,23 +286,52 @@ public:
     }
 
 protected:
+    static void * slot_tag(size_t slot)
+    {
+        return reinterpret_cast<void*>(static_cast<uintptr_t>(slot));
+    }
+
+    static size_t tag_slot(void* tag)
+    {
+        return static_cast<size_t>(reinterpret_cast<uintptr_t>(tag));
+    }
+
+    //! make room for n blocks, such that neither the free stack, the busy
+    //! slots nor the index allocate while the pool is used
+    void reserve(size_t n)
+    {
+        free_blocks.reserve(n);
+        busy_blocks.reserve(n);
+        free_slots.reserve(n);
+        busy_index.reserve(n);
+    }
+
+    //! release a slot of busy_blocks and, unless stale, its index entry
+    void erase_busy(size_t slot)
+    {
+        busy_entry& e = busy_blocks[slot];
+        if (e.bid.storage)
+            busy_index.erase(e.bid);
+        e = busy_entry();
+        free_slots.push_back(slot);
+        --busy_size;
+    }
+
+    //! move the blocks of all completed writes to free_blocks
     void check_all_busy()
     {
-        busy_blocks_iterator cur = busy_blocks.begin();
+        completion_queue::entry e;
         size_t cnt = 0;
-        while (cur != busy_blocks.end())
+        while (completions->try_pop(e))
         {
-            if (cur->req->poll())
-            {
-                free_blocks.push_back(cur->block);
-                cur = busy_blocks.erase(cur);
-                ++cnt;
-                continue;
-            }
-            ++cur;
+            e.req->check_errors();
+            const size_t slot = tag_slot(e.tag);
+            free_blocks.push_back(busy_blocks[slot].block);
+            erase_busy(slot);
+            ++cnt;
         }
         STXXL_VERBOSE_WPOOL("::check_all_busy : " << cnt <<
-                            " are completed out of " << busy_blocks.size() + cnt << " busy blocks");
+                            " are completed out of " << busy_size + cnt << " busy blocks");
     }
 };
 
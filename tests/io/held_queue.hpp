@@ -0,0 +1,66 @@
+/***************************************************************************
+ *  tests/io/held_queue.hpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! Helpers of the tests which hold up the worker of a disk queue in the
+//! completion handler of a gating request, such that the requests submitted
+//! meanwhile are all waiting at once, and which check the order they are
+//! served in.
+
+#ifndef STXXL_TESTS_IO_HELD_QUEUE_HEADER
+#define STXXL_TESTS_IO_HELD_QUEUE_HEADER
+
+#include <foxxll/io/request.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! set once hold_worker() holds up the worker
+static std::atomic<bool> s_holding { false };
+//! releases the worker held up by hold_worker()
+static std::atomic<bool> s_released { false };
+
+//! completion handler which holds up the queue's worker until released
+inline void hold_worker(foxxll::request*, bool)
+{
+    s_holding = true;
+    while (!s_released)
+        std::this_thread::yield();
+}
+
+//! Ids of requests in the order of their completion.
+struct completion_order
+{
+    std::mutex mutex;
+    std::vector<size_t> order;
+
+    //! completion handler appending id to the order
+    foxxll::completion_handler record(size_t id)
+    {
+        return [this, id](foxxll::request*, bool) {
+                   std::unique_lock<std::mutex> lock(mutex);
+                   order.push_back(id);
+               };
+    }
+};
+
+//! A queue id of its own on each call, such that a fresh queue is created
+//! rather than sharing the default queue of the file's device.
+inline int fresh_queue_id()
+{
+    static int next = 1001;
+    return next++;
+}
+
+#endif // !STXXL_TESTS_IO_HELD_QUEUE_HEADER
+// vim: et:ts=4:sw=4
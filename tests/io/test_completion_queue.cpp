@@ -0,0 +1,174 @@
+/***************************************************************************
+ *  tests/io/test_completion_queue.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! \example io/test_completion_queue.cpp
+//! Tracks requests with a completion_queue: every request must be popped
+//! exactly once with its tag, also if it completed before it was added, and
+//! removed requests must not be popped. A long pop() must boost the tracked
+//! requests ahead of a backlog.
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/io.hpp>
+#include <foxxll/verbose.hpp>
+
+#include "held_queue.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+//! A pop lasting longer than the boost delay serves the tracked request ahead
+//! of the backlog in front of it.
+static void test_boost(const char* filetype, const char* filename, int queue_id)
+{
+    const size_t num_blocks = 64;
+    const size_t block_size = 16 * 1024;
+
+    foxxll::file_ptr file = foxxll::create_file(
+        filetype, filename,
+        foxxll::file::CREAT | foxxll::file::RDWR | foxxll::file::DIRECT,
+        queue_id);
+    file->set_size(num_blocks * block_size);
+
+    char* buffer = static_cast<char*>(
+        foxxll::aligned_alloc<4096>(num_blocks * block_size));
+
+    const double delay = foxxll::request::boost_delay();
+    foxxll::request::set_boost_delay(0.01);
+
+    completion_order completed;
+
+    foxxll::request_ptr gate = file->awrite(buffer, 0, block_size, hold_worker);
+    while (!s_holding)
+        std::this_thread::yield();
+
+    std::vector<foxxll::request_ptr> reqs;
+    for (size_t b = 1; b < num_blocks; ++b)
+        reqs.push_back(file->aread(buffer + b * block_size, b * block_size,
+                                   block_size, completed.record(b)));
+
+    foxxll::completion_queue cq;
+    cq.add(reqs.back(), nullptr);
+
+    const foxxll::stats_data before(*foxxll::stats::get_instance());
+    std::thread releaser([]() {
+                             std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                             s_released = true;
+                         });
+    STXXL_CHECK(cq.pop().req == reqs.back());
+    releaser.join();
+    foxxll::wait_all(reqs.begin(), reqs.end());
+    gate->wait();
+    const foxxll::stats_data after(*foxxll::stats::get_instance());
+
+    STXXL_CHECK_EQUAL(completed.order.front(), num_blocks - 1);
+    STXXL_CHECK_EQUAL((after - before).get_boosted_waits(), 1u);
+
+    foxxll::request::set_boost_delay(delay);
+    foxxll::aligned_dealloc<4096>(buffer);
+    file->close_remove();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: " << argv[0] << " filetype tempfile" << std::endl;
+        return -1;
+    }
+
+    const size_t num_blocks = 256;
+    const size_t block_size = 16 * 1024;
+
+    foxxll::file_ptr file = foxxll::create_file(
+        argv[1], argv[2], foxxll::file::CREAT | foxxll::file::RDWR | foxxll::file::DIRECT);
+    file->set_size(num_blocks * block_size);
+
+    char* buffer = static_cast<char*>(
+        foxxll::aligned_alloc<4096>(num_blocks * block_size));
+
+    foxxll::completion_queue cq;
+    std::vector<size_t> popped(num_blocks, 0);
+
+    // requests still running when added
+    std::vector<foxxll::request_ptr> reqs;
+    for (size_t b = 0; b < num_blocks; ++b)
+    {
+        reqs.push_back(file->awrite(buffer + b * block_size, b * block_size, block_size));
+        cq.add(reqs.back(), &popped[b]);
+    }
+    STXXL_CHECK_EQUAL(cq.size(), num_blocks);
+
+    for (size_t i = 0; i < num_blocks; ++i)
+    {
+        foxxll::completion_queue::entry e = cq.pop();
+        STXXL_CHECK(e.req->poll());
+        size_t b = static_cast<size_t*>(e.tag) - popped.data();
+        STXXL_CHECK(b < num_blocks);
+        STXXL_CHECK(e.req == reqs[b]);
+        ++popped[b];
+    }
+    for (size_t b = 0; b < num_blocks; ++b)
+        STXXL_CHECK_EQUAL(popped[b], 1u);
+    STXXL_CHECK(cq.empty());
+
+    foxxll::completion_queue::entry e;
+    STXXL_CHECK(!cq.try_pop(e));
+
+    // requests completed before they are added
+    reqs.clear();
+    for (size_t b = 0; b < num_blocks; ++b)
+        reqs.push_back(file->aread(buffer + b * block_size, b * block_size, block_size));
+    foxxll::wait_all(reqs.begin(), reqs.end());
+    for (size_t b = 0; b < num_blocks; ++b)
+        cq.add(reqs[b], &popped[b]);
+    STXXL_CHECK_EQUAL(cq.ready(), num_blocks);
+
+    // remove every other request
+    for (size_t b = 0; b < num_blocks; b += 2)
+        STXXL_CHECK(cq.remove(reqs[b]));
+    STXXL_CHECK(!cq.remove(reqs[0]));
+    STXXL_CHECK_EQUAL(cq.size(), num_blocks / 2);
+
+    while (cq.try_pop(e))
+        ++*static_cast<size_t*>(e.tag);
+    for (size_t b = 0; b < num_blocks; ++b)
+    {
+        const size_t expected = (b % 2 == 0) ? 1 : 2;
+        STXXL_CHECK_EQUAL(popped[b], expected);
+    }
+
+    // removed while still running: must never be pushed
+    reqs.clear();
+    for (size_t b = 0; b < num_blocks; ++b)
+    {
+        reqs.push_back(file->awrite(buffer + b * block_size, b * block_size, block_size));
+        cq.add(reqs.back(), &popped[b]);
+    }
+    for (size_t b = 0; b < num_blocks; ++b)
+        STXXL_CHECK(cq.remove(reqs[b]));
+    STXXL_CHECK(cq.empty());
+    foxxll::wait_all(reqs.begin(), reqs.end());
+    STXXL_CHECK_EQUAL(cq.ready(), 0u);
+
+
+    foxxll::aligned_dealloc<4096>(buffer);
+    file->close_remove();
+
+    // the kernel serves linuxaio requests without a worker to hold up
+    if (strcmp(argv[1], "syscall") == 0 || strcmp(argv[1], "memory") == 0)
+        test_boost(argv[1], argv[2], fresh_queue_id());
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
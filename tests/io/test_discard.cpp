@@ -0,0 +1,105 @@
+/***************************************************************************
+ *  tests/io/test_discard.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! \example io/test_discard.cpp
+//! This tests discard() on a file created with the discard option: freed
+//! regions read back as zeros once released, writes to a freshly discarded
+//! region are not lost, and the remaining data stays intact.
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/io.hpp>
+#include <foxxll/mng.hpp>
+#include <foxxll/verbose.hpp>
+
+#include <chrono>
+#include <thread>
+
+#include <sys/stat.h>
+
+static uint64_t allocated_bytes(const std::string& path)
+{
+    struct stat st;
+    STXXL_CHECK(stat(path.c_str(), &st) == 0);
+    return uint64_t(st.st_blocks) * 512;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: " << argv[0] << " filetype tempfile" << std::endl;
+        return -1;
+    }
+
+    const size_t block_size = 1024 * 1024;
+    const size_t num_blocks = 16;
+    const size_t words = block_size / sizeof(size_t);
+
+    foxxll::disk_config cfg(argv[2], 0, std::string(argv[1]) + " discard");
+    cfg.direct = foxxll::disk_config::DIRECT_OFF;
+    foxxll::file_ptr file = foxxll::create_file(
+        cfg, foxxll::file::CREAT | foxxll::file::RDWR | foxxll::file::TRUNC);
+
+    size_t* buffer = static_cast<size_t*>(
+        foxxll::aligned_alloc<STXXL_BLOCK_ALIGN>(block_size * num_blocks));
+
+    for (size_t i = 0; i < words * num_blocks; ++i)
+        buffer[i] = i + 1;
+    file->awrite(buffer, 0, block_size * num_blocks)->wait();
+
+    const uint64_t before = allocated_bytes(argv[2]);
+
+    // discard the odd blocks, and the upper half entirely
+    for (size_t b = 1; b < num_blocks; b += 2)
+        file->discard(b * block_size, block_size);
+    for (size_t b = num_blocks / 2; b < num_blocks; b += 2)
+        file->discard(b * block_size, block_size);
+
+    // immediately reuse one block, its data must survive the background
+    // release of the surrounding region
+    const size_t reused = num_blocks - 3;
+    file->awrite(buffer + reused * words, reused * block_size, block_size)->wait();
+
+    // wait for the space to be released, unless the file system cannot
+    bool released = false;
+    for (size_t i = 0; i < 100 && !released; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        released = allocated_bytes(argv[2]) <= before - (num_blocks / 2 + 2) * block_size;
+    }
+    STXXL_MSG("allocated before=" << before << " after=" << allocated_bytes(argv[2]) <<
+              (released ? "" : " (discard not supported by file system)"));
+
+    size_t* check = static_cast<size_t*>(
+        foxxll::aligned_alloc<STXXL_BLOCK_ALIGN>(block_size * num_blocks));
+    file->aread(check, 0, block_size * num_blocks)->wait();
+
+    for (size_t b = 0; b < num_blocks; ++b)
+    {
+        bool kept = (b % 2 == 0 && b < num_blocks / 2) || b == reused;
+        for (size_t i = b * words; i < (b + 1) * words; ++i)
+        {
+            if (kept || !released)
+                STXXL_CHECK_EQUAL(check[i], buffer[i]);
+            else
+                STXXL_CHECK_EQUAL(check[i], 0u);
+        }
+    }
+
+    foxxll::aligned_dealloc<STXXL_BLOCK_ALIGN>(check);
+    foxxll::aligned_dealloc<STXXL_BLOCK_ALIGN>(buffer);
+
+    file->close_remove();
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
@@ -0,0 +1,198 @@
+/***************************************************************************
+ *  tests/io/test_elevator_queue.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! \example io/test_elevator_queue.cpp
+//! Submits requests in random order to a request_queue_impl_elevator while
+//! its worker is held up by the completion handler of a first request, such
+//! that all of them are pending at once. They must be served in ascending
+//! order of their offsets, merged into few vectored I/Os, with writes to the
+//! same offset served in submission order.
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/io.hpp>
+#include <foxxll/verbose.hpp>
+
+#include "held_queue.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const size_t block_size = 16 * 1024;
+static const size_t num_blocks = 256;
+static const size_t words = block_size / sizeof(size_t);
+
+//! submit the requests for blocks in the given order after a gating request
+//! for block 0, and wait for all. Block b + num_blocks is transferred from or
+//! to the buffer of b + num_blocks, but file block b.
+static void submit_gated(
+    foxxll::file_ptr& file, size_t* buffer, const std::vector<size_t>& order,
+    foxxll::request::read_or_write op, size_t num_canceled = 0)
+{
+    std::vector<foxxll::request_ptr> reqs;
+
+    s_holding = false;
+    s_released = false;
+    if (op == foxxll::request::READ)
+        reqs.push_back(file->aread(buffer, 0, block_size, hold_worker));
+    else
+        reqs.push_back(file->awrite(buffer, 0, block_size, hold_worker));
+
+    // the gating request is served on its own
+    while (!s_holding)
+        std::this_thread::yield();
+
+    for (size_t b : order)
+    {
+        size_t* block = buffer + b * words;
+        const size_t offset = (b % num_blocks) * block_size;
+        if (op == foxxll::request::READ)
+            reqs.push_back(file->aread(block, offset, block_size));
+        else
+            reqs.push_back(file->awrite(block, offset, block_size));
+    }
+
+    // all requests but the gating one are still pending
+    for (size_t i = 0; i < num_canceled; ++i)
+        STXXL_CHECK(reqs[reqs.size() - 1 - i]->cancel());
+
+    s_released = true;
+    foxxll::wait_all(reqs.begin(), reqs.end());
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: " << argv[0] << " filetype tempfile" << std::endl;
+        return -1;
+    }
+
+    // use a queue id of its own, such that a fresh queue is created
+    const int queue_id = fresh_queue_id();
+
+    size_t* buffer = (size_t*)foxxll::aligned_alloc<4096>(2 * block_size * num_blocks);
+
+    foxxll::file_ptr file = foxxll::create_file(
+        argv[1], argv[2],
+        foxxll::file::CREAT | foxxll::file::RDWR | foxxll::file::DIRECT,
+        queue_id);
+    file->set_size(block_size * num_blocks);
+
+    // a bound of 10 s keeps the sweep order for this test
+    foxxll::disk_queues::get_instance()->make_queue(file.get(), 0, true, 10000);
+
+    foxxll::request_queue_impl_elevator* queue =
+        dynamic_cast<foxxll::request_queue_impl_elevator*>(
+            foxxll::disk_queues::get_instance()->get_queue(queue_id));
+    STXXL_CHECK(queue != nullptr);
+
+    std::vector<size_t> order;
+    for (size_t b = 1; b < num_blocks; ++b)
+        order.push_back(b);
+
+    std::mt19937 rng(42);
+    foxxll::file_stats* fs = file->get_file_stats();
+
+    // write all blocks twice in random order, the second round has to win
+    std::vector<size_t> twice(order);
+    std::shuffle(twice.begin(), twice.end(), rng);
+    for (size_t b : order)
+        twice.push_back(b + num_blocks);
+    std::shuffle(twice.begin() + order.size(), twice.end(), rng);
+
+    for (size_t i = 0; i < words * num_blocks; ++i)
+    {
+        buffer[i] = ~i;
+        buffer[words * num_blocks + i] = i;
+    }
+    std::fill(buffer, buffer + words, 0);
+
+    const unsigned writes_before = fs->get_write_count();
+    const unsigned write_merges_before = fs->get_write_merges();
+    submit_gated(file, buffer, twice, foxxll::request::WRITE);
+    const unsigned writes = fs->get_write_count() - writes_before;
+    const unsigned write_ios = writes - (fs->get_write_merges() - write_merges_before);
+
+    // every request is counted, merged ones separately
+    STXXL_CHECK_EQUAL(writes, 2 * order.size() + 1);
+
+    // the gating request, then each round as one sweep of merged writes
+    STXXL_MSG("writes: " << writes << " requests, " << write_ios << " I/Os");
+#if defined(__linux__)
+    if (std::string(file->io_type()) == "syscall")
+    {
+        const unsigned expected = 1 + 2 * ((order.size() + 63) / 64);
+        STXXL_CHECK_EQUAL(write_ios, expected);
+    }
+#endif
+
+    // read back in reverse order
+    std::fill(buffer, buffer + words * num_blocks, 0);
+    std::reverse(order.begin(), order.end());
+
+    const unsigned reads_before = fs->get_read_count();
+    const unsigned read_merges_before = fs->get_read_merges();
+    submit_gated(file, buffer, order, foxxll::request::READ);
+    const unsigned reads = fs->get_read_count() - reads_before;
+    const unsigned read_ios = reads - (fs->get_read_merges() - read_merges_before);
+
+    STXXL_CHECK_EQUAL(reads, order.size() + 1);
+
+    STXXL_MSG("reads: " << reads << " requests, " << read_ios << " I/Os");
+#if defined(__linux__)
+    if (std::string(file->io_type()) == "syscall")
+    {
+        const unsigned expected = 1 + (order.size() + 63) / 64;
+        STXXL_CHECK_EQUAL(read_ios, expected);
+    }
+#endif
+
+    for (size_t i = words; i < words * num_blocks; ++i)
+        STXXL_CHECK_EQUAL(buffer[i], i);
+
+    // canceled requests are never served
+    std::fill(buffer, buffer + words * num_blocks, 0);
+    submit_gated(file, buffer, order, foxxll::request::READ, 16);
+    for (size_t b = 1; b < num_blocks; ++b)
+    {
+        const size_t expected = (b <= 16) ? 0 : b * words;
+        STXXL_CHECK_EQUAL(buffer[b * words], expected);
+    }
+
+    // a vectored read past the end of file is filled with zeroes
+    if (std::string(file->io_type()) == "syscall")
+    {
+        std::fill(buffer, buffer + 2 * words, 1);
+        const foxxll::file::io_vector vec[2] = {
+            { buffer, block_size }, { buffer + words, block_size }
+        };
+        file->serve_vectored(vec, 2, (num_blocks - 1) * block_size, foxxll::request::READ);
+        const size_t expected = (num_blocks - 1) * words;
+        STXXL_CHECK_EQUAL(buffer[0], expected);
+        STXXL_CHECK_EQUAL(buffer[2 * words - 1], 0u);
+    }
+
+    foxxll::queue_stats_data qs =
+        foxxll::disk_queues::get_instance()->get_queue_stats(queue_id);
+    STXXL_CHECK_EQUAL(qs.get_waiting(), 0u);
+    STXXL_CHECK_EQUAL(qs.get_in_service(), 0u);
+    STXXL_CHECK_EQUAL(queue->num_expired(), 0u);
+
+    foxxll::aligned_dealloc<4096>(buffer);
+    file->close_remove();
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
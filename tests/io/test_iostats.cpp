@@ -0,0 +1,218 @@
+/***************************************************************************
+ *  tests/io/test_iostats.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! \example io/test_iostats.cpp
+//! Updates file_stats and wait statistics from several threads: counts and
+//! bytes must add up exactly, serialized times must sum all operations, and
+//! parallel times must count overlapping operations only once. Checks the
+//! latency histograms, the CSV and JSON output, and the periodic sampler, and
+//! reports the update throughput.
+
+#include <foxxll/common/timer.hpp>
+#include <foxxll/io/iostats.hpp>
+#include <foxxll/io/stats_sampler.hpp>
+#include <foxxll/verbose.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    const size_t num_threads = 8;
+    const size_t num_ops = (argc >= 2) ? strtoul(argv[1], nullptr, 10) : 1000000;
+
+    foxxll::stats* s = foxxll::stats::get_instance();
+    foxxll::file_stats* fs = s->create_file_stats(1000);
+
+    // overlapping operations of known duration
+    {
+        foxxll::stats_data begin(*s);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < num_threads; ++t)
+        {
+            threads.emplace_back(
+                [fs]() {
+                    for (size_t i = 0; i < 5; ++i)
+                    {
+                        foxxll::file_stats::scoped_read_timer read_timer(fs, 4096);
+                        foxxll::stats::scoped_wait_timer wait_timer(
+                            foxxll::stats::WAIT_OP_READ);
+                        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    }
+                });
+        }
+        for (std::thread& t : threads)
+            t.join();
+        foxxll::stats_data diff = foxxll::stats_data(*s) - begin;
+
+        STXXL_MSG("read_time=" << fs->get_read_time() <<
+                  " pread_time=" << diff.get_pread_time() <<
+                  " wait_read_time=" << diff.get_wait_read_time() <<
+                  " elapsed=" << diff.get_elapsed_time());
+
+        STXXL_CHECK_EQUAL(fs->get_read_count(), num_threads * 5);
+        STXXL_CHECK_EQUAL(fs->get_read_bytes(), num_threads * 5 * 4096);
+        STXXL_CHECK(fs->get_read_time() >= num_threads * 5 * 0.02);
+        STXXL_CHECK(diff.get_wait_read_time() >= num_threads * 5 * 0.02);
+        STXXL_CHECK(diff.get_pread_time() >= 5 * 0.02);
+        STXXL_CHECK(diff.get_pread_time() <= diff.get_elapsed_time());
+        STXXL_CHECK(diff.get_pio_time() >= diff.get_pread_time());
+        STXXL_CHECK_EQUAL(diff.get_pwrite_time(), 0.0);
+    }
+
+    // throughput of concurrent updates
+    {
+        double ts = foxxll::timestamp();
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < num_threads; ++t)
+        {
+            threads.emplace_back(
+                [fs, num_ops]() {
+                    for (size_t i = 0; i < num_ops; ++i)
+                    {
+                        fs->write_started(1);
+                        fs->write_finished();
+                    }
+                });
+        }
+        for (std::thread& t : threads)
+            t.join();
+        double elapsed = foxxll::timestamp() - ts;
+
+        STXXL_MSG("updates=" << num_threads * num_ops << " time=" << elapsed <<
+                  " s rate=" << num_threads * num_ops / elapsed << " ops/s");
+
+        STXXL_CHECK_EQUAL(fs->get_write_count(), num_threads * num_ops);
+        STXXL_CHECK_EQUAL(fs->get_write_bytes(), num_threads * num_ops);
+    }
+
+    // latency histograms
+    {
+        using foxxll::latency_histogram;
+
+        // buckets are contiguous and cover their begin values
+        for (size_t b = 0; b < latency_histogram::num_buckets; ++b)
+        {
+            STXXL_CHECK_EQUAL(latency_histogram::bucket(latency_histogram::bucket_begin(b)), b);
+            if (b + 1 < latency_histogram::num_buckets) {
+                STXXL_CHECK(latency_histogram::bucket_begin(b) < latency_histogram::bucket_begin(b + 1));
+                STXXL_CHECK_EQUAL(latency_histogram::bucket(latency_histogram::bucket_begin(b + 1) - 1), b);
+            }
+        }
+
+        foxxll::stats_data begin(*s);
+
+        // 900 reads served in 1 ms, 100 in 100 ms, all queued for 10 ms
+        for (size_t i = 0; i < 1000; ++i)
+            fs->add_latency(false, 1.0, 1.01, i < 900 ? 1.011 : 1.11);
+        // writes without known submission time
+        fs->add_latency(true, 0.0, 2.0, 2.5);
+
+        foxxll::stats_data diff = foxxll::stats_data(*s) - begin;
+        latency_histogram rq = diff.get_read_queue_latency();
+        latency_histogram rs = diff.get_read_service_latency();
+
+        STXXL_MSG("read latency p50=" << rs.percentile(50) <<
+                  " p99=" << rs.percentile(99) << " queue p50=" << rq.percentile(50));
+
+        STXXL_CHECK_EQUAL(rq.count(), 1000u);
+        STXXL_CHECK_EQUAL(rs.count(), 1000u);
+        STXXL_CHECK(std::abs(rs.percentile(50) - 0.001) < 0.0002);
+        STXXL_CHECK(std::abs(rs.percentile(90) - 0.001) < 0.0002);
+        STXXL_CHECK(std::abs(rs.percentile(99) - 0.1) < 0.02);
+        STXXL_CHECK(std::abs(rq.percentile(50) - 0.01) < 0.002);
+        STXXL_CHECK_EQUAL(diff.get_write_queue_latency().count(), 0u);
+        STXXL_CHECK_EQUAL(diff.get_write_service_latency().count(), 1u);
+        STXXL_CHECK(std::abs(diff.get_write_service_latency().percentile(100) - 0.5) < 0.1);
+    }
+
+    // machine-readable output
+    {
+        foxxll::queue_stats* qs = s->create_queue_stats(1000);
+        qs->added();
+        foxxll::stats_data sd(*s);
+
+        std::ostringstream csv;
+        foxxll::stats_data::csv_header(csv, "x,");
+        sd.to_csv(csv, "1,");
+
+        std::istringstream lines(csv.str());
+        std::string line;
+        size_t num_lines = 0, num_queue_lines = 0;
+        while (std::getline(lines, line))
+        {
+            size_t columns = std::count(line.begin(), line.end(), ',') + 1;
+            STXXL_CHECK_EQUAL(columns, 2 + 9 + 4 * 5 + 11);
+            STXXL_CHECK_EQUAL(line.compare(0, 2, num_lines ? "1," : "x,"), 0);
+            // queue lines leave device_id and the other file columns empty
+            if (num_lines && line[line.find(',', 2) + 1] == ',')
+                ++num_queue_lines;
+            ++num_lines;
+        }
+        const size_t num_queues = sd.get_queue_stats().size();
+        STXXL_CHECK_EQUAL(num_lines, 1 + sd.num_files() + num_queues);
+        STXXL_CHECK(num_queues >= 1);
+        STXXL_CHECK_EQUAL(num_queue_lines, num_queues);
+        STXXL_CHECK(csv.str().find(",1000,1,0,1,0,1,") != std::string::npos);
+
+        std::ostringstream oss;
+        sd.to_json(oss);
+        const std::string json = oss.str();
+        STXXL_CHECK_EQUAL(json.compare(0, 11, "{\"elapsed\":"), 0);
+        STXXL_CHECK(json.find("{\"device_id\":1000,\"read_count\":40,") != std::string::npos);
+        STXXL_CHECK_EQUAL(std::count(json.begin(), json.end(), '{'),
+                          std::count(json.begin(), json.end(), '}'));
+    }
+
+    // periodic sampler
+    {
+        const char* path = "test_iostats_sampler.json";
+        {
+            foxxll::stats_sampler sampler(path, 10, foxxll::stats_sampler::JSON);
+            for (size_t i = 0; i < 5; ++i)
+            {
+                foxxll::file_stats::scoped_write_timer write_timer(fs, 4096);
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        }
+
+        std::ifstream in(path);
+        std::string line;
+        size_t num_samples = 0;
+        size_t writes = 0;
+        while (std::getline(in, line))
+        {
+            STXXL_CHECK_EQUAL(line.compare(0, 8, "{\"time\":"), 0);
+            size_t pos = line.find("\"device_id\":1000,");
+            STXXL_CHECK(pos != std::string::npos);
+            pos = line.find("\"write_count\":", pos);
+            writes += std::stoul(line.substr(pos + 14));
+            ++num_samples;
+        }
+        std::remove(path);
+
+        STXXL_MSG("sampler wrote " << num_samples << " samples");
+        STXXL_CHECK(num_samples >= 2);
+        // deltas add up to the operations done while sampling
+        STXXL_CHECK_EQUAL(writes, 5u);
+    }
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
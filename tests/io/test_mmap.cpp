@@ -54,6 +54,108 @@ void testIO()
     file2->close_remove();
 }
 
+void testWindows()
+{
+#if !STXXL_WINDOWS
+    const char* path = "/var/tmp/data_windows";
+    const size_t window = 64 * 1024;
+    const size_t size = 5 * window + 4096;
+    const size_t words = size / sizeof(size_t);
+
+    size_t* buffer = static_cast<size_t*>(
+        foxxll::aligned_alloc<STXXL_BLOCK_ALIGN>(2 * size));
+
+    foxxll::file_ptr file(new foxxll::mmap_file(
+                              path, foxxll::file::CREAT | foxxll::file::RDWR, 0,
+                              foxxll::file::NO_ALLOCATOR,
+                              foxxll::file::DEFAULT_DEVICE_ID, nullptr, window));
+    file->set_size(window);
+
+    // write across window boundaries, growing the file
+    for (size_t i = 0; i < words; ++i)
+        buffer[i] = i;
+    file->awrite(buffer, 4096, size)->wait();
+    STXXL_CHECK_EQUAL(file->size(), 4096 + size);
+
+    // shrink and grow again, which remaps the last windows
+    file->set_size(3 * window);
+    file->set_size(8 * window);
+
+    // read including a part past the end of file, which is zero filled
+    memset(buffer, 0xFF, 2 * size);
+    file->aread(buffer, 4096, 2 * size)->wait();
+    for (size_t i = 0; i < words; ++i)
+    {
+        size_t expected = (4096 + i * sizeof(size_t) < 3 * window) ? i : 0;
+        STXXL_CHECK_EQUAL(buffer[i], expected);
+    }
+    for (size_t i = words; i < 2 * words; ++i)
+        STXXL_CHECK_EQUAL(buffer[i], 0u);
+
+    // blocks within one window can be viewed in place, others cannot
+    {
+        foxxll::mapped_block view = file->try_map_block(window, window);
+        STXXL_CHECK(view.valid());
+        STXXL_CHECK_EQUAL(static_cast<const size_t*>(view.data())[0],
+                          (window - 4096) / sizeof(size_t));
+        STXXL_CHECK(!file->try_map_block(window / 2, window).valid());
+
+    }
+    {
+        // a view stays valid when its window is remapped by the file
+        file->set_size(3 * window + 8192);
+        foxxll::mapped_block view = file->try_map_block(3 * window, 4096);
+        STXXL_CHECK(view.valid());
+        file->set_size(8 * window);
+        STXXL_CHECK(view.data() != file->try_map_block(3 * window, 4096).data());
+        STXXL_CHECK_EQUAL(static_cast<const size_t*>(view.data())[0], 0u);
+    }
+
+    // without the discard option, discarding releases nothing
+    file->discard(0, window + 2048);
+    file->aread(buffer, 4096, window)->wait();
+    for (size_t i = 0; i < window / sizeof(size_t); ++i)
+        STXXL_CHECK_EQUAL(buffer[i], i);
+
+    foxxll::aligned_dealloc<STXXL_BLOCK_ALIGN>(buffer);
+    file->close_remove();
+#endif
+}
+
+void testWriteOnly()
+{
+#if !STXXL_WINDOWS
+    const char* path = "/var/tmp/data_write_only";
+    const size_t size = 64 * 1024;
+    const size_t words = size / sizeof(size_t);
+
+    size_t* buffer = static_cast<size_t*>(
+        foxxll::aligned_alloc<STXXL_BLOCK_ALIGN>(size));
+    for (size_t i = 0; i < words; ++i)
+        buffer[i] = i;
+
+    {
+        // cannot be mapped, writes go through pwrite()
+        foxxll::file_ptr file = tlx::make_counting<foxxll::mmap_file>(
+            path, foxxll::file::CREAT | foxxll::file::WRONLY, 0);
+        file->awrite(buffer, size, size)->wait();
+        STXXL_CHECK_EQUAL(file->size(), 2 * size);
+        STXXL_CHECK(!file->try_map_block(size, size).valid());
+        STXXL_CHECK_THROW(file->aread(buffer, 0, size)->wait(), foxxll::io_error);
+    }
+
+    memset(buffer, 0xFF, size);
+    foxxll::file_ptr file = tlx::make_counting<foxxll::mmap_file>(
+        path, foxxll::file::RDWR, 0);
+    file->aread(buffer, size, size)->wait();
+    for (size_t i = 0; i < words; ++i)
+        STXXL_CHECK_EQUAL(buffer[i], i);
+
+    foxxll::aligned_dealloc<STXXL_BLOCK_ALIGN>(buffer);
+    file->close_remove();
+#endif
+}
+
 void testIOException()
 {
     foxxll::file::unlink("TestFile");
@@ -65,5 +167,7 @@ void testIOException()
 int main()
 {
     testIO();
+    testWindows();
+    testWriteOnly();
     testIOException();
 }
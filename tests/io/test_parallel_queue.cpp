@@ -0,0 +1,133 @@
+/***************************************************************************
+ *  tests/io/test_parallel_queue.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/io.hpp>
+#include <foxxll/mng.hpp>
+#include <foxxll/verbose.hpp>
+
+#include <sstream>
+#include <vector>
+
+//! \example io/test_parallel_queue.cpp
+//! This tests a request queue with several worker threads per disk: writes
+//! to the same offset must be served in submission order, and all data must
+//! read back correctly.
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        std::cout << "Usage: " << argv[0] << " filetype tempfile threads" << std::endl;
+        return -1;
+    }
+
+    const int num_threads = atoi(argv[3]);
+    const size_t block_size = 16 * 1024;
+    const size_t num_blocks = 256;
+    const size_t rounds = 4;
+    const size_t words = block_size / sizeof(size_t);
+
+    // use a queue id of its own, such that a fresh queue is created
+    const int queue_id = 1000;
+
+    size_t* buffer = (size_t*)foxxll::aligned_alloc<4096>(
+        block_size * num_blocks * rounds);
+
+    foxxll::file_ptr file = foxxll::create_file(
+        argv[1], argv[2],
+        foxxll::file::CREAT | foxxll::file::RDWR | foxxll::file::DIRECT,
+        queue_id);
+    file->set_size(block_size * num_blocks);
+
+    foxxll::disk_queues::get_instance()->make_queue(file.get(), num_threads);
+
+    // write every block several times, the last round has to win
+    std::vector<foxxll::request_ptr> reqs;
+    for (size_t r = 0; r < rounds; ++r)
+    {
+        for (size_t b = 0; b < num_blocks; ++b)
+        {
+            size_t* block = buffer + (r * num_blocks + b) * words;
+            for (size_t i = 0; i < words; ++i)
+                block[i] = (r * num_blocks + b) * words + i;
+
+            reqs.push_back(file->awrite(block, b * block_size, block_size));
+        }
+    }
+    foxxll::wait_all(reqs.begin(), reqs.end());
+    reqs.clear();
+
+    // all requests went through the queue, which is drained now
+    {
+        foxxll::queue_stats_data qs =
+            foxxll::disk_queues::get_instance()->get_queue_stats(queue_id);
+        STXXL_MSG("queue depth: avg " << qs.get_avg_waiting() << "/" <<
+                  qs.get_avg_in_service() << ", max " << qs.get_max_waiting() <<
+                  "/" << qs.get_max_in_service());
+        STXXL_CHECK_EQUAL(qs.get_queue_id(), queue_id);
+        STXXL_CHECK_EQUAL(qs.get_waiting(), 0u);
+        STXXL_CHECK_EQUAL(qs.get_in_service(), 0u);
+        STXXL_CHECK(qs.get_max_depth() > 0);
+        STXXL_CHECK(qs.get_max_depth() <= rounds * num_blocks);
+        STXXL_CHECK(qs.get_max_in_service() >= 1);
+        STXXL_CHECK(qs.get_avg_waiting() >= 0.0);
+        STXXL_CHECK(qs.get_utilization() >= 0.0 && qs.get_utilization() <= 1.0);
+    }
+
+    for (size_t i = 0; i < words * num_blocks; ++i)
+        buffer[i] = ~size_t(0);
+
+    for (size_t b = 0; b < num_blocks; ++b)
+        reqs.push_back(file->aread(buffer + b * words, b * block_size, block_size));
+    foxxll::wait_all(reqs.begin(), reqs.end());
+    reqs.clear();
+
+    for (size_t b = 0; b < num_blocks; ++b)
+    {
+        for (size_t i = 0; i < words; ++i)
+        {
+            STXXL_CHECK_EQUAL(buffer[b * words + i],
+                              ((rounds - 1) * num_blocks + b) * words + i);
+        }
+    }
+
+    // cancel some requests while workers are busy
+    size_t canceled = 0;
+    for (size_t b = 0; b < num_blocks; ++b)
+        reqs.push_back(file->aread(buffer + b * words, b * block_size, block_size));
+    for (size_t b = num_blocks; b-- > 0; )
+        canceled += reqs[b]->cancel() ? 1 : 0;
+    foxxll::wait_all(reqs.begin(), reqs.end());
+    reqs.clear();
+
+    STXXL_MSG("Canceled " << canceled << " of " << num_blocks << " requests");
+
+    // canceled requests must have left the gauges as well
+    {
+        foxxll::queue_stats_data qs =
+            foxxll::disk_queues::get_instance()->get_queue_stats(queue_id);
+        STXXL_CHECK_EQUAL(qs.get_waiting(), 0u);
+        STXXL_CHECK_EQUAL(qs.get_in_service(), 0u);
+
+        std::ostringstream json;
+        foxxll::stats_data(*foxxll::stats::get_instance()).to_json(json);
+        STXXL_CHECK(json.str().find("\"queues\":[") != std::string::npos);
+    }
+
+    file->close_remove();
+
+    foxxll::aligned_dealloc<4096>(buffer);
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
@@ -0,0 +1,193 @@
+/***************************************************************************
+ *  tests/io/test_priority_classes.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! \example io/test_priority_classes.cpp
+//! Checks the weighted fair sharing among priority classes, then holds up the
+//! worker of a disk queue, submits a backlog of write-back and then a few
+//! demand reads. The reads must overtake the write-back.
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/io.hpp>
+#include <foxxll/verbose.hpp>
+
+#include "held_queue.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using foxxll::request;
+
+static void test_fair_share()
+{
+    foxxll::fair_share share(foxxll::priority_weights { { 8, 4, 1 } });
+    size_t served[request::num_priority_classes] = { 0, 0, 0 };
+
+    // all classes backlogged with equally sized requests
+    for (size_t i = 0; i < 13 * 10; ++i)
+    {
+        size_t c = share.pick([](size_t) { return true; });
+        share.charge(c, 4096);
+        ++served[c];
+    }
+    STXXL_CHECK_EQUAL(served[request::DEMAND], 80u);
+    STXXL_CHECK_EQUAL(served[request::PREFETCH], 40u);
+    STXXL_CHECK_EQUAL(served[request::WRITEBACK], 10u);
+
+    // an idle class does not catch up on its share later
+    for (size_t i = 0; i < 100; ++i)
+    {
+        size_t c = share.pick([](size_t c) { return c != request::PREFETCH; });
+        STXXL_CHECK(c != request::PREFETCH);
+        share.charge(c, 4096);
+    }
+    served[request::PREFETCH] = 0;
+    for (size_t i = 0; i < 13; ++i)
+    {
+        size_t c = share.pick([](size_t) { return true; });
+        share.charge(c, 4096);
+        served[c] += (c == request::PREFETCH);
+    }
+    STXXL_CHECK(served[request::PREFETCH] <= 5u);
+
+    // nothing eligible
+    const size_t none = share.pick([](size_t) { return false; });
+    STXXL_CHECK_EQUAL(none, request::num_priority_classes);
+}
+
+static void test_scoped_priority_class()
+{
+    using foxxll::scoped_priority_class;
+
+    STXXL_CHECK_EQUAL(scoped_priority_class::current(request::READ), request::DEMAND);
+    STXXL_CHECK_EQUAL(scoped_priority_class::current(request::WRITE), request::WRITEBACK);
+    {
+        scoped_priority_class outer(request::PREFETCH);
+        STXXL_CHECK_EQUAL(scoped_priority_class::current(request::READ), request::PREFETCH);
+        {
+            scoped_priority_class inner(request::DEMAND);
+            STXXL_CHECK_EQUAL(scoped_priority_class::current(request::WRITE), request::DEMAND);
+        }
+        STXXL_CHECK_EQUAL(scoped_priority_class::current(request::WRITE), request::PREFETCH);
+    }
+    STXXL_CHECK_EQUAL(scoped_priority_class::current(request::READ), request::DEMAND);
+}
+
+//! Submits write-back and demand reads to a held up queue. The classes must be
+//! served in the order fair_share gives for the queue's state, which after
+//! the gate write has charged the write-back puts the reads first.
+static void test_queue(const char* filetype, const char* filename,
+                       int queue_id, bool elevator)
+{
+    const size_t block_size = 16 * 1024;
+    const size_t num_writes = 64;
+    const size_t num_reads = 8;
+    const size_t words = block_size / sizeof(size_t);
+
+    size_t* buffer = (size_t*)foxxll::aligned_alloc<4096>(
+        (num_writes + num_reads + 1) * block_size);
+
+    foxxll::file_ptr file = foxxll::create_file(
+        filetype, filename,
+        foxxll::file::CREAT | foxxll::file::RDWR | foxxll::file::DIRECT,
+        queue_id);
+    file->set_size(block_size * (num_writes + num_reads + 1));
+
+    foxxll::disk_queues* queues = foxxll::disk_queues::get_instance();
+    queues->make_queue(file.get(), 0, elevator);
+
+    // the queue's fair share state is that of a fresh queue, do not rely on
+    // the default weights either
+    const foxxll::priority_weights weights { { 8, 4, 1 } };
+    queues->get_queue(queue_id)->set_priority_weights(weights);
+
+    completion_order completed;
+
+    s_holding = false;
+    s_released = false;
+
+    // gate on the last block
+    foxxll::request_ptr gate = file->awrite(
+        buffer + (num_writes + num_reads) * words,
+        (num_writes + num_reads) * block_size, block_size, hold_worker);
+    while (!s_holding)
+        std::this_thread::yield();
+
+    std::vector<foxxll::request_ptr> reqs;
+    for (size_t b = 0; b < num_writes; ++b)
+    {
+        reqs.push_back(file->awrite(
+                           buffer + b * words, b * block_size, block_size,
+                           completed.record(b)));
+        STXXL_CHECK_EQUAL(reqs.back()->get_priority_class(), request::WRITEBACK);
+    }
+    for (size_t b = num_writes; b < num_writes + num_reads; ++b)
+    {
+        reqs.push_back(file->aread(
+                           buffer + b * words, b * block_size, block_size,
+                           completed.record(b)));
+        STXXL_CHECK_EQUAL(reqs.back()->get_priority_class(), request::DEMAND);
+    }
+
+    s_released = true;
+    gate->wait();
+    foxxll::wait_all(reqs.begin(), reqs.end());
+
+    STXXL_CHECK_EQUAL(completed.order.size(), num_writes + num_reads);
+
+    // replay the queue's fair share: the gate is charged first, then each
+    // request, or each merged batch of adjacent requests in the elevator
+    const size_t max_merge = 64; // serving_request::max_merge
+    foxxll::fair_share share(weights);
+    share.charge(request::WRITEBACK, block_size);
+    size_t left[request::num_priority_classes] = { num_reads, 0, num_writes };
+    std::vector<size_t> expected;
+    while (expected.size() < num_writes + num_reads)
+    {
+        size_t c = share.pick([&left](size_t k) { return left[k] != 0; });
+        size_t n = elevator ? std::min(left[c], max_merge) : 1;
+        share.charge(c, n * block_size);
+        left[c] -= n;
+        expected.insert(expected.end(), n, c);
+    }
+
+    for (size_t i = 0; i < completed.order.size(); ++i)
+    {
+        const size_t c = completed.order[i] < num_writes
+                         ? request::WRITEBACK : request::DEMAND;
+        STXXL_CHECK_EQUAL(c, expected[i]);
+    }
+    // which with these weights are all the reads
+    for (size_t i = 0; i < num_reads; ++i)
+        STXXL_CHECK(completed.order[i] >= num_writes);
+
+    foxxll::aligned_dealloc<4096>(buffer);
+    file->close_remove();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: " << argv[0] << " filetype tempfile" << std::endl;
+        return -1;
+    }
+
+    test_fair_share();
+    test_scoped_priority_class();
+
+    test_queue(argv[1], argv[2], fresh_queue_id(), false);
+    test_queue(argv[1], argv[2], fresh_queue_id(), true);
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
@@ -0,0 +1,117 @@
+/***************************************************************************
+ *  tests/io/test_read_forwarding.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! \example io/test_read_forwarding.cpp
+//! Holds up the worker of the default disk queue in the completion handler of
+//! a first request, submits writes and then reads of the same blocks. The
+//! reads must complete right away with the data of the waiting writes and
+//! without reading from the file.
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/io.hpp>
+#include <foxxll/verbose.hpp>
+
+#include "held_queue.hpp"
+
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: " << argv[0] << " filetype tempfile" << std::endl;
+        return -1;
+    }
+
+    const size_t block_size = 16 * 1024;
+    const size_t num_blocks = 64;
+    const size_t words = block_size / sizeof(size_t);
+
+    // use a queue id of its own, such that a fresh queue is created
+    const int queue_id = fresh_queue_id();
+
+    size_t* buffer = (size_t*)foxxll::aligned_alloc<4096>(3 * block_size * num_blocks);
+    size_t* wbuf = buffer;
+    size_t* rbuf = buffer + words * num_blocks;
+    size_t* tbuf = buffer + 2 * words * num_blocks;
+
+    foxxll::file_ptr file = foxxll::create_file(
+        argv[1], argv[2],
+        foxxll::file::CREAT | foxxll::file::RDWR | foxxll::file::DIRECT,
+        queue_id);
+    file->set_size(block_size * (num_blocks + 1));
+
+    for (size_t i = 0; i < words * num_blocks; ++i)
+    {
+        wbuf[i] = i;
+        rbuf[i] = 0;
+    }
+
+    std::vector<foxxll::request_ptr> writes, reads;
+
+    // gate on the block after the others
+    foxxll::request_ptr gate = file->awrite(
+        tbuf, num_blocks * block_size, block_size, hold_worker);
+    while (!s_holding)
+        std::this_thread::yield();
+
+    foxxll::file_stats* fs = file->get_file_stats();
+    const unsigned reads_before = fs->get_read_count();
+
+    for (size_t b = 0; b < num_blocks; ++b)
+        writes.push_back(file->awrite(wbuf + b * words, b * block_size, block_size));
+
+    // reads of whole blocks and of their first half
+    for (size_t b = 0; b < num_blocks; ++b)
+    {
+        const size_t bytes = (b % 2 == 0) ? block_size : block_size / 2;
+        reads.push_back(file->aread(rbuf + b * words, b * block_size, bytes));
+    }
+
+    // all reads are done while the writes are still waiting
+    for (size_t b = 0; b < num_blocks; ++b)
+    {
+        STXXL_CHECK(reads[b]->poll());
+        STXXL_CHECK(!writes[b]->poll());
+    }
+    STXXL_CHECK_EQUAL(fs->get_read_count(), reads_before);
+
+    for (size_t b = 0; b < num_blocks; ++b)
+    {
+        const size_t filled = (b % 2 == 0) ? words : words / 2;
+        for (size_t i = 0; i < words; ++i)
+        {
+            const size_t expected = (i < filled) ? b * words + i : 0;
+            STXXL_CHECK_EQUAL(rbuf[b * words + i], expected);
+        }
+    }
+
+    s_released = true;
+    gate->wait();
+    foxxll::wait_all(writes.begin(), writes.end());
+
+    // once written, reads go to the file again
+    for (size_t b = 0; b < num_blocks; ++b)
+        reads[b] = file->aread(tbuf + b * words, b * block_size, block_size);
+    foxxll::wait_all(reads.begin(), reads.end());
+
+    STXXL_CHECK_EQUAL(fs->get_read_count(), reads_before + num_blocks);
+    for (size_t i = 0; i < words * num_blocks; ++i)
+        STXXL_CHECK_EQUAL(tbuf[i], i);
+
+    foxxll::aligned_dealloc<4096>(buffer);
+    file->close_remove();
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
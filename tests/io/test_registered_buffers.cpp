@@ -0,0 +1,117 @@
+/***************************************************************************
+ *  tests/io/test_registered_buffers.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! \example io/test_registered_buffers.cpp
+//! Writes and reads blocks registered with the disk queues, while further
+//! blocks are registered and unregistered, which must neither stall the queue
+//! nor corrupt data. Also registers blocks before the file's queue exists,
+//! and checks that unregistered blocks, e.g. freed and allocated again at the
+//! same address, are transferred correctly.
+
+#include <foxxll/io.hpp>
+#include <foxxll/mng/typed_block.hpp>
+#include <foxxll/verbose.hpp>
+
+#include <vector>
+
+using block_type = foxxll::typed_block<64 * 1024, size_t>;
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: " << argv[0] << " filetype tempfile" << std::endl;
+        return -1;
+    }
+
+    const size_t num_blocks = 32;
+
+    // registered before the queue is created
+    foxxll::registered_blocks<block_type> blocks(num_blocks);
+
+    foxxll::file_ptr file = foxxll::create_file(
+        argv[1], argv[2],
+        foxxll::file::CREAT | foxxll::file::RDWR | foxxll::file::DIRECT);
+    file->set_size(2 * num_blocks * block_type::raw_size);
+
+    for (size_t round = 0; round < 4; ++round)
+    {
+        std::vector<foxxll::request_ptr> reqs;
+        for (size_t i = 0; i < num_blocks; ++i)
+        {
+            std::fill(blocks[i].begin(), blocks[i].end(), round * num_blocks + i);
+            reqs.push_back(file->awrite(
+                               &blocks[i], i * block_type::raw_size, block_type::raw_size));
+
+            // change the registered set while requests are in flight
+            if (i % 8 == 0)
+                foxxll::registered_blocks<block_type> other(2);
+        }
+        foxxll::wait_all(reqs.begin(), reqs.end());
+        reqs.clear();
+
+        for (size_t i = 0; i < num_blocks; ++i)
+        {
+            std::fill(blocks[i].begin(), blocks[i].end(), 0);
+            reqs.push_back(file->aread(
+                               &blocks[i], i * block_type::raw_size, block_type::raw_size));
+        }
+        foxxll::wait_all(reqs.begin(), reqs.end());
+
+        for (size_t i = 0; i < num_blocks; ++i)
+        {
+            for (const size_t& x : blocks[i])
+                STXXL_CHECK_EQUAL(x, round * num_blocks + i);
+        }
+    }
+
+    // blocks of registered arrays freed and allocated again use regular I/O
+    for (size_t round = 0; round < 4; ++round)
+    {
+        {
+            foxxll::registered_blocks<block_type> freed(num_blocks);
+        }
+        std::vector<block_type*> plain;
+        std::vector<foxxll::request_ptr> reqs;
+        for (size_t i = 0; i < num_blocks; ++i)
+        {
+            plain.push_back(new block_type);
+            std::fill(plain[i]->begin(), plain[i]->end(), round + i);
+            reqs.push_back(file->awrite(
+                               plain[i], (num_blocks + i) * block_type::raw_size,
+                               block_type::raw_size));
+        }
+        foxxll::wait_all(reqs.begin(), reqs.end());
+        reqs.clear();
+
+        for (size_t i = 0; i < num_blocks; ++i)
+        {
+            std::fill(plain[i]->begin(), plain[i]->end(), 0);
+            reqs.push_back(file->aread(
+                               plain[i], (num_blocks + i) * block_type::raw_size,
+                               block_type::raw_size));
+        }
+        foxxll::wait_all(reqs.begin(), reqs.end());
+
+        for (size_t i = 0; i < num_blocks; ++i)
+        {
+            for (const size_t& x : *plain[i])
+                STXXL_CHECK_EQUAL(x, round + i);
+            delete plain[i];
+        }
+    }
+
+    file->close_remove();
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
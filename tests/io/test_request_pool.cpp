@@ -0,0 +1,109 @@
+/***************************************************************************
+ *  tests/io/test_request_pool.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! \example io/test_request_pool.cpp
+//! Submits many small requests to a memory_file in batches and reports the
+//! request throughput. Request objects and queue entries are recycled by
+//! object pools, hence once the pools are warm, the I/O path must not call
+//! the global operator new anymore, which this test counts.
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/common/timer.hpp>
+#include <foxxll/io.hpp>
+#include <foxxll/verbose.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+static std::atomic<size_t> s_allocations { 0 };
+
+void* operator new (size_t bytes)
+{
+    ++s_allocations;
+    if (void* p = std::malloc(bytes ? bytes : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete (void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete (void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+int main(int argc, char** argv)
+{
+    const size_t num_requests = (argc >= 2) ? strtoul(argv[1], nullptr, 10) : 4000000;
+    const size_t batch_size = 64;
+    const size_t block_size = 4096;
+
+    foxxll::file_ptr file = tlx::make_counting<foxxll::memory_file>();
+    file->set_size(batch_size * block_size);
+
+    char* buffer = static_cast<char*>(
+        foxxll::aligned_alloc<4096>(batch_size * block_size));
+    std::vector<foxxll::request_ptr> reqs;
+    reqs.reserve(batch_size);
+
+    auto run_batch = [&](size_t round) {
+                         for (size_t i = 0; i < batch_size; ++i)
+                         {
+                             char* data = buffer + i * block_size;
+                             if (round % 2 == 0)
+                                 reqs.push_back(file->awrite(data, i * block_size, block_size));
+                             else
+                                 reqs.push_back(file->aread(data, i * block_size, block_size));
+                         }
+                         foxxll::wait_all(reqs.begin(), reqs.end());
+                         reqs.clear();
+                     };
+
+    // fill the pools: objects freed by the I/O thread circulate back only
+    // once its cache overflows, so run until a while passes without malloc
+    for (size_t r = 0, quiet = 0; quiet < 1000 && r < 100000; ++r)
+    {
+        const size_t before = s_allocations.load();
+        run_batch(r);
+        quiet = (s_allocations.load() == before) ? quiet + 1 : 0;
+    }
+
+    const size_t num_batches = (num_requests + batch_size - 1) / batch_size;
+    const size_t allocations = s_allocations.load();
+
+    double ts = foxxll::timestamp();
+
+    for (size_t r = 0; r < num_batches; ++r)
+        run_batch(r);
+
+    double elapsed = foxxll::timestamp() - ts;
+    const size_t steady_allocations = s_allocations.load() - allocations;
+
+    STXXL_MSG("requests=" << num_batches * batch_size <<
+              " time=" << elapsed << " s"
+              " rate=" << static_cast<double>(num_batches * batch_size) / elapsed << " requests/s"
+              " allocations=" << steady_allocations);
+
+    // a rare interleaving of the threads may still strand objects in a
+    // thread's cache, but nowhere near one allocation per request
+    STXXL_CHECK(steady_allocations * 1000 <= num_batches * batch_size);
+
+    foxxll::aligned_dealloc<4096>(buffer);
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
@@ -0,0 +1,154 @@
+/***************************************************************************
+ *  tests/io/test_request_trace.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! \example io/test_request_trace.cpp
+//! Traces requests issued from several threads: every request must show up
+//! with its submit, dequeue, dispatch, completion and wait events, and the
+//! trace must convert to Chrome trace-event JSON.
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/io.hpp>
+#include <foxxll/verbose.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using foxxll::request_trace;
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: " << argv[0] << " filetype tempfile" << std::endl;
+        return -1;
+    }
+
+    const size_t num_threads = 4;
+    const size_t num_blocks = 64;
+    const size_t block_size = 64 * 1024;
+    const std::string trace_path = std::string(argv[2]) + ".trace";
+
+    foxxll::file_ptr file = foxxll::create_file(
+        argv[1], argv[2], foxxll::file::CREAT | foxxll::file::RDWR | foxxll::file::DIRECT);
+    file->set_size(num_threads * num_blocks * block_size);
+
+    char* buffer = static_cast<char*>(
+        foxxll::aligned_alloc<4096>(num_threads * num_blocks * block_size));
+
+    // not traced
+    file->awrite(buffer, 0, block_size)->wait();
+
+    request_trace* trace = request_trace::get_instance();
+    trace->start(trace_path);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back(
+            [&, t]() {
+                std::vector<foxxll::request_ptr> reqs;
+                for (size_t b = 0; b < num_blocks; ++b)
+                {
+                    size_t offset = (t * num_blocks + b) * block_size;
+                    reqs.push_back(file->awrite(buffer + offset, offset, block_size));
+                }
+                foxxll::wait_all(reqs.begin(), reqs.end());
+                reqs.clear();
+                for (size_t b = 0; b < num_blocks; ++b)
+                {
+                    size_t offset = (t * num_blocks + b) * block_size;
+                    reqs.push_back(file->aread(buffer + offset, offset, block_size));
+                }
+                foxxll::wait_all(reqs.begin(), reqs.end());
+            });
+    }
+    for (std::thread& t : threads)
+        t.join();
+
+    trace->stop();
+
+    // not traced
+    file->aread(buffer, 0, block_size)->wait();
+
+    const size_t num_requests = 2 * num_threads * num_blocks;
+
+    // count events in the binary file
+    {
+        std::ifstream in(trace_path.c_str(), std::ios::binary);
+        char magic[8];
+        uint32_t header[2];
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char*>(header), sizeof(header));
+        STXXL_CHECK_EQUAL(std::string(magic), "FOXXTRC");
+        STXXL_CHECK_EQUAL(header[0], request_trace::version);
+        STXXL_CHECK_EQUAL(header[1], sizeof(request_trace::record));
+
+        size_t counts[request_trace::WAIT_END + 1] = { 0 };
+        std::set<uint32_t> waiting_threads;
+        request_trace::record r;
+        while (in.read(reinterpret_cast<char*>(&r), sizeof(r)))
+        {
+            STXXL_CHECK(r.type <= request_trace::WAIT_END);
+            STXXL_CHECK_EQUAL(r.size, block_size);
+            ++counts[r.type];
+            if (r.type == request_trace::WAIT_BEGIN)
+                waiting_threads.insert(r.thread);
+            if (r.type == request_trace::SUBMIT)
+                STXXL_CHECK_EQUAL(r.device, file->get_device_id());
+        }
+
+        STXXL_MSG("traced " << counts[request_trace::SUBMIT] << " requests, " <<
+                  counts[request_trace::WAIT_BEGIN] << " waits, dropped " <<
+                  trace->dropped() << " events");
+
+        STXXL_CHECK_EQUAL(trace->dropped(), 0u);
+        STXXL_CHECK_EQUAL(counts[request_trace::SUBMIT], num_requests);
+        STXXL_CHECK_EQUAL(counts[request_trace::DEQUEUE], num_requests);
+        STXXL_CHECK_EQUAL(counts[request_trace::DISPATCH], num_requests);
+        STXXL_CHECK_EQUAL(counts[request_trace::COMPLETE], num_requests);
+        STXXL_CHECK_EQUAL(counts[request_trace::CANCEL], 0u);
+        STXXL_CHECK_EQUAL(counts[request_trace::WAIT_BEGIN], num_requests);
+        STXXL_CHECK_EQUAL(counts[request_trace::WAIT_END], num_requests);
+        STXXL_CHECK_EQUAL(waiting_threads.size(), num_threads);
+    }
+
+    // convert to Chrome trace-event JSON
+    {
+        std::ifstream in(trace_path.c_str(), std::ios::binary);
+        std::ostringstream out;
+        uint64_t events = request_trace::to_chrome_json(in, out);
+
+        const std::string json = out.str();
+        STXXL_CHECK_EQUAL(json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["), 0u);
+
+        size_t begins = 0;
+        for (size_t pos = 0; (pos = json.find("\"ph\":\"b\"", pos)) != std::string::npos; ++pos)
+            ++begins;
+
+        // queued and service span per request, wait begin and end
+        STXXL_CHECK_EQUAL(events, 7 * num_requests);
+        STXXL_CHECK_EQUAL(begins, 2 * num_requests);
+    }
+
+    std::remove(trace_path.c_str());
+
+    foxxll::aligned_dealloc<4096>(buffer);
+    file->close_remove();
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
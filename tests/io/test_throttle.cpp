@@ -0,0 +1,168 @@
+/***************************************************************************
+ *  tests/io/test_throttle.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! \example io/test_throttle.cpp
+//! Checks the token buckets of io_throttle, then limits the read bandwidth of
+//! a disk queue and checks that reads are delayed and counted in the queue's
+//! iostats, while writes pass, and that lifting the limit releases blocked
+//! reads. Also run with io_uring, whose worker must reap completions while
+//! the throttle holds back requests.
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/common/timer.hpp>
+#include <foxxll/io.hpp>
+#include <foxxll/verbose.hpp>
+
+#include "held_queue.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using foxxll::request;
+
+static void test_io_throttle()
+{
+    foxxll::io_throttle throttle;
+
+    // unlimited by default
+    STXXL_CHECK(throttle.get_limits().unlimited());
+    STXXL_CHECK_EQUAL(throttle.acquire(request::READ, 1024 * 1024), 0.0);
+
+    // 100 IOPS: the first 5 pass from the full bucket, 15 more take 0.15 s
+    foxxll::throttle_limits limits;
+    limits.max_iops = 100;
+    throttle.set_limits(limits);
+    STXXL_CHECK_EQUAL(throttle.get_limits().max_iops, 100u);
+
+    double start = foxxll::timestamp();
+    double blocked = 0.0;
+    for (size_t i = 0; i < 20; ++i)
+        blocked += throttle.acquire(i % 2 ? request::READ : request::WRITE, 4096);
+    STXXL_CHECK(foxxll::timestamp() - start >= 0.12);
+    STXXL_CHECK(blocked >= 0.12);
+
+    // lifting the limits releases a blocked thread
+    limits = foxxll::throttle_limits();
+    limits.max_write_bw = 1024;
+    throttle.set_limits(limits);
+    // larger than the bucket, admitted from the full bucket
+    STXXL_CHECK_EQUAL(throttle.acquire(request::WRITE, 64 * 1024), 0.0);
+    // reads are not limited
+    STXXL_CHECK_EQUAL(throttle.acquire(request::READ, 64 * 1024), 0.0);
+
+    start = foxxll::timestamp();
+    std::thread lifter([&throttle]() {
+                           std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                           throttle.set_limits(foxxll::throttle_limits());
+                       });
+    // would take a minute at 1 KiB/s
+    throttle.acquire(request::WRITE, 64 * 1024);
+    lifter.join();
+    STXXL_CHECK(foxxll::timestamp() - start < 10.0);
+    STXXL_CHECK(throttle.get_limits().unlimited());
+}
+
+//! Reads every other block from a queue limited to 512 KiB/s reading, such
+//! that the elevator cannot merge the reads.
+static void test_queue(const char* filetype, const char* filename,
+                       int queue_id, bool elevator)
+{
+    const size_t block_size = 16 * 1024;
+    const size_t num_blocks = 16;
+    const size_t words = block_size / sizeof(size_t);
+
+    size_t* buffer = (size_t*)foxxll::aligned_alloc<4096>(
+        num_blocks * block_size);
+
+    foxxll::file_ptr file = foxxll::create_file(
+        filetype, filename,
+        foxxll::file::CREAT | foxxll::file::RDWR | foxxll::file::DIRECT,
+        queue_id);
+    file->set_size(block_size * num_blocks);
+
+    foxxll::disk_queues* queues = foxxll::disk_queues::get_instance();
+    queues->make_queue(file.get(), 0, elevator);
+
+    foxxll::throttle_limits limits;
+    limits.max_read_bw = 512 * 1024;
+    STXXL_CHECK(queues->set_throttle_limits(queue_id, limits));
+    STXXL_CHECK_EQUAL(queues->get_throttle_limits(queue_id).max_read_bw,
+                      limits.max_read_bw);
+    // no queue, nothing to limit
+    STXXL_CHECK(!queues->set_throttle_limits(queue_id + 1000, limits));
+
+    // writes pass unthrottled
+    const foxxll::queue_stats_data before_writes = queues->get_queue_stats(queue_id);
+    std::vector<foxxll::request_ptr> reqs;
+    for (size_t b = 0; b < num_blocks; ++b)
+        reqs.push_back(file->awrite(
+                           buffer + b * words, b * block_size, block_size));
+    foxxll::wait_all(reqs.begin(), reqs.end());
+    reqs.clear();
+
+    const foxxll::queue_stats_data before = queues->get_queue_stats(queue_id);
+    STXXL_CHECK_EQUAL((before - before_writes).get_throttled(), 0u);
+
+    // 128 KiB at 512 KiB/s less a bucket of about 25 KiB take about 0.2 s
+    const double start = foxxll::timestamp();
+    for (size_t b = 0; b < num_blocks; b += 2)
+        reqs.push_back(file->aread(
+                           buffer + b * words, b * block_size, block_size));
+    foxxll::wait_all(reqs.begin(), reqs.end());
+    reqs.clear();
+    const double elapsed = foxxll::timestamp() - start;
+
+    const foxxll::queue_stats_data diff =
+        queues->get_queue_stats(queue_id) - before;
+    STXXL_MSG(filetype << (elevator ? " elevator" : "") <<
+              ": read " << num_blocks / 2 * block_size << " bytes in " <<
+              elapsed << " s, throttled " << diff.get_throttled() <<
+              " times for " << diff.get_throttle_time() << " s");
+    STXXL_CHECK(elapsed >= 0.15);
+    STXXL_CHECK(diff.get_throttled() > 0);
+    STXXL_CHECK(diff.get_throttle_time() >= 0.1);
+
+    // lifting the limit releases reads blocked at 1 KiB/s, the first is
+    // admitted from the full bucket and completes while the others are held
+    limits.max_read_bw = 1024;
+    queues->set_throttle_limits(queue_id, limits);
+    const double start_lifted = foxxll::timestamp();
+    for (size_t b = 0; b < 4; ++b)
+        reqs.push_back(file->aread(
+                           buffer + b * words, b * block_size, block_size));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    STXXL_CHECK(reqs.front()->poll());
+    queues->set_throttle_limits(queue_id, foxxll::throttle_limits());
+    foxxll::wait_all(reqs.begin(), reqs.end());
+    STXXL_CHECK(foxxll::timestamp() - start_lifted < 10.0);
+
+    foxxll::aligned_dealloc<4096>(buffer);
+    file->close_remove();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: " << argv[0] << " filetype tempfile" << std::endl;
+        return -1;
+    }
+
+    test_io_throttle();
+
+    test_queue(argv[1], argv[2], fresh_queue_id(), false);
+    test_queue(argv[1], argv[2], fresh_queue_id(), true);
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
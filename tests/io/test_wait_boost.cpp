@@ -0,0 +1,251 @@
+/***************************************************************************
+ *  tests/io/test_wait_boost.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! \example io/test_wait_boost.cpp
+//! Holds up the worker of a disk queue, submits a backlog of requests and
+//! then waits for the last one. A wait longer than request::boost_delay()
+//! must move it to the head of the queue, such that it is served first, and
+//! is counted in the iostats, a shorter one must not.
+//! Boosting a write must not pass an earlier write to the same block.
+
+#include <foxxll/common/aligned_alloc.hpp>
+#include <foxxll/io.hpp>
+#include <foxxll/verbose.hpp>
+
+#include "held_queue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using foxxll::request;
+
+//! Submits a backlog to a held up queue and boosts its last request, either
+//! directly or by waiting for it for longer than the boost delay. A wait
+//! shorter than the delay boosts nothing.
+static void test_queue(const char* filetype, const char* filename,
+                       int queue_id, bool elevator, bool by_wait,
+                       bool short_wait = false)
+{
+    const size_t block_size = 16 * 1024;
+    const size_t num_blocks = 32;
+    const size_t words = block_size / sizeof(size_t);
+
+    size_t* buffer = (size_t*)foxxll::aligned_alloc<4096>(
+        (num_blocks + 1) * block_size);
+
+    foxxll::file_ptr file = foxxll::create_file(
+        filetype, filename,
+        foxxll::file::CREAT | foxxll::file::RDWR | foxxll::file::DIRECT,
+        queue_id);
+    file->set_size(block_size * (num_blocks + 1));
+
+    if (elevator)
+        foxxll::disk_queues::get_instance()->make_queue(file.get(), 0, true);
+
+    completion_order completed;
+
+    s_holding = false;
+    s_released = false;
+
+    foxxll::request_ptr gate = file->awrite(
+        buffer + num_blocks * words, num_blocks * block_size, block_size,
+        hold_worker);
+    while (!s_holding)
+        std::this_thread::yield();
+
+    // a backlog of prefetching reads, served in submission order
+    std::vector<foxxll::request_ptr> reqs;
+    {
+        foxxll::scoped_priority_class priority(request::PREFETCH);
+        for (size_t b = 0; b < num_blocks; ++b)
+            reqs.push_back(file->aread(
+                               buffer + b * words, b * block_size, block_size,
+                               completed.record(b)));
+    }
+    foxxll::request_ptr last = reqs.back();
+
+    const foxxll::stats_data before(*foxxll::stats::get_instance());
+
+    const bool boosts = !(by_wait && short_wait);
+
+    if (by_wait)
+    {
+        // the queue is released after 50 ms
+        const double delay = foxxll::request::boost_delay();
+        foxxll::request::set_boost_delay(short_wait ? 10.0 : 0.01);
+
+        std::atomic<bool> waiting { false };
+        std::thread releaser([&waiting]() {
+                                 while (!waiting)
+                                     std::this_thread::yield();
+                                 std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                                 s_released = true;
+                             });
+        waiting = true;
+        last->wait();
+        releaser.join();
+
+        foxxll::request::set_boost_delay(delay);
+    }
+    else
+    {
+        STXXL_CHECK(last->boost());
+        // boosted already
+        STXXL_CHECK(!last->boost());
+        s_released = true;
+    }
+
+    // poll, such that slow waits cannot boost the requests still queued
+    for (const foxxll::request_ptr& req : reqs)
+    {
+        while (!req->poll())
+            std::this_thread::yield();
+    }
+    gate->wait();
+
+    const foxxll::stats_data after(*foxxll::stats::get_instance());
+
+    STXXL_CHECK_EQUAL(completed.order.size(), num_blocks);
+    if (boosts)
+    {
+        STXXL_CHECK_EQUAL(completed.order[0], num_blocks - 1);
+        for (size_t i = 1; i < num_blocks; ++i)
+            STXXL_CHECK_EQUAL(completed.order[i], i - 1);
+    }
+    else
+    {
+        for (size_t i = 0; i < num_blocks; ++i)
+            STXXL_CHECK_EQUAL(completed.order[i], i);
+    }
+
+    // only the wait for the boosted request counts
+    const foxxll::stats_data diff = after - before;
+    const uint64_t boosted_waits = (by_wait && boosts) ? 1 : 0;
+    STXXL_CHECK_EQUAL(diff.get_boosted_waits(), boosted_waits);
+    if (by_wait && boosts)
+        STXXL_CHECK(diff.get_boosted_wait_time() > 0.0);
+
+    // requests which are done are not boosted
+    STXXL_CHECK(!last->boost());
+
+    foxxll::aligned_dealloc<4096>(buffer);
+    file->close_remove();
+}
+
+//! Boosts the second of two writes to the same block, queued behind a
+//! backlog. The first write must be boosted along and served before it.
+static void test_same_position(const char* filetype, const char* filename,
+                               int queue_id, bool elevator, int queue_length)
+{
+    const size_t block_size = 16 * 1024;
+    const size_t num_blocks = 16;
+    const size_t words = block_size / sizeof(size_t);
+
+    size_t* buffer = (size_t*)foxxll::aligned_alloc<4096>(
+        (num_blocks + 3) * block_size);
+
+    foxxll::file_ptr file = foxxll::create_file(
+        filetype, filename,
+        foxxll::file::CREAT | foxxll::file::RDWR | foxxll::file::DIRECT,
+        queue_id);
+    file->set_size(block_size * (num_blocks + 2));
+    foxxll::disk_queues::get_instance()->make_queue(
+        file.get(), queue_length, elevator);
+
+    completion_order completed;
+
+    s_holding = false;
+    s_released = false;
+
+    // hold up every worker, on blocks of their own
+    std::vector<foxxll::request_ptr> gates;
+    for (int i = 0; i < std::max(queue_length, 1); ++i)
+    {
+        s_holding = false;
+        gates.push_back(file->awrite(
+                            buffer + num_blocks * words, (num_blocks + i) * block_size,
+                            block_size, hold_worker));
+        while (!s_holding)
+            std::this_thread::yield();
+    }
+
+    std::vector<foxxll::request_ptr> reqs;
+    {
+        foxxll::scoped_priority_class priority(request::PREFETCH);
+        for (size_t b = 1; b < num_blocks; ++b)
+            reqs.push_back(file->aread(
+                               buffer + b * words, b * block_size, block_size,
+                               completed.record(b)));
+    }
+
+    // two writes of different data to block 0
+    size_t* first = buffer + (num_blocks + 1) * words;
+    size_t* second = buffer + (num_blocks + 2) * words;
+    std::fill(first, first + words, 1);
+    std::fill(second, second + words, 2);
+    reqs.push_back(file->awrite(first, 0, block_size, completed.record(1000)));
+    reqs.push_back(file->awrite(second, 0, block_size, completed.record(2000)));
+
+    STXXL_CHECK(reqs.back()->boost());
+    s_released = true;
+
+    for (const foxxll::request_ptr& req : reqs)
+        req->wait();
+    foxxll::wait_all(gates.begin(), gates.end());
+
+    const std::vector<size_t>& order = completed.order;
+    STXXL_CHECK_EQUAL(order.size(), num_blocks + 1);
+    const size_t pos_first =
+        std::find(order.begin(), order.end(), 1000u) - order.begin();
+    const size_t pos_second =
+        std::find(order.begin(), order.end(), 2000u) - order.begin();
+    STXXL_CHECK(pos_first < pos_second);
+    if (queue_length <= 1) {
+        STXXL_CHECK_EQUAL(pos_first, 0u);
+        STXXL_CHECK_EQUAL(pos_second, 1u);
+    }
+
+    // the second write has to win
+    std::fill(buffer, buffer + words, 0);
+    file->aread(buffer, 0, block_size)->wait();
+    for (size_t i = 0; i < words; ++i)
+        STXXL_CHECK_EQUAL(buffer[i], 2u);
+
+    foxxll::aligned_dealloc<4096>(buffer);
+    file->close_remove();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: " << argv[0] << " filetype tempfile" << std::endl;
+        return -1;
+    }
+
+    test_queue(argv[1], argv[2], fresh_queue_id(), false, false);
+    test_queue(argv[1], argv[2], fresh_queue_id(), false, true);
+    test_queue(argv[1], argv[2], fresh_queue_id(), true, false);
+    test_queue(argv[1], argv[2], fresh_queue_id(), true, true);
+    test_queue(argv[1], argv[2], fresh_queue_id(), false, true, true);
+    test_queue(argv[1], argv[2], fresh_queue_id(), true, true, true);
+
+    test_same_position(argv[1], argv[2], fresh_queue_id(), false, 0);
+    test_same_position(argv[1], argv[2], fresh_queue_id(), true, 0);
+    test_same_position(argv[1], argv[2], fresh_queue_id(), false, 2);
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
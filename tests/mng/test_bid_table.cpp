@@ -0,0 +1,93 @@
+/***************************************************************************
+ *  tests/mng/test_bid_table.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! \example mng/test_bid_table.cpp
+//! Inserts, finds and erases BIDs in a bid_table in random order and compares
+//! each step against a std::map. The BIDs share few files and are spaced by
+//! the block size, like those of the pools.
+
+#include <foxxll/common/utils.hpp>
+#include <foxxll/mng/bid_table.hpp>
+#include <foxxll/verbose.hpp>
+
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+using bid_type = foxxll::BID<4096>;
+
+int main()
+{
+    const size_t num_bids = 10000;
+
+    std::vector<bid_type> bids;
+    for (size_t i = 0; i < num_bids; ++i)
+        bids.push_back(bid_type(
+                           reinterpret_cast<foxxll::file*>(8 * (1 + i % 3)),
+                           (i / 3) * 4096));
+
+    foxxll::bid_table<bid_type, size_t> table;
+    std::map<std::pair<foxxll::file*, uint64_t>, size_t> reference;
+
+    std::mt19937 rng(42);
+    for (size_t step = 0; step < 20 * num_bids; ++step)
+    {
+        const bid_type& bid = bids[rng() % num_bids];
+        const std::pair<foxxll::file*, uint64_t> key(bid.storage, bid.offset);
+
+        switch (rng() % 3)
+        {
+        case 0:
+            table[bid] = step;
+            reference[key] = step;
+            break;
+        case 1:
+        {
+            const bool erased = reference.erase(key) == 1;
+            STXXL_CHECK_EQUAL(table.erase(bid), erased);
+            break;
+        }
+        default:
+        {
+            size_t* value = table.find(bid);
+            auto it = reference.find(key);
+            const bool found = it != reference.end();
+            STXXL_CHECK_EQUAL(static_cast<bool>(value), found);
+            STXXL_CHECK_EQUAL(table.contains(bid), found);
+            if (value)
+                STXXL_CHECK_EQUAL(*value, it->second);
+        }
+        }
+        STXXL_CHECK_EQUAL(table.size(), reference.size());
+    }
+
+    // every entry is visited exactly once
+    size_t visited = 0;
+    table.for_each(
+        [&](const bid_type& bid, size_t& value) {
+            auto it = reference.find(std::make_pair(bid.storage, bid.offset));
+            STXXL_CHECK(it != reference.end());
+            STXXL_CHECK_EQUAL(value, it->second);
+            ++visited;
+        });
+    STXXL_CHECK_EQUAL(visited, reference.size());
+
+    // drain the table
+    for (const bid_type& bid : bids)
+        table.erase(bid);
+    STXXL_CHECK(table.empty());
+    STXXL_CHECK(!table.contains(bids[0]));
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
@@ -12,13 +12,41 @@
 
 #include <foxxll/mng.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <tuple>
+#include <vector>
 
 #define BLOCK_SIZE (1024 * 1024 * 32)
 
 using block_type = foxxll::typed_block<BLOCK_SIZE, int>;
 template class foxxll::typed_block<BLOCK_SIZE, int>; // forced instantiation
 
+using bid_array_type = foxxll::BIDArray<BLOCK_SIZE>;
+
+//! check that the live blocks are aligned and pairwise disjoint
+void check_bids(const std::vector<const bid_array_type*>& arrays)
+{
+    std::vector<std::tuple<foxxll::file*, uint64_t, uint64_t> > all;
+    for (const bid_array_type* a : arrays)
+    {
+        for (const foxxll::BID<BLOCK_SIZE>& bid : *a)
+        {
+            STXXL_CHECK(bid.valid());
+            STXXL_CHECK_EQUAL(bid.offset % STXXL_BLOCK_ALIGN, 0u);
+            all.emplace_back(bid.storage, bid.offset, uint64_t(bid.size));
+        }
+    }
+    std::sort(all.begin(), all.end());
+    for (size_t i = 1; i < all.size(); ++i)
+    {
+        if (std::get<0>(all[i - 1]) != std::get<0>(all[i]))
+            continue;
+        STXXL_CHECK(std::get<1>(all[i - 1]) + std::get<2>(all[i - 1]) <=
+                    std::get<1>(all[i]));
+    }
+}
+
 int main()
 {
     size_t totalsize = 0;
@@ -32,11 +60,11 @@ int main()
 
     STXXL_MSG("external memory: " << totalsize << " bytes  ==  " << totalblocks << " blocks");
 
-    foxxll::BIDArray<BLOCK_SIZE> b5a(totalblocks / 5);
-    foxxll::BIDArray<BLOCK_SIZE> b5b(totalblocks / 5);
-    foxxll::BIDArray<BLOCK_SIZE> b5c(totalblocks / 5);
-    foxxll::BIDArray<BLOCK_SIZE> b5d(totalblocks / 5);
-    foxxll::BIDArray<BLOCK_SIZE> b2(totalblocks / 2);
+    bid_array_type b5a(totalblocks / 5);
+    bid_array_type b5b(totalblocks / 5);
+    bid_array_type b5c(totalblocks / 5);
+    bid_array_type b5d(totalblocks / 5);
+    bid_array_type b2(totalblocks / 2);
 
     foxxll::block_manager* bm = foxxll::block_manager::get_instance();
 
@@ -45,6 +73,7 @@ int main()
     bm->new_blocks(foxxll::striping(), b5b.begin(), b5b.end());
     bm->new_blocks(foxxll::striping(), b5c.begin(), b5c.end());
     bm->new_blocks(foxxll::striping(), b5d.begin(), b5d.end());
+    check_bids({ &b5a, &b5b, &b5c, &b5d });
 
     STXXL_MSG("free 2 x " << totalblocks / 5);
     bm->delete_blocks(b5a.begin(), b5a.end());
@@ -54,9 +83,22 @@ int main()
     // s.t. the following request needs to be split into smaller ones
     STXXL_MSG("get 1 x " << totalblocks / 2);
     bm->new_blocks(foxxll::striping(), b2.begin(), b2.end());
+    check_bids({ &b5b, &b5d, &b2 });
 
     bm->delete_blocks(b5b.begin(), b5b.end());
     bm->delete_blocks(b5d.begin(), b5d.end());
 
     bm->delete_blocks(b2.begin(), b2.end());
+
+    // batched deletion has to coalesce all free space again
+    STXXL_CHECK_EQUAL(bm->current_allocation(), 0u);
+    STXXL_CHECK_EQUAL(bm->free_bytes(), bm->total_bytes());
+
+    // delete in reverse order, which is sorted into extents first
+    std::reverse(b2.begin(), b2.end());
+    bm->new_blocks(foxxll::striping(), b2.begin(), b2.end());
+    check_bids({ &b2 });
+    std::reverse(b2.begin(), b2.end());
+    bm->delete_blocks(b2.begin(), b2.end());
+    STXXL_CHECK_EQUAL(bm->free_bytes(), bm->total_bytes());
 }
@@ -0,0 +1,141 @@
+/***************************************************************************
+ *  tests/mng/test_block_manager_threads.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! \example mng/test_block_manager_threads.cpp
+//! Allocates and frees blocks from the block_manager in several threads
+//! concurrently, checks that no block is handed out twice, and that the
+//! statistics add up afterwards. Then fills the disk from one thread while
+//! another thread's cache holds free blocks.
+
+#include <foxxll/mng.hpp>
+#include <foxxll/verbose.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+static const size_t block_size = 64 * 1024;
+using bid_type = foxxll::BID<block_size>;
+
+static const uint64_t disk_size = 256 * 1024 * 1024;
+
+static void test_threads()
+{
+    const size_t num_threads = 8;
+    const size_t num_blocks = 256;
+    const size_t rounds = 20;
+
+    foxxll::block_manager* bm = foxxll::block_manager::get_instance();
+    const uint64_t free_before = bm->free_bytes();
+
+    std::vector<std::vector<bid_type> > bids(num_threads);
+    std::vector<std::thread> threads;
+
+    // churn single-block allocations, keep the last round alive
+    for (size_t t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back(
+            [&bids, bm, t, num_blocks, rounds]() {
+                std::vector<bid_type>& mine = bids[t];
+                mine.resize(num_blocks);
+                for (size_t r = 0; r < rounds; ++r)
+                {
+                    if (r != 0)
+                        bm->delete_blocks(mine.begin(), mine.end());
+                    for (bid_type& bid : mine)
+                        bm->new_block(foxxll::striping(), bid);
+                }
+            });
+    }
+    for (std::thread& t : threads)
+        t.join();
+    threads.clear();
+
+    STXXL_CHECK_EQUAL(bm->current_allocation(),
+                      num_threads * num_blocks * block_size);
+    STXXL_CHECK(bm->maximum_allocation() >= bm->current_allocation());
+    STXXL_CHECK_EQUAL(bm->total_allocation(),
+                      rounds * num_threads * num_blocks * block_size);
+
+    // no two live blocks may share storage and offset
+    std::vector<std::pair<foxxll::file*, uint64_t> > all;
+    for (const std::vector<bid_type>& v : bids)
+    {
+        for (const bid_type& bid : v)
+            all.emplace_back(bid.storage, bid.offset);
+    }
+    std::sort(all.begin(), all.end());
+    STXXL_CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+
+    // free blocks in other threads than they were allocated in
+    for (size_t t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back(
+            [&bids, bm, t, num_threads]() {
+                std::vector<bid_type>& other = bids[(t + 1) % num_threads];
+                bm->delete_blocks(other.begin(), other.end());
+            });
+    }
+    for (std::thread& t : threads)
+        t.join();
+
+    STXXL_CHECK_EQUAL(bm->current_allocation(), 0u);
+    STXXL_CHECK_EQUAL(bm->free_bytes(), free_before);
+}
+
+//! The blocks cached by a thread count as free, hence another thread can
+//! allocate them, too.
+static void test_cached_free_space()
+{
+    foxxll::block_manager* bm = foxxll::block_manager::get_instance();
+    STXXL_CHECK_EQUAL(bm->free_bytes(), disk_size);
+
+    std::atomic<bool> cached { false }, done { false };
+    std::thread holder([bm, &cached, &done]() {
+                           bid_type bid;
+                           bm->new_block(foxxll::striping(), bid);
+                           bm->delete_block(bid);
+                           cached = true;
+                           while (!done)
+                               std::this_thread::yield();
+                       });
+    while (!cached)
+        std::this_thread::yield();
+
+    STXXL_CHECK_EQUAL(bm->free_bytes(), disk_size);
+
+    std::vector<bid_type> bids(disk_size / block_size);
+    bm->new_blocks(foxxll::striping(), bids.begin(), bids.end());
+    STXXL_CHECK_EQUAL(bm->free_bytes(), 0u);
+
+    done = true;
+    holder.join();
+
+    bm->delete_blocks(bids.begin(), bids.end());
+    STXXL_CHECK_EQUAL(bm->free_bytes(), disk_size);
+}
+
+int main()
+{
+    // a disk which does not grow
+    foxxll::config::get_instance()->add_disk(
+        foxxll::disk_config("/tmp/foxxll-threads.tmp", disk_size,
+                            "memory autogrow=no"));
+
+    test_threads();
+    test_cached_free_space();
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
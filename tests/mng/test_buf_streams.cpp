@@ -13,6 +13,7 @@
 //! \example mng/test_buf_streams.cpp
 //! This is an example of use of \c foxxll::buf_istream and \c foxxll::buf_ostream
 
+#include <foxxll/io/memory_file.hpp>
 #include <foxxll/mng.hpp>
 #include <foxxll/mng/buf_istream.hpp>
 #include <foxxll/mng/buf_istream_reverse.hpp>
@@ -34,6 +35,61 @@ template class foxxll::buf_ostream<block_type, foxxll::BIDArray<BLOCK_SIZE>::ite
 template class foxxll::buf_istream<block_type, foxxll::BIDArray<BLOCK_SIZE>::iterator>;
 template class foxxll::buf_istream_reverse<block_type, foxxll::BIDArray<BLOCK_SIZE>::iterator>;
 
+// streams over a memory_file consume blocks without copying them, if asked to
+void test_mapped_blocks()
+{
+    const unsigned nblocks = 16;
+    const unsigned nelements = nblocks * block_type::size;
+
+    foxxll::file_ptr file = tlx::make_counting<foxxll::memory_file>();
+    file->set_size(nblocks * BLOCK_SIZE);
+
+    foxxll::BIDArray<BLOCK_SIZE> bids(nblocks);
+    for (unsigned i = 0; i < nblocks; ++i)
+        bids[i] = foxxll::BID<BLOCK_SIZE>(file.get(), i * BLOCK_SIZE);
+
+    {
+        buf_ostream_type out(bids.begin(), 2);
+        for (unsigned i = 0; i < nelements; i++)
+            out << i;
+    }
+    {
+        buf_istream_type in(bids.begin(), bids.end(), 2, true);
+        for (unsigned i = 0; i < nelements; i++)
+        {
+            unsigned value;
+            in >> value;
+            STXXL_CHECK_EQUAL(value, i);
+        }
+    }
+    {
+        // without opting in, records are copies which may be modified
+        buf_istream_type in(bids.begin(), bids.end(), 2);
+        *in = nelements;
+        foxxll::mapped_block view = file->try_map_block(0, BLOCK_SIZE);
+        STXXL_CHECK_EQUAL(static_cast<const unsigned*>(view.data())[0], 0u);
+    }
+    {
+        size_t prefetch_seq[nblocks];
+        for (unsigned i = 0; i < nblocks; ++i)
+            prefetch_seq[i] = i;
+
+        foxxll::block_prefetcher<block_type, bid_iterator_type> prefetcher(
+            bids.begin(), bids.end(), prefetch_seq, 2,
+            foxxll::completion_handler(), true);
+
+        block_type* block = prefetcher.pull_block();
+        unsigned i = 0;
+        do {
+            foxxll::mapped_block view = file->try_map_block(i * BLOCK_SIZE, BLOCK_SIZE);
+            STXXL_CHECK(static_cast<const void*>(block) == view.data());
+            STXXL_CHECK_EQUAL(block->elem[0], i * block_type::size);
+            ++i;
+        } while (prefetcher.block_consumed(block));
+        STXXL_CHECK_EQUAL(i, nblocks);
+    }
+}
+
 int main()
 {
     const unsigned nblocks = 128;
@@ -75,5 +131,7 @@ int main()
     }
     bm->delete_blocks(bids.begin(), bids.end());
 
+    test_mapped_blocks();
+
     return 0;
 }
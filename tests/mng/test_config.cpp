@@ -13,6 +13,10 @@
 #include <foxxll/mng.hpp>
 #include <foxxll/verbose.hpp>
 
+#include <cstdio>
+#include <fstream>
+#include <string>
+
 void test1()
 {
     // test disk_config parser:
@@ -35,8 +39,81 @@ void test1()
     STXXL_CHECK_EQUAL(cfg.queue, 5);
     STXXL_CHECK_EQUAL(cfg.direct, foxxll::disk_config::DIRECT_ON);
 
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , io_uring unlink queue_length=128");
+
+    STXXL_CHECK_EQUAL(cfg.fileio_string(), "io_uring unlink_on_open queue_length=128");
+    STXXL_CHECK_EQUAL(cfg.queue_length, 128);
+
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall queue_length=4");
+
+    STXXL_CHECK_EQUAL(cfg.fileio_string(), "syscall queue_length=4");
+    STXXL_CHECK_EQUAL(cfg.queue_length, 4);
+
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall discard queue_length=4");
+
+    STXXL_CHECK_EQUAL(cfg.fileio_string(), "syscall discard queue_length=4");
+    STXXL_CHECK(cfg.discard);
+    STXXL_CHECK_EQUAL(cfg.discard_rate, 0u);
+
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , linuxaio discard=1GiB");
+
+    STXXL_CHECK_EQUAL(cfg.discard_rate, 1024 * 1024 * uint64_t(1024));
+
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall elevator");
+
+    STXXL_CHECK_EQUAL(cfg.fileio_string(), "syscall elevator");
+    STXXL_CHECK(cfg.elevator);
+    STXXL_CHECK_EQUAL(cfg.elevator_max_wait, 0u);
+
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall elevator=200");
+
+    STXXL_CHECK_EQUAL(cfg.fileio_string(), "syscall elevator=200");
+    STXXL_CHECK_EQUAL(cfg.elevator_max_wait, 200u);
+
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall max_read_bw=200MiB max_write_bw=100MB max_iops=10k");
+
+    STXXL_CHECK_EQUAL(cfg.fileio_string(), "syscall max_read_bw=209715200 max_write_bw=100000000 max_iops=10000");
+    STXXL_CHECK_EQUAL(cfg.max_read_bw, 200 * 1024 * uint64_t(1024));
+    STXXL_CHECK_EQUAL(cfg.max_write_bw, 100 * 1000 * uint64_t(1000));
+    STXXL_CHECK_EQUAL(cfg.max_iops, 10000u);
+
+    cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB , syscall");
+
+    STXXL_CHECK_EQUAL(cfg.max_read_bw, 0u);
+    STXXL_CHECK_EQUAL(cfg.max_iops, 0u);
+
     // bad configurations
 
+    STXXL_CHECK_THROW(
+        cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, memory discard"),
+        std::runtime_error
+        );
+
+    STXXL_CHECK_THROW(
+        cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, linuxaio elevator"),
+        std::runtime_error
+        );
+
+    STXXL_CHECK_THROW(
+        cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, syscall elevator=soon"),
+        std::runtime_error
+        );
+
+    STXXL_CHECK_THROW(
+        cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, syscall elevator queue=2"),
+        std::runtime_error
+        );
+
+    STXXL_CHECK_THROW(
+        cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, syscall queue=2 elevator"),
+        std::runtime_error
+        );
+
+    STXXL_CHECK_THROW(
+        cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, syscall max_iops=fast"),
+        std::runtime_error
+        );
+
     STXXL_CHECK_THROW(
         cfg.parse_line("disk=/var/tmp/foxxll.tmp, 100 GiB, wincall_fileperblock unlink direct=on"),
         std::runtime_error
@@ -46,6 +123,29 @@ void test1()
         cfg.parse_line("disk=/var/tmp/foxxll.tmp,0x,syscall"),
         std::runtime_error
         );
+
+    // test statistics sampler configuration
+
+    foxxll::config* config = foxxll::config::get_instance();
+
+    config->parse_stats_line("stats=/tmp/foxxll-stats.json,250,json");
+    STXXL_CHECK_EQUAL(config->stats_sampler_path(), "/tmp/foxxll-stats.json");
+    STXXL_CHECK_EQUAL(config->stats_sampler_interval(), 250u);
+    STXXL_CHECK_EQUAL(config->stats_sampler_format(), "json");
+
+    STXXL_CHECK_THROW(
+        config->parse_stats_line("stats=/tmp/foxxll-stats.csv,fast"),
+        std::runtime_error
+        );
+
+    STXXL_CHECK_THROW(
+        config->parse_stats_line("stats=/tmp/foxxll-stats.csv,100,xml"),
+        std::runtime_error
+        );
+
+    // used by test2()
+    config->parse_stats_line("stats=/tmp/foxxll-stats.csv,100");
+    STXXL_CHECK_EQUAL(config->stats_sampler_format(), "csv");
 }
 
 void test2()
@@ -92,6 +192,15 @@ void test2()
     STXXL_CHECK_EQUAL(bm->total_bytes(), 300 * 1024 * 1024);
     STXXL_CHECK_EQUAL(bm->free_bytes(), 300 * 1024 * 1024);
 
+    // block_manager started the statistics sampler configured in test1()
+    {
+        std::ifstream in("/tmp/foxxll-stats.csv");
+        std::string header;
+        STXXL_CHECK(std::getline(in, header));
+        STXXL_CHECK_EQUAL(header.compare(0, 23, "time,elapsed,device_id,"), 0);
+        std::remove("/tmp/foxxll-stats.csv");
+    }
+
 #endif
 }
 
@@ -0,0 +1,97 @@
+/***************************************************************************
+ *  tests/mng/test_disk_block_allocator.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+//! \example mng/test_disk_block_allocator.cpp
+//! Allocates and frees many variable-sized blocks from a disk_block_allocator
+//! in random order, checks the free space accounting, and reports the
+//! allocation throughput, which depends on how quickly a fitting free region
+//! is found in the fragmented free space.
+
+#include <foxxll/common/timer.hpp>
+#include <foxxll/io/memory_file.hpp>
+#include <foxxll/mng/disk_block_allocator.hpp>
+#include <foxxll/verbose.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    const size_t num_ops = (argc >= 2) ? strtoul(argv[1], nullptr, 10) : 1000000;
+    const size_t max_live = num_ops / 8 + 1;
+
+    foxxll::file_ptr file = tlx::make_counting<foxxll::memory_file>();
+
+    // start large enough for the live blocks, such that growth is rare
+    foxxll::disk_config cfg;
+    cfg.size = max_live * (uint64_t(1) << 18);
+    cfg.autogrow = true;
+
+    foxxll::disk_block_allocator alloc(file.get(), cfg);
+
+    std::mt19937_64 rng(42);
+    // block sizes between 4 KiB and 1 MiB, favoring small ones
+    std::uniform_int_distribution<size_t> size_exp(12, 20);
+
+    std::vector<foxxll::BID<0> > live;
+    live.reserve(max_live);
+    uint64_t live_bytes = 0;
+
+    double ts = foxxll::timestamp();
+
+    for (size_t i = 0; i < num_ops; ++i)
+    {
+        if (live.size() < max_live && (live.empty() || rng() % 3 != 0))
+        {
+            foxxll::BID<0> bid(file.get(), 0, size_t(1) << size_exp(rng));
+            alloc.new_blocks(&bid, &bid + 1);
+            live.push_back(bid);
+            live_bytes += bid.size;
+        }
+        else
+        {
+            size_t j = rng() % live.size();
+            alloc.delete_block(live[j]);
+            live_bytes -= live[j].size;
+            live[j] = live.back();
+            live.pop_back();
+        }
+    }
+
+    double elapsed = foxxll::timestamp() - ts;
+
+    STXXL_MSG("ops=" << num_ops << " time=" << elapsed << " s"
+              " rate=" << num_ops / elapsed << " ops/s"
+              " live=" << live.size() <<
+              " used=" << alloc.used_bytes() <<
+              " total=" << alloc.total_bytes());
+
+    STXXL_CHECK_EQUAL(alloc.used_bytes(), live_bytes);
+
+    for (size_t j = 0; j < live.size(); ++j)
+        alloc.delete_block(live[j]);
+
+    STXXL_CHECK_EQUAL(alloc.used_bytes(), 0u);
+
+    // all free space must have coalesced into one region again
+    foxxll::BID<0> all(file.get(), 0, alloc.total_bytes());
+    uint64_t total = alloc.total_bytes();
+    alloc.new_blocks(&all, &all + 1);
+    STXXL_CHECK_EQUAL(all.offset, 0u);
+    STXXL_CHECK_EQUAL(alloc.total_bytes(), total);
+    alloc.delete_block(all);
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
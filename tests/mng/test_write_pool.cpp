@@ -17,6 +17,8 @@
 #include <foxxll/mng/write_pool.hpp>
 
 #include <iostream>
+#include <utility>
+#include <vector>
 
 #define BLOCK_SIZE (1024 * 512)
 
@@ -42,4 +44,49 @@ int main()
     foxxll::block_manager::get_instance()->new_block(foxxll::single_disk(), bid);
     pool.write(blk, bid)->wait();
     delete blk;
+
+    // rewrite blocks while their first write may still be running: only the
+    // latest write of a bid is found, stale blocks still return to the pool
+    {
+        const size_t num_bids = 64;
+        foxxll::write_pool<block_type> wpool(2 * num_bids);
+        std::vector<block_type::bid_type> bids(num_bids);
+        foxxll::block_manager::get_instance()->new_blocks(
+            foxxll::striping(), bids.begin(), bids.end());
+
+        for (size_t round = 0; round < 2; ++round)
+        {
+            for (size_t i = 0; i < num_bids; ++i)
+            {
+                block_type* b = wpool.steal();
+                (*b)[0].integer = static_cast<int>(round * num_bids + i);
+                wpool.write(b, bids[i]);
+                STXXL_CHECK(b == nullptr);
+            }
+        }
+        STXXL_CHECK_EQUAL(wpool.size(), 2 * num_bids);
+
+        for (size_t i = 0; i < num_bids; ++i)
+            STXXL_CHECK(wpool.has_request(bids[i]));
+
+        std::pair<block_type*, foxxll::request_ptr> latest = wpool.steal_request(bids[0]);
+        STXXL_CHECK(latest.first != nullptr);
+        latest.second->wait();
+        STXXL_CHECK_EQUAL((*latest.first)[0].integer, static_cast<int>(num_bids));
+        STXXL_CHECK(!wpool.has_request(bids[0]));
+        STXXL_CHECK(wpool.steal_request(bids[0]).first == nullptr);
+        wpool.add(latest.first);
+
+        // all blocks, including those of stale writes, can be taken out again
+        std::vector<block_type*> blocks;
+        for (size_t i = 0; i < 2 * num_bids; ++i)
+            blocks.push_back(wpool.steal());
+        STXXL_CHECK_EQUAL(wpool.size(), 0u);
+        for (size_t i = 1; i < num_bids; ++i)
+            STXXL_CHECK(!wpool.has_request(bids[i]));
+
+        for (block_type* b : blocks)
+            delete b;
+        foxxll::block_manager::get_instance()->delete_blocks(bids.begin(), bids.end());
+    }
 }
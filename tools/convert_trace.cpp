@@ -0,0 +1,53 @@
+/***************************************************************************
+ *  tools/convert_trace.cpp
+ *
+ *  Part of the STXXL. See http://stxxl.org
+ *
+ *  Copyright (C) 2026 Timo Bingmann <tb@panthema.net>
+ *
+ *  Distributed under the Boost Software License, Version 1.0.
+ *  (See accompanying file LICENSE_1_0.txt or copy at
+ *  http://www.boost.org/LICENSE_1_0.txt)
+ **************************************************************************/
+
+#include <foxxll/io/request_trace.hpp>
+#include <foxxll/verbose.hpp>
+#include <tlx/cmdline_parser.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+int convert_trace(int argc, char* argv[])
+{
+    std::string input, output;
+
+    tlx::CmdlineParser cp;
+    cp.set_description(
+        "Convert a binary request trace to Chrome trace-event JSON, which can "
+        "be loaded into chrome://tracing or https://ui.perfetto.dev");
+    cp.add_param_string("input", input, "Binary trace file to read.");
+    cp.add_opt_param_string("output", output,
+                            "JSON file to write, default: standard output.");
+
+    if (!cp.process(argc, argv))
+        return -1;
+
+    std::ifstream in(input.c_str(), std::ios::binary);
+    if (!in) {
+        STXXL_ERRMSG("Cannot open trace file '" << input << "'");
+        return -1;
+    }
+
+    if (output.empty()) {
+        foxxll::request_trace::to_chrome_json(in, std::cout);
+    }
+    else {
+        std::ofstream out(output.c_str());
+        uint64_t events = foxxll::request_trace::to_chrome_json(in, out);
+        STXXL_MSG("Wrote " << events << " events to '" << output << "'");
+    }
+
+    return 0;
+}
+// vim: et:ts=4:sw=4
@@ -36,6 +36,9 @@ int stxxl_info(int, char**)
 #if defined(STXXL_HAVE_LINUXAIO_FILE)
     STXXL_MSG("STXXL_HAVE_LINUXAIO_FILE = " << STXXL_HAVE_LINUXAIO_FILE);
 #endif
+#if defined(STXXL_HAVE_IO_URING_FILE)
+    STXXL_MSG("STXXL_HAVE_IO_URING_FILE = " << STXXL_HAVE_IO_URING_FILE);
+#endif
 
     return 0;
 }
@@ -48,6 +51,7 @@ extern int benchmark_disks_random(int argc, char* argv[]);
 extern int benchmark_pqueue(int argc, char* argv[]);
 extern int do_mlock(int argc, char* argv[]);
 extern int do_mallinfo(int argc, char* argv[]);
+extern int convert_trace(int argc, char* argv[]);
 
 struct SubTool
 {
@@ -80,6 +84,11 @@ struct SubTool subtools[] = {
         "benchmark_disks_random", &benchmark_disks_random, false,
         "Benchmark random block access time to .foxxll configured disks."
     },
+    {
+        "convert_trace", &convert_trace, false,
+        "Convert a binary request trace, as written when the .foxxll "
+        "configuration contains trace=<path>, to Chrome trace-event JSON."
+    },
     { nullptr, nullptr, false, nullptr }
 };
 